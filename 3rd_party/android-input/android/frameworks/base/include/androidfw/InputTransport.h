@@ -37,8 +37,11 @@
 #include <std/Vector.h>
 
 // C++ std lib
+#include <memory>
 #include <unordered_map>
 
+namespace mir { namespace input { class InputRing; } }
+
 namespace android {
 
 /*
@@ -150,6 +153,16 @@ protected:
 public:
     InputChannel(const String8& name, int fd);
 
+    /* Creates a channel that also carries messages through a shared memory ring.
+     *
+     * Once the ring's consumer has attached, the publisher sends messages through
+     * the ring rather than the socket, and the consumer reads them from there after
+     * whatever the socket still holds. From then on finished signals are not sent:
+     * the ring's read index acknowledges messages, and the consumer only signals
+     * through the socket when the publisher is waiting for room in the ring.
+     */
+    InputChannel(const String8& name, int fd, std::shared_ptr<mir::input::InputRing> const& ring);
+
     inline String8 getName() const { return mName; }
     inline int getFd() const { return mFd; }
 
@@ -179,8 +192,14 @@ public:
     status_t receiveMessage(InputMessage* msg);
 
 private:
+    status_t sendSocketMessage(const InputMessage* msg);
+    status_t receiveSocketMessage(InputMessage* msg);
+    status_t receiveRingMessage(InputMessage* msg);
+
     String8 mName;
     int mFd;
+    std::shared_ptr<mir::input::InputRing> const mRing;
+    bool mSocketDrained;
 };
 
 /*
@@ -21,6 +21,7 @@
 
 #include <androidfw/InputTransport.h>
 #include <cutils/log.h>
+#include "mir/input/input_ring.h"
 #include <std/properties.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -112,7 +113,12 @@ size_t InputMessage::size() const {
 // --- InputChannel ---
 
 InputChannel::InputChannel(const String8& name, int fd) :
-        mName(name), mFd(fd) {
+        InputChannel(name, fd, nullptr) {
+}
+
+InputChannel::InputChannel(const String8& name, int fd,
+        std::shared_ptr<mir::input::InputRing> const& ring) :
+        mName(name), mFd(fd), mRing(ring), mSocketDrained(false) {
 #if DEBUG_CHANNEL_LIFECYCLE
     ALOGD("Input channel constructed: name='%s', fd=%d",
         c_str(mName), fd);
@@ -131,6 +137,21 @@ InputChannel::~InputChannel() {
 }
 
 status_t InputChannel::sendMessage(const InputMessage* msg) {
+    if (mRing) {
+        if (msg->header.type == InputMessage::TYPE_FINISHED) {
+            // Messages read from the ring are acknowledged by its read index
+            if (mSocketDrained) {
+                return OK;
+            }
+        } else if (mRing->consumer_attached()) {
+            return mRing->push(msg, msg->size()) ? OK : WOULD_BLOCK;
+        }
+    }
+
+    return sendSocketMessage(msg);
+}
+
+status_t InputChannel::sendSocketMessage(const InputMessage* msg) {
     size_t msgLength = msg->size();
     ssize_t nWrite;
     do {
@@ -167,6 +188,55 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
 }
 
 status_t InputChannel::receiveMessage(InputMessage* msg) {
+    // The publisher's side only ever hears back through the socket
+    if (!mRing || !mRing->consuming()) {
+        return receiveSocketMessage(msg);
+    }
+
+    if (!mSocketDrained) {
+        // The publisher sends nothing more through the socket once it has used the ring,
+        // so if the ring was in use before the socket was found empty, it stays empty.
+        bool ringInUse = !mRing->empty();
+
+        status_t result = receiveSocketMessage(msg);
+        if (result != WOULD_BLOCK || !ringInUse) {
+            return result;
+        }
+        mSocketDrained = true;
+    }
+
+    return receiveRingMessage(msg);
+}
+
+status_t InputChannel::receiveRingMessage(InputMessage* msg) {
+    size_t size = mRing->pop(msg, sizeof(InputMessage));
+    if (!size) {
+        return WOULD_BLOCK;
+    }
+
+    if (mRing->take_room_request()) {
+        InputMessage roomMsg;
+        roomMsg.header.type = InputMessage::TYPE_FINISHED;
+        roomMsg.header.size = sizeof(roomMsg.body.finished);
+        roomMsg.header.seq = msg->header.seq;
+        roomMsg.body.finished.handled = true;
+        sendSocketMessage(&roomMsg);
+    }
+
+    if (!msg->isValid(size)) {
+#if DEBUG_CHANNEL_MESSAGES
+        ALOGD("channel '%s' ~ received invalid message from ring", c_str(mName));
+#endif
+        return BAD_VALUE;
+    }
+
+#if DEBUG_CHANNEL_MESSAGES
+    ALOGD("channel '%s' ~ received message of type %d from ring", c_str(mName), msg->header.type);
+#endif
+    return OK;
+}
+
+status_t InputChannel::receiveSocketMessage(InputMessage* msg) {
     ssize_t nRead;
     do {
         nRead = ::recv(mFd, msg, sizeof(InputMessage), MSG_DONTWAIT);
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures what the server does with each pointer and touch event on the
+ * input thread: build it, clone it for the surface under the cursor, move it
+ * into surface coordinates and serialize it for the client. Counts the
+ * allocations made on the way through operator new, which should only be the
+ * serialized output.
+ */
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event_private.h"
+#include "mir/test/allocation_counter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace mev = mir::events;
+namespace geom = mir::geometry;
+namespace mt = mir::test;
+
+namespace
+{
+template<typename MakeEvent>
+void measure(char const* name, int events, MakeEvent const& make_event)
+{
+    auto const deliver = [&](int i, bool serialize)
+        {
+            auto const event = make_event(i);
+            auto const to_deliver = mev::clone_event(*event);
+            mev::transform_positions(*to_deliver, geom::Displacement{100, 100});
+            if (serialize)
+                return MirEvent::serialize(to_deliver.get()).size();
+            return size_t{0};
+        };
+
+    // Let each thread's spare storage fill up first
+    for (int i = 0; i != 100; ++i)
+        deliver(i, true);
+
+    for (auto serialize : {false, true})
+    {
+        mt::AllocationCounter const allocations;
+        auto const start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i != events; ++i)
+            deliver(i, serialize);
+
+        auto const duration = std::chrono::steady_clock::now() - start;
+        auto const allocated = allocations.count();
+
+        std::cout << name << (serialize ? " (serialized): " : ": ")
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / events
+                  << "ns/event, " << static_cast<double>(allocated) / events
+                  << " allocations/event" << std::endl;
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of events>"<<std::endl;
+        exit(1);
+    }
+
+    int const events = std::atoi(argv[1]);
+    std::vector<uint8_t> const cookie;
+    MirInputDeviceId const device{1};
+
+    measure("pointer motion", events, [&](int i)
+        {
+            return mev::make_event(device, std::chrono::nanoseconds{i}, cookie, mir_input_event_modifier_none,
+                                   mir_pointer_action_motion, 0, 200.0f + i % 100, 200.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+        });
+
+    measure("ten finger touch", events, [&](int i)
+        {
+            auto event = mev::make_event(device, std::chrono::nanoseconds{i}, cookie, mir_input_event_modifier_none);
+            for (int finger = 0; finger != 10; ++finger)
+                mev::add_touch(*event, finger, mir_touch_action_change, mir_touch_tooltype_finger,
+                               200.0f + finger * 10, 200.0f + i % 100, 1.0f, 5.0f, 5.0f, 5.0f);
+            return event;
+        });
+
+    exit(0);
+}
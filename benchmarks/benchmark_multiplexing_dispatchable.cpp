@@ -84,17 +84,22 @@ bool fd_is_readable(int fd)
 
 int main(int argc, char** argv)
 {
-    if (argc != 3)
+    if (argc != 3 && argc != 4)
     {
-        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count>"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count> [<number of fds>]"<<std::endl;
         exit(1);
     }
 
     int const thread_count = std::atoi(argv[1]);
     uint64_t const dispatch_count = std::atoll(argv[2]);
+    int const fd_count = argc == 4 ? std::atoi(argv[3]) : 1;
 
     auto dispatcher = std::make_shared<md::MultiplexingDispatchable>();
-    dispatcher->add_watch(std::make_shared<TestDispatchable>(dispatch_count / thread_count), md::DispatchReentrancy::reentrant);
+    // Every fd is always readable, so each wakeup finds fd_count sources ready
+    for (int i = 0; i < fd_count; ++i)
+    {
+        dispatcher->add_watch(std::make_shared<TestDispatchable>(dispatch_count / thread_count), md::DispatchReentrancy::reentrant);
+    }
 
     auto start = std::chrono::steady_clock::now();
 
@@ -116,6 +121,6 @@ int main(int argc, char** argv)
     }
 
     auto duration = std::chrono::steady_clock::now() - start;
-    std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+    std::cout<<"Dispatching "<<dispatch_count<<" times across "<<fd_count<<" fds took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
     exit(0);
 }
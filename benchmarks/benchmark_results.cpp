@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmarks/benchmark_results.h"
+
+#include <ostream>
+#include <sstream>
+
+double mir_benchmark::as_us(std::chrono::nanoseconds duration)
+{
+    return duration.count() / 1000.0;
+}
+
+double mir_benchmark::percentile_us(std::vector<std::chrono::nanoseconds> const& sorted_samples, unsigned per_mille)
+{
+    if (sorted_samples.empty())
+        return 0;
+
+    return as_us(sorted_samples[(sorted_samples.size() - 1) * per_mille / 1000]);
+}
+
+void mir_benchmark::write_json(std::ostream& out, JsonFields const& fields)
+{
+    std::vector<std::string> open;
+    auto first = true;
+
+    out << "{";
+    for (auto const& field : fields)
+    {
+        std::vector<std::string> path;
+        std::istringstream parts{field.first};
+        for (std::string part; std::getline(parts, part, '.');)
+            path.push_back(part);
+
+        size_t common{0};
+        while (common < open.size() && common + 1 < path.size() && open[common] == path[common])
+            ++common;
+
+        for (; open.size() > common; open.pop_back())
+            out << "\n" << std::string(2 * open.size(), ' ') << "}";
+
+        for (; open.size() + 1 < path.size(); first = true)
+        {
+            out << (first ? "" : ",") << "\n" << std::string(2 * open.size() + 2, ' ')
+                << "\"" << path[open.size()] << "\": {";
+            open.push_back(path[open.size()]);
+        }
+
+        out << (first ? "" : ",") << "\n" << std::string(2 * open.size() + 2, ' ')
+            << "\"" << path.back() << "\": " << field.second;
+        first = false;
+    }
+    for (; !open.empty(); open.pop_back())
+        out << "\n" << std::string(2 * open.size(), ' ') << "}";
+    out << "\n}\n";
+}
+
+std::string mir_benchmark::quoted(std::string const& text)
+{
+    std::string result{"\""};
+    for (auto const c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
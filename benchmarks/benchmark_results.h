@@ -0,0 +1,42 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_RESULTS_H_
+#define MIR_BENCHMARK_RESULTS_H_
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mir_benchmark
+{
+double as_us(std::chrono::nanoseconds duration);
+
+/// The sample \a per_mille thousandths of \a sorted_samples are no longer than, in us; 0 if there are none
+double percentile_us(std::vector<std::chrono::nanoseconds> const& sorted_samples, unsigned per_mille);
+
+/// Each value is written as it is, so strings need quoting first
+typedef std::vector<std::pair<std::string, std::string>> JsonFields;
+
+/// Writes "a.b.c" paths out as nested JSON objects, in order
+void write_json(std::ostream& out, JsonFields const& fields);
+
+std::string quoted(std::string const& text);
+}
+
+#endif /* MIR_BENCHMARK_RESULTS_H_ */
@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures a software client interactively resizing its window: at each step
+ * it creates three buffers of the new size through its session, draws into
+ * them and destroys the three it had before. Compares sessions that allocate
+ * fresh memory for every buffer with ones that reuse it from a pool.
+ */
+
+#include "src/server/scene/application_session.h"
+#include "src/server/scene/pooled_software_allocator.h"
+#include "src/platforms/common/server/anonymous_shm_file.h"
+#include "src/platforms/common/server/shm_buffer.h"
+#include "src/platforms/common/server/shm_pool.h"
+#include "mir/frontend/client_buffers.h"
+#include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/shm_pool.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/scene/null_session_listener.h"
+#include "mir/shell/surface_stack.h"
+#include "mir/test/doubles/null_event_sink.h"
+#include "mir/test/doubles/null_snapshot_strategy.h"
+#include "mir/test/doubles/stub_buffer_stream_factory.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+#include "mir/test/doubles/stub_surface_factory.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mi = mir::input;
+namespace mf = mir::frontend;
+namespace ms = mir::scene;
+namespace msh = mir::shell;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+struct SoftwareBuffer : mgc::ShmBuffer
+{
+    SoftwareBuffer(std::unique_ptr<mgc::ShmFile> shm_file, geom::Size size, MirPixelFormat format) :
+        ShmBuffer(std::move(shm_file), size, format)
+    {
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return {};
+    }
+};
+
+// What the mesa and eglstream platforms do for software buffers
+struct ShmAllocator : mg::GraphicBufferAllocator, mg::ShmPoolAllocator
+{
+    std::shared_ptr<mg::Buffer> alloc_buffer(mg::BufferProperties const& properties) override
+    {
+        return alloc_software_buffer(properties.size, properties.format);
+    }
+
+    std::vector<MirPixelFormat> supported_pixel_formats() override
+    {
+        return {mir_pixel_format_argb_8888};
+    }
+
+    std::shared_ptr<mg::Buffer> alloc_buffer(geom::Size size, uint32_t, uint32_t) override
+    {
+        return alloc_software_buffer(size, mir_pixel_format_argb_8888);
+    }
+
+    std::shared_ptr<mg::Buffer> alloc_software_buffer(geom::Size size, MirPixelFormat format) override
+    {
+        return std::make_shared<SoftwareBuffer>(
+            std::make_unique<mgc::AnonymousShmFile>(size_in_bytes(size, format)), size, format);
+    }
+
+    std::shared_ptr<mg::ShmPool> create_shm_pool(size_t max_cached_bytes) override
+    {
+        return std::make_shared<mgc::ShmPool>(max_cached_bytes);
+    }
+
+    std::shared_ptr<mg::Buffer> alloc_software_buffer(
+        geom::Size size, MirPixelFormat format, mg::ShmPool& pool) override
+    {
+        return std::make_shared<SoftwareBuffer>(
+            dynamic_cast<mgc::ShmPool&>(pool).file_for(size_in_bytes(size, format)), size, format);
+    }
+
+    static size_t size_in_bytes(geom::Size size, MirPixelFormat format)
+    {
+        return MIR_BYTES_PER_PIXEL(format) * size.width.as_uint32_t() * size.height.as_uint32_t();
+    }
+};
+
+// Holds on to buffers until the client destroys them, as the real map does
+struct ClientBuffers : mf::ClientBuffers
+{
+    mg::BufferID add_buffer(std::shared_ptr<mg::Buffer> const& buffer) override
+    {
+        buffers[buffer->id()] = buffer;
+        return buffer->id();
+    }
+
+    void remove_buffer(mg::BufferID id) override
+    {
+        buffers.erase(id);
+    }
+
+    std::shared_ptr<mg::Buffer>& operator[](mg::BufferID id) override
+    {
+        return buffers[id];
+    }
+
+    void send_buffer(mg::BufferID) override
+    {
+    }
+
+    void receive_buffer(mg::BufferID) override
+    {
+    }
+
+    std::map<mg::BufferID, std::shared_ptr<mg::Buffer>> buffers;
+};
+
+struct BufferStreamFactory : mtd::StubBufferStreamFactory
+{
+    std::shared_ptr<mf::ClientBuffers> create_buffer_map(std::shared_ptr<mf::BufferSink> const&) override
+    {
+        return std::make_shared<ClientBuffers>();
+    }
+};
+
+struct StubSurfaceStack : msh::SurfaceStack
+{
+    void raise(std::weak_ptr<ms::Surface> const&) override {}
+    void raise(SurfaceSet const&) override {}
+    void add_surface(std::shared_ptr<ms::Surface> const&, mi::InputReceptionMode) override {}
+    void remove_surface(std::weak_ptr<ms::Surface> const&) override {}
+    auto surface_at(geom::Point) const -> std::shared_ptr<ms::Surface> override { return {}; }
+};
+
+void resize_storm(
+    char const* name,
+    int steps,
+    std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    size_t max_cached_bytes)
+{
+    ms::ApplicationSession session{
+        std::make_shared<StubSurfaceStack>(),
+        std::make_shared<mtd::StubSurfaceFactory>(),
+        std::make_shared<BufferStreamFactory>(),
+        __LINE__,
+        name,
+        std::make_shared<mtd::NullSnapshotStrategy>(),
+        std::make_shared<ms::NullSessionListener>(),
+        mtd::StubDisplayConfig{},
+        std::make_shared<mtd::NullEventSink>(),
+        ms::PooledSoftwareAllocator::wrap(allocator, max_cached_bytes)};
+
+    int const buffers_per_step{3};
+    std::vector<mg::BufferID> buffers;
+    std::vector<unsigned char> pixels;
+    auto const start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i != steps; ++i)
+    {
+        // Grows from 400x300 to 1200x900 and back in 4px steps, as a user dragging a corner might
+        auto const phase = i % 400;
+        auto const delta = phase < 200 ? phase * 4 : (400 - phase) * 4;
+        geom::Size const size{400 + delta, 300 + delta * 3 / 4};
+        pixels.resize(ShmAllocator::size_in_bytes(size, mir_pixel_format_argb_8888));
+
+        std::vector<mg::BufferID> resized;
+        for (int j = 0; j != buffers_per_step; ++j)
+        {
+            auto const id = session.create_buffer(size, mir_pixel_format_argb_8888);
+            auto const pixel_source = dynamic_cast<mrs::PixelSource*>(session.get_buffer(id)->native_buffer_base());
+            pixel_source->write(pixels.data(), pixels.size());
+            resized.push_back(id);
+        }
+
+        for (auto const id : buffers)
+            session.destroy_buffer(id);
+        buffers = std::move(resized);
+    }
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / steps
+              << "us/step" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of resize steps>"<<std::endl;
+        exit(1);
+    }
+
+    int const steps = std::atoi(argv[1]);
+
+    auto const allocator = std::make_shared<ShmAllocator>();
+
+    resize_storm("fresh memory", steps, allocator, 0);
+    resize_storm("pooled memory", steps, allocator, 32 * 1024 * 1024);
+
+    exit(0);
+}
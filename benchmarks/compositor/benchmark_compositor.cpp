@@ -0,0 +1,479 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures compositor throughput without graphics hardware. Clients in the
+ * same process submit frames to N surfaces of M buffer streams each, at a
+ * set rate, to a headless server on the stub graphics platform. The server's
+ * own MultiThreadedCompositor, SurfaceStack and DefaultDisplayBufferCompositor
+ * composite them; only the renderer is a stub.
+ *
+ * Reports frames/sec, latency percentiles for each stage of a frame,
+ * allocations and CPU time per frame as JSON. Given the JSON of an earlier
+ * run as a baseline, it also reports the change in each and fails if any got
+ * worse by more than a tolerance.
+ *
+ * Options (or MIR_SERVER_BENCHMARK_* environment variables):
+ *   --benchmark-surfaces, --benchmark-streams-per-surface,
+ *   --benchmark-submit-rate, --benchmark-duration, --benchmark-results,
+ *   --benchmark-baseline, --benchmark-tolerance
+ *
+ * Server options apply too. The frame timeline is meant to cost under 1%
+ * when enabled; to check, run once as a baseline and once with it on:
+ *   benchmark_compositor --benchmark-results=off.json
+ *   benchmark_compositor --frame-timeline=4096 --frame-timeline-file=timeline.json \
+ *       --benchmark-baseline=off.json --benchmark-tolerance=1
+ */
+
+#include "src/server/compositor/default_display_buffer_compositor.h"
+#include "benchmarks/benchmark_results.h"
+#include "mir_test_framework/headless_in_process_server.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir/compositor/compositor_report.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/options/configuration.h"
+#include "mir/options/option.h"
+#include "mir/test/doubles/stub_renderer.h"
+#include "mir/test/allocation_counter.h"
+#include "mir_toolkit/mir_client_library.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+namespace mtf = mir_test_framework;
+
+using namespace mir_benchmark;
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+char const* const surfaces_opt = "benchmark-surfaces";
+char const* const streams_opt = "benchmark-streams-per-surface";
+char const* const rate_opt = "benchmark-submit-rate";
+char const* const duration_opt = "benchmark-duration";
+char const* const results_opt = "benchmark-results";
+char const* const baseline_opt = "benchmark-baseline";
+char const* const tolerance_opt = "benchmark-tolerance";
+
+typedef std::chrono::steady_clock Clock;
+
+std::chrono::nanoseconds cpu_time(clockid_t clock)
+{
+    timespec time;
+    clock_gettime(clock, &time);
+    return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+
+/// Gathers what the compositing threads and the clients measure
+class Recorder
+{
+public:
+    struct Frame
+    {
+        std::chrono::nanoseconds composite;
+        // Zero if the display buffer took the frame as an overlay
+        std::chrono::nanoseconds render;
+        std::chrono::nanoseconds release;
+        std::chrono::nanoseconds cpu;
+        size_t allocations;
+    };
+
+    bool measuring() const { return measuring_; }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        frames.clear();
+        swaps.clear();
+        // So that recording a sample doesn't disturb what is being measured
+        frames.reserve(100000);
+        swaps.reserve(100000);
+        started = Clock::now();
+        process_cpu_at_start = cpu_time(CLOCK_PROCESS_CPUTIME_ID);
+        measuring_ = true;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        measuring_ = false;
+        elapsed = Clock::now() - started;
+        process_cpu = cpu_time(CLOCK_PROCESS_CPUTIME_ID) - process_cpu_at_start;
+    }
+
+    void frame(Frame const& frame)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (measuring_)
+            frames.push_back(frame);
+    }
+
+    void swap(std::chrono::nanoseconds latency)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (measuring_)
+            swaps.push_back(latency);
+    }
+
+    void added_output()
+    {
+        ++outputs;
+    }
+
+    std::atomic<int> outputs{0};
+
+    std::mutex mutex;
+    std::vector<Frame> frames;
+    std::vector<std::chrono::nanoseconds> swaps;
+    std::chrono::nanoseconds elapsed{0};
+    std::chrono::nanoseconds process_cpu{0};
+
+private:
+    std::atomic<bool> measuring_{false};
+    Clock::time_point started;
+    std::chrono::nanoseconds process_cpu_at_start{0};
+};
+
+// When the DefaultDisplayBufferCompositor on this thread reached each stage of its frame
+struct Stages
+{
+    Clock::time_point began;
+    Clock::time_point rendered;
+    Clock::time_point finished;
+};
+thread_local Stages stages;
+
+struct StageReport : mc::CompositorReport
+{
+    void added_display(int, int, int, int, SubCompositorId) override {}
+    void began_frame(SubCompositorId) override { stages.began = Clock::now(); stages.rendered = {}; }
+    void renderables_in_frame(SubCompositorId, mg::RenderableList const&) override {}
+    void rendered_frame(SubCompositorId) override { stages.rendered = Clock::now(); }
+    void finished_frame(SubCompositorId) override { stages.finished = Clock::now(); }
+    void started() override {}
+    void stopped() override {}
+    void scheduled() override {}
+};
+
+class MeasuredCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    MeasuredCompositor(mg::DisplayBuffer& display_buffer, std::shared_ptr<Recorder> const& recorder) :
+        recorder{recorder},
+        compositor{display_buffer, std::make_shared<mtd::StubRenderer>(), std::make_shared<StageReport>()}
+    {
+    }
+
+    void composite(mc::SceneElementSequence&& scene_sequence) override
+    {
+        auto const measuring = recorder->measuring();
+        auto const cpu_at_start = cpu_time(CLOCK_THREAD_CPUTIME_ID);
+        mt::AllocationCounter const allocations;
+        auto const start = Clock::now();
+
+        compositor.composite(std::move(scene_sequence));
+
+        auto const end = Clock::now();
+        auto const allocated = allocations.count();
+        if (!measuring)
+            return;
+
+        auto const rendered = stages.rendered != Clock::time_point{};
+        recorder->frame({
+            end - start,
+            rendered ? stages.rendered - stages.began : 0ns,
+            rendered ? stages.finished - stages.rendered : 0ns,
+            cpu_time(CLOCK_THREAD_CPUTIME_ID) - cpu_at_start,
+            allocated});
+    }
+
+private:
+    std::shared_ptr<Recorder> const recorder;
+    mc::DefaultDisplayBufferCompositor compositor;
+};
+
+struct MeasuredCompositorFactory : mc::DisplayBufferCompositorFactory
+{
+    MeasuredCompositorFactory(std::shared_ptr<Recorder> const& recorder) :
+        recorder{recorder}
+    {
+    }
+
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer& display_buffer) override
+    {
+        recorder->added_output();
+        return std::make_unique<MeasuredCompositor>(display_buffer, recorder);
+    }
+
+    std::shared_ptr<Recorder> const recorder;
+};
+
+/// A client with one surface of several streams, each submitting frames at a steady rate
+class Client
+{
+public:
+    Client(std::string const& connect_string, int streams, int rate, Recorder& recorder) :
+        connection{mir_connect_sync(connect_string.c_str(), "benchmark_compositor")},
+        recorder(recorder)
+    {
+        if (!mir_connection_is_valid(connection))
+            throw std::runtime_error{mir_connection_get_error_message(connection)};
+
+        MirPixelFormat format;
+        unsigned int valid_formats{0};
+        mir_connection_get_available_surface_formats(connection, &format, 1, &valid_formats);
+
+        // Streams tile a 480x360 window; the window manager places windows so that they overlap
+        int const width{480}, height{360};
+        int const columns = std::ceil(std::sqrt(streams));
+        int const rows = (streams + columns - 1) / columns;
+        std::vector<MirBufferStreamInfo> infos;
+        for (int i = 0; i != streams; ++i)
+        {
+            auto const stream = mir_connection_create_buffer_stream_sync(
+                connection, width / columns, height / rows, format, mir_buffer_usage_hardware);
+            if (!mir_buffer_stream_is_valid(stream))
+                throw std::runtime_error{mir_buffer_stream_get_error_message(stream)};
+
+            this->streams.push_back(stream);
+            infos.push_back({stream, (i % columns) * width / columns, (i / columns) * height / rows});
+        }
+
+        auto const spec = mir_create_normal_window_spec(connection, width, height);
+        mir_window_spec_set_pixel_format(spec, format);
+        mir_window_spec_set_buffer_usage(spec, mir_buffer_usage_hardware);
+        mir_window_spec_set_streams(spec, infos.data(), infos.size());
+        window = mir_create_window_sync(spec);
+        mir_window_spec_release(spec);
+
+        if (!mir_window_is_valid(window))
+            throw std::runtime_error{mir_window_get_error_message(window)};
+
+        thread = std::thread{[this, rate] { submit_frames(rate); }};
+    }
+
+    ~Client()
+    {
+        running = false;
+        thread.join();
+
+        mir_window_release_sync(window);
+        for (auto const stream : streams)
+            mir_buffer_stream_release_sync(stream);
+        mir_connection_release(connection);
+    }
+
+private:
+    void submit_frames(int rate)
+    {
+        auto const interval = rate > 0 ? std::chrono::nanoseconds{1s} / rate : 0ns;
+        auto next_frame = Clock::now();
+
+        while (running)
+        {
+            for (auto const stream : streams)
+            {
+                auto const submitted = Clock::now();
+                mir_buffer_stream_swap_buffers_sync(stream);
+                recorder.swap(Clock::now() - submitted);
+            }
+
+            next_frame = std::max(next_frame + interval, Clock::now() - interval);
+            std::this_thread::sleep_until(next_frame);
+        }
+    }
+
+    MirConnection* const connection;
+    std::vector<MirBufferStream*> streams;
+    MirWindow* window{nullptr};
+    Recorder& recorder;
+    std::atomic<bool> running{true};
+    std::thread thread;
+};
+
+struct Metric
+{
+    std::string path;
+    double value;
+    bool higher_is_better;
+};
+
+std::vector<Metric> metrics_of(Recorder& recorder)
+{
+    std::lock_guard<std::mutex> lock{recorder.mutex};
+
+    std::vector<std::chrono::nanoseconds> composite, render, release;
+    std::chrono::nanoseconds cpu{0};
+    size_t allocations{0};
+    for (auto const& frame : recorder.frames)
+    {
+        composite.push_back(frame.composite);
+        if (frame.render != 0ns)
+        {
+            render.push_back(frame.render);
+            release.push_back(frame.release);
+        }
+        cpu += frame.cpu;
+        allocations += frame.allocations;
+    }
+
+    double const frames = std::max<size_t>(recorder.frames.size(), 1);
+    std::chrono::duration<double> const seconds{recorder.elapsed};
+
+    std::vector<Metric> metrics{
+        {"frames_per_second", recorder.frames.size() / seconds.count(), true},
+        {"allocations_per_frame", allocations / frames, false},
+        {"cpu_per_frame_us", as_us(cpu) / frames, false},
+        {"process_cpu_per_frame_us", as_us(recorder.process_cpu) / frames, false}};
+
+    for (auto const& stage : {std::make_pair("composite", &composite),
+                              std::make_pair("render", &render),
+                              std::make_pair("release", &release),
+                              std::make_pair("client_swap", &recorder.swaps)})
+    {
+        auto& latencies = *stage.second;
+        std::sort(latencies.begin(), latencies.end());
+        auto const path = std::string{"latency_us."} + stage.first + ".";
+        metrics.push_back({path + "p50", percentile_us(latencies, 500), false});
+        metrics.push_back({path + "p90", percentile_us(latencies, 900), false});
+        metrics.push_back({path + "p99", percentile_us(latencies, 990), false});
+        metrics.push_back({path + "max", percentile_us(latencies, 1000), false});
+    }
+
+    return metrics;
+}
+
+struct CompositorBenchmark : mtf::HeadlessInProcessServer
+{
+    CompositorBenchmark()
+    {
+        add_to_environment("MIR_CLIENT_PLATFORM_PATH", (mtf::library_path() + "/client-modules").c_str());
+
+        server.add_configuration_option(surfaces_opt, "Number of surfaces, each from its own client", 8);
+        server.add_configuration_option(streams_opt, "Number of buffer streams in each surface", 1);
+        server.add_configuration_option(rate_opt, "Frames per second each stream submits [0 = unthrottled]", 60);
+        server.add_configuration_option(duration_opt, "Seconds to measure for", 5);
+        server.add_configuration_option(results_opt, "File to write the results to as JSON", "");
+        server.add_configuration_option(baseline_opt, "Results of an earlier run to compare against", "");
+        server.add_configuration_option(
+            tolerance_opt, "Percentage by which a metric may be worse than its baseline", 10.0);
+
+        server.override_the_display_buffer_compositor_factory([this]
+            {
+                return std::make_shared<MeasuredCompositorFactory>(recorder);
+            });
+    }
+
+    std::shared_ptr<Recorder> const recorder = std::make_shared<Recorder>();
+};
+}
+
+// Runs as a test so that mir_test_framework can provide main() and the server
+TEST_F(CompositorBenchmark, composites_surfaces_submitting_at_a_steady_rate)
+{
+    auto const options = server.get_options();
+    auto const surfaces = options->get<int>(surfaces_opt);
+    auto const streams = options->get<int>(streams_opt);
+    auto const rate = options->get<int>(rate_opt);
+    std::chrono::seconds const duration{options->get<int>(duration_opt)};
+
+    {
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i != surfaces; ++i)
+            clients.push_back(std::make_unique<Client>(new_connection(), streams, rate, *recorder));
+
+        // Let buffer queues and the compositor's caches settle before measuring
+        std::this_thread::sleep_for(500ms);
+        recorder->start();
+        std::this_thread::sleep_for(duration);
+        recorder->stop();
+    }
+
+    auto const metrics = metrics_of(*recorder);
+
+    boost::property_tree::ptree baseline;
+    auto const baseline_file = options->get<std::string>(baseline_opt);
+    if (!baseline_file.empty())
+        boost::property_tree::read_json(baseline_file, baseline);
+
+    JsonFields fields{
+        {"configuration.surfaces", std::to_string(surfaces)},
+        {"configuration.streams_per_surface", std::to_string(streams)},
+        {"configuration.submit_rate", std::to_string(rate)},
+        {"configuration.duration_s", std::to_string(duration.count())},
+        {"configuration.outputs", std::to_string(recorder->outputs)},
+        {"configuration.frame_timeline", std::to_string(options->get<int>(mir::options::frame_timeline_opt))},
+        {"frames", std::to_string(recorder->frames.size())}};
+
+    for (auto const& metric : metrics)
+        fields.emplace_back(metric.path, std::to_string(metric.value));
+
+    if (!baseline_file.empty())
+    {
+        auto const tolerance = options->get<double>(tolerance_opt);
+        fields.emplace_back("baseline.file", quoted(baseline_file));
+
+        for (auto const& metric : metrics)
+        {
+            auto const before = baseline.get_optional<double>(metric.path);
+            if (!before || *before == 0)
+                continue;
+
+            auto const change = 100 * (metric.value - *before) / *before;
+            auto const worse = metric.higher_is_better ? -change : change;
+            fields.emplace_back("baseline." + metric.path + ".before", std::to_string(*before));
+            fields.emplace_back("baseline." + metric.path + ".change_percent", std::to_string(change));
+
+            // A latency a few microseconds longer is noise, however large a percentage
+            auto const noise = metric.path.find("latency_us.") == 0 && std::abs(metric.value - *before) < 50;
+            auto const regressed = worse > tolerance && !noise;
+            fields.emplace_back("baseline." + metric.path + ".regressed", regressed ? "true" : "false");
+            EXPECT_FALSE(regressed) << metric.path << " regressed from " << *before << " to " << metric.value;
+        }
+    }
+
+    write_json(std::cout, fields);
+
+    auto const results_file = options->get<std::string>(results_opt);
+    if (!results_file.empty())
+    {
+        std::ofstream results{results_file};
+        write_json(results, fields);
+    }
+
+    EXPECT_THAT(recorder->frames.size(), Gt(0u));
+}
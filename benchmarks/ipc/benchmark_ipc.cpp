@@ -0,0 +1,478 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the client/server RPC layer end to end: MirProtobufRpcChannel on
+ * the client, over the socket, to ProtobufMessageProcessor and SessionMediator
+ * on a headless in-process server, and back.
+ *
+ * Each operation runs with 1, 2, 4... up to N concurrent clients, each on its
+ * own connection. The results give the sustained operations/sec across all
+ * clients and a histogram and percentiles of the latency of each operation:
+ *
+ *   pong             - a request answered with nothing but its reply
+ *   modify_surface   - a request the shell acts on before replying
+ *   allocate_buffers - a request answered by a buffer event carrying an fd
+ *   submit_buffer    - swapping a buffer stream: submitting a buffer and
+ *                      waiting for the next one to come back
+ *   event_delivery   - the server pinging a client, until the client sees it
+ *   fd_passing       - a platform operation sending an fd each way
+ *
+ * Options (or MIR_SERVER_BENCHMARK_* environment variables):
+ *   --benchmark-clients, --benchmark-iterations, --benchmark-results
+ */
+
+#include "src/client/mir_connection.h"
+#include "src/client/rpc/mir_display_server.h"
+#include "benchmarks/benchmark_results.h"
+#include "mir_test_framework/headless_in_process_server.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/any_surface.h"
+#include "mir_test_framework/stub_graphics_platform_operation.h"
+#include "mir/frontend/session.h"
+#include "mir/scene/application_not_responding_detector.h"
+#include "mir/options/option.h"
+#include "mir/fd.h"
+#include "mir_toolkit/mir_client_library.h"
+#include "mir_toolkit/debug/surface.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mp = mir::protobuf;
+namespace ms = mir::scene;
+namespace mclr = mir::client::rpc;
+namespace mtf = mir_test_framework;
+
+using namespace mir_benchmark;
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+char const* const clients_opt = "benchmark-clients";
+char const* const iterations_opt = "benchmark-iterations";
+char const* const results_opt = "benchmark-results";
+
+typedef std::chrono::steady_clock Clock;
+
+// Operations run before measuring starts, to fill caches and pools
+int const warm_up_iterations{50};
+
+class Completion
+{
+public:
+    void signal()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        done = true;
+        cv.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        if (!cv.wait_for(lock, 10s, [this] { return done; }))
+            throw std::runtime_error{"Timed out waiting for the server"};
+        done = false;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done{false};
+};
+
+/// Lets the benchmark ping any client from the server side, as the shell would
+class ServerPinger : public ms::ApplicationNotRespondingDetector
+{
+public:
+    void register_session(mf::Session const* session, std::function<void()> const& pinger) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        pingers[session->name()] = pinger;
+    }
+
+    void unregister_session(mf::Session const* session) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        pingers.erase(session->name());
+    }
+
+    void pong_received(mf::Session const*) override {}
+    void register_observer(std::shared_ptr<Observer> const&) override {}
+    void unregister_observer(std::shared_ptr<Observer> const&) override {}
+
+    std::function<void()> pinger_for(std::string const& name)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return pingers.at(name);
+    }
+
+private:
+    std::mutex mutex;
+    std::map<std::string, std::function<void()>> pingers;
+};
+
+class Client
+{
+public:
+    Client(std::string const& connect_string, std::string const& name, ServerPinger& server_pinger) :
+        connection{mir_connect_sync(connect_string.c_str(), name.c_str())}
+    {
+        if (!mir_connection_is_valid(connection))
+            throw std::runtime_error{mir_connection_get_error_message(connection)};
+
+        window = mtf::make_any_surface(connection);
+        if (!mir_window_is_valid(window))
+            throw std::runtime_error{mir_window_get_error_message(window)};
+
+        stream = mir_window_get_buffer_stream(window);
+        display_server = std::make_unique<mclr::DisplayServer>(connection->rpc_channel());
+        ping_from_server = server_pinger.pinger_for(name);
+        mir_connection_set_ping_event_callback(connection, &Client::pinged, this);
+
+        unsigned int valid_formats{0};
+        mir_connection_get_available_surface_formats(connection, &format, 1, &valid_formats);
+
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        pipe_read = mir::Fd{fds[0]};
+        pipe_write = mir::Fd{fds[1]};
+    }
+
+    ~Client()
+    {
+        mir_window_release_sync(window);
+        mir_connection_release(connection);
+    }
+
+    std::chrono::nanoseconds pong()
+    {
+        mp::PingEvent ping;
+        ping.set_serial(0);
+        return round_trip(&mclr::DisplayServer::pong, ping);
+    }
+
+    std::chrono::nanoseconds modify_surface()
+    {
+        mp::SurfaceModifications modifications;
+        modifications.mutable_surface_id()->set_value(mir_debug_window_id(window));
+        modifications.mutable_surface_specification()->set_name("benchmark_ipc");
+        return round_trip(&mclr::DisplayServer::modify_surface, modifications);
+    }
+
+    std::chrono::nanoseconds allocate_buffers()
+    {
+        auto const start = Clock::now();
+        auto const buffer = mir_connection_allocate_buffer_sync(connection, 64, 64, format);
+        auto const latency = Clock::now() - start;
+
+        if (!mir_buffer_is_valid(buffer))
+            throw std::runtime_error{mir_buffer_get_error_message(buffer)};
+        mir_buffer_release(buffer);
+
+        return latency;
+    }
+
+    std::chrono::nanoseconds submit_buffer()
+    {
+        auto const start = Clock::now();
+        mir_buffer_stream_swap_buffers_sync(stream);
+        return Clock::now() - start;
+    }
+
+    std::chrono::nanoseconds event_delivery()
+    {
+        auto const start = Clock::now();
+        ping_from_server();
+        ping_seen.wait();
+        return Clock::now() - start;
+    }
+
+    std::chrono::nanoseconds fd_passing()
+    {
+        // The server reads a character from the fd it's sent, and replies
+        // with a new fd it can be read from again
+        char const sent{'#'};
+        if (write(pipe_write, &sent, 1) != 1)
+            throw std::system_error{errno, std::system_category(), "Failed to write to pipe"};
+
+        auto const request = mir_platform_message_create(
+            static_cast<unsigned int>(mtf::StubGraphicsPlatformOperation::echo_fd));
+        int const fd = pipe_read;
+        mir_platform_message_set_fds(request, &fd, 1);
+
+        auto const start = Clock::now();
+        mir_connection_platform_operation(connection, request, &Client::platform_operation_replied, this);
+        replied.wait();
+        auto const latency = Clock::now() - start;
+
+        mir_platform_message_release(request);
+
+        auto const reply_fds = mir_platform_message_get_fds(reply);
+        char received{0};
+        auto const echoed = reply_fds.num_fds == 1 && read(reply_fds.fds[0], &received, 1) == 1;
+        for (auto i = 0u; i != reply_fds.num_fds; ++i)
+            close(reply_fds.fds[i]);
+        mir_platform_message_release(reply);
+
+        if (!echoed || received != sent)
+            throw std::runtime_error{"Server did not echo the fd it was sent"};
+
+        return latency;
+    }
+
+private:
+    template<typename Request, typename Response>
+    std::chrono::nanoseconds round_trip(
+        void (mclr::DisplayServer::*method)(Request const*, Response*, google::protobuf::Closure*),
+        Request const& request)
+    {
+        Response response;
+        auto const start = Clock::now();
+        ((*display_server).*method)(&request, &response, google::protobuf::NewCallback(&replied, &Completion::signal));
+        replied.wait();
+        return Clock::now() - start;
+    }
+
+    static void pinged(MirConnection* connection, int32_t serial, void* context)
+    {
+        static_cast<Client*>(context)->ping_seen.signal();
+        mir_connection_pong(connection, serial);
+    }
+
+    static void platform_operation_replied(MirConnection*, MirPlatformMessage* reply, void* context)
+    {
+        auto const self = static_cast<Client*>(context);
+        self->reply = reply;
+        self->replied.signal();
+    }
+
+    MirConnection* const connection;
+    MirWindow* window;
+    MirBufferStream* stream;
+    MirPixelFormat format{mir_pixel_format_invalid};
+    std::unique_ptr<mclr::DisplayServer> display_server;
+    std::function<void()> ping_from_server;
+    mir::Fd pipe_read;
+    mir::Fd pipe_write;
+
+    Completion replied;
+    Completion ping_seen;
+    MirPlatformMessage* reply{nullptr};
+};
+
+struct Operation
+{
+    char const* name;
+    std::chrono::nanoseconds (Client::*perform)();
+};
+
+Operation const operations[] = {
+    {"pong", &Client::pong},
+    {"modify_surface", &Client::modify_surface},
+    {"allocate_buffers", &Client::allocate_buffers},
+    {"submit_buffer", &Client::submit_buffer},
+    {"event_delivery", &Client::event_delivery},
+    {"fd_passing", &Client::fd_passing}};
+
+struct Result
+{
+    char const* operation;
+    size_t clients;
+    double operations_per_second;
+    std::vector<std::chrono::nanoseconds> latencies;
+};
+
+Result run(Operation const& operation, std::vector<std::unique_ptr<Client>> const& clients, int iterations)
+{
+    std::vector<std::vector<std::chrono::nanoseconds>> latencies(clients.size());
+    std::vector<std::exception_ptr> errors(clients.size());
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t warmed_up{0};
+    bool go{false};
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i != clients.size(); ++i)
+    {
+        threads.emplace_back([&, i]
+            {
+                auto& client = *clients[i];
+                try
+                {
+                    for (int j = 0; j != warm_up_iterations; ++j)
+                        (client.*operation.perform)();
+
+                    latencies[i].reserve(iterations);
+                    {
+                        std::unique_lock<std::mutex> lock{mutex};
+                        ++warmed_up;
+                        cv.notify_all();
+                        cv.wait(lock, [&] { return go; });
+                    }
+
+                    for (int j = 0; j != iterations; ++j)
+                        latencies[i].push_back((client.*operation.perform)());
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                    std::lock_guard<std::mutex> lock{mutex};
+                    ++warmed_up;
+                    cv.notify_all();
+                }
+            });
+    }
+
+    Clock::time_point start;
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [&] { return warmed_up == clients.size(); });
+        go = true;
+        start = Clock::now();
+        cv.notify_all();
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+    std::chrono::duration<double> const elapsed = Clock::now() - start;
+
+    for (auto const& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    Result result{operation.name, clients.size(), 0, {}};
+    for (auto const& client_latencies : latencies)
+        result.latencies.insert(result.latencies.end(), client_latencies.begin(), client_latencies.end());
+    result.operations_per_second = result.latencies.size() / elapsed.count();
+    std::sort(result.latencies.begin(), result.latencies.end());
+
+    return result;
+}
+
+JsonFields fields_of(int iterations, std::vector<Result> const& results)
+{
+    JsonFields fields{{"iterations", std::to_string(iterations)}};
+
+    for (auto const& result : results)
+    {
+        auto const& latencies = result.latencies;
+        // Results come grouped by the number of clients
+        auto const path = "results." + std::to_string(result.clients) + "_clients." + result.operation + ".";
+
+        fields.emplace_back(path + "operations_per_second", std::to_string(result.operations_per_second));
+        fields.emplace_back(path + "latency_us.p50", std::to_string(percentile_us(latencies, 500)));
+        fields.emplace_back(path + "latency_us.p99", std::to_string(percentile_us(latencies, 990)));
+        fields.emplace_back(path + "latency_us.p999", std::to_string(percentile_us(latencies, 999)));
+        fields.emplace_back(path + "latency_us.max", std::to_string(percentile_us(latencies, 1000)));
+
+        // Power of two buckets, each keyed by its upper bound
+        auto bucket_limit = 1us;
+        auto sample = latencies.begin();
+        while (sample != latencies.end())
+        {
+            auto const end = std::lower_bound(sample, latencies.end(), bucket_limit);
+            fields.emplace_back(path + "histogram_us." + std::to_string(bucket_limit.count()),
+                                std::to_string(end - sample));
+            sample = end;
+            bucket_limit *= 2;
+        }
+    }
+
+    return fields;
+}
+
+struct IpcBenchmark : mtf::HeadlessInProcessServer
+{
+    IpcBenchmark()
+    {
+        add_to_environment("MIR_CLIENT_PLATFORM_PATH", (mtf::library_path() + "/client-modules").c_str());
+
+        server.add_configuration_option(clients_opt, "Largest number of concurrent clients to measure", 4);
+        server.add_configuration_option(iterations_opt, "Times each client performs each operation", 2000);
+        server.add_configuration_option(results_opt, "File to write the results to as JSON", "");
+
+        server.override_the_application_not_responding_detector([this] { return server_pinger; });
+    }
+
+    std::shared_ptr<ServerPinger> const server_pinger = std::make_shared<ServerPinger>();
+};
+}
+
+// Runs as a test so that mir_test_framework can provide main() and the server
+TEST_F(IpcBenchmark, round_trips_with_increasing_numbers_of_clients)
+{
+    auto const options = server.get_options();
+    auto const max_clients = std::max(options->get<int>(clients_opt), 1);
+    auto const iterations = options->get<int>(iterations_opt);
+
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<Result> results;
+
+    std::vector<int> client_counts;
+    for (auto count = 1; count < max_clients; count *= 2)
+        client_counts.push_back(count);
+    client_counts.push_back(max_clients);
+
+    for (auto const count : client_counts)
+    {
+        while (clients.size() != static_cast<size_t>(count))
+        {
+            auto const name = "benchmark_ipc_" + std::to_string(clients.size());
+            clients.push_back(std::make_unique<Client>(new_connection(), name, *server_pinger));
+        }
+
+        for (auto const& operation : operations)
+            results.push_back(run(operation, clients, iterations));
+    }
+
+    clients.clear();
+
+    auto const fields = fields_of(iterations, results);
+    write_json(std::cout, fields);
+
+    auto const results_file = options->get<std::string>(results_opt);
+    if (!results_file.empty())
+    {
+        std::ofstream out{results_file};
+        write_json(out, fields);
+    }
+
+    EXPECT_THAT(results, Not(IsEmpty()));
+}
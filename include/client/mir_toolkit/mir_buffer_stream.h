@@ -260,6 +260,19 @@ void mir_buffer_stream_set_size(MirBufferStream* stream, int width, int height);
  */
 void mir_buffer_stream_get_size(MirBufferStream* stream, int* width, int* height);
 
+/**
+ * Declare which parts of the current buffer have changed since the previous
+ * swap, so the server need only update those. This applies to the next
+ * mir_buffer_stream_swap_buffers() only; without it the whole buffer is
+ * assumed to have changed.
+ *
+ * \param [in] stream   The buffer stream
+ * \param [in] rects    The changed rectangles, in buffer coordinates
+ * \param [in] n_rects  The number of rectangles
+ */
+void mir_buffer_stream_set_damage(
+    MirBufferStream* stream, MirRectangle const* rects, int n_rects);
+
 #ifdef __cplusplus
 }
 /**@}*/
@@ -446,6 +446,21 @@ void mir_window_spec_set_shell_chrome(MirWindowSpec* spec, MirShellChrome style)
  */
 void mir_window_spec_set_pointer_confinement(MirWindowSpec* spec, MirPointerConfinementState state);
 
+/**
+ * Ask for motion events to be delivered once per frame.
+ *
+ * Rather than calling the event handler for every pointer and touch motion
+ * event as it arrives, the window's input is batched and resampled to just
+ * before the next frame of its frame clock. Other events are delivered as
+ * they arrive. Without a frame clock, batches are delivered immediately.
+ *
+ * This is a client-side setting, used only when creating the window.
+ *
+ * \param [in] spec    The spec to accumulate the request in.
+ * \param [in] enabled Whether to batch input.
+ */
+void mir_window_spec_set_input_batching(MirWindowSpec* spec, bool enabled);
+
 /**
  * Set the window placement on the spec.
  *
@@ -42,6 +42,10 @@ public:
     /// removes at most one matching rectangle
     void remove(Rectangle const& rect);
     void clear();
+    /// removes the area of rect from the collection, splitting rectangles as needed
+    void subtract(Rectangle const& rect);
+    /// whether every point of rect lies in at least one of the rectangles
+    bool covers(Rectangle const& rect) const;
     Rectangle bounding_rectangle() const;
     void confine(Point& point) const;
 
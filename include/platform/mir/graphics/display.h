@@ -87,6 +87,14 @@ public:
      */
     virtual std::chrono::milliseconds recommended_sleep() const = 0;
 
+    /**
+     * The last frame the group's display showed, from which the compositor
+     * predicts when the next will be and starts rendering just in time for
+     * it. Platforms that can't tell return a frame with a zero msc and leave
+     * the compositor to recommended_sleep().
+     */
+    virtual Frame last_frame() const { return {}; }
+
     virtual ~DisplaySyncGroup() = default;
 protected:
     DisplaySyncGroup() = default;
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_SHM_POOL_H_
+#define MIR_GRAPHICS_SHM_POOL_H_
+
+#include "mir/geometry/size.h"
+#include "mir_toolkit/common.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+
+/**
+ * Shared memory released by one client's software buffers, kept for reuse
+ * by its later ones.
+ *
+ * Clients may keep a buffer's memory mapped after releasing it, so a pool
+ * must only ever serve a single client.
+ */
+class ShmPool
+{
+public:
+    virtual ~ShmPool() = default;
+
+    /// Bytes of memory in buffers that are still alive
+    virtual size_t bytes_in_use() const = 0;
+    /// Bytes of memory waiting to be reused
+    virtual size_t bytes_cached() const = 0;
+
+protected:
+    ShmPool() = default;
+    ShmPool(ShmPool const&) = delete;
+    ShmPool& operator=(ShmPool const&) = delete;
+};
+
+/**
+ * Implemented by GraphicBufferAllocators whose software buffers are plain
+ * shared memory, which can be recycled through a ShmPool.
+ */
+class ShmPoolAllocator
+{
+public:
+    virtual ~ShmPoolAllocator() = default;
+
+    /// A pool keeping at most \a max_cached_bytes of released memory, least recently released dropped first
+    virtual std::shared_ptr<ShmPool> create_shm_pool(size_t max_cached_bytes) = 0;
+
+    /**
+     * Allocates a software buffer as GraphicBufferAllocator::alloc_software_buffer()
+     * does, using memory from \a pool, which must have come from create_shm_pool().
+     */
+    virtual std::shared_ptr<Buffer> alloc_software_buffer(
+        geometry::Size size, MirPixelFormat format, ShmPool& pool) = 0;
+
+protected:
+    ShmPoolAllocator() = default;
+    ShmPoolAllocator(ShmPoolAllocator const&) = delete;
+    ShmPoolAllocator& operator=(ShmPoolAllocator const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_SHM_POOL_H_ */
@@ -21,6 +21,7 @@
 #define MIR_INPUT_INPUT_REPORT_H_
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace mir
 {
@@ -38,6 +39,15 @@ public:
 
     virtual void published_motion_event(int dest_fd, uint32_t seq_id, int64_t event_time) = 0;
 
+    /// The client's channel is full, so the event waits with \a queue_depth others to be published
+    virtual void deferred_input_event(int /*dest_fd*/, uint32_t /*seq_id*/, size_t /*queue_depth*/) {}
+    /// A motion event replaced the queued one before it, carrying over its relative motion
+    virtual void coalesced_motion_event(int /*dest_fd*/, uint32_t /*seq_id*/) {}
+    /// The queue was full, so its oldest motion event was discarded
+    virtual void dropped_motion_event(int /*dest_fd*/, uint32_t /*seq_id*/) {}
+    /// The client fell so far behind that its oldest queued event, of any kind, was discarded
+    virtual void dropped_input_event(int /*dest_fd*/, uint32_t /*seq_id*/) {}
+
     virtual void opened_input_device(char const* device_name, char const* input_platform) = 0;
     virtual void failed_to_open_input_device(char const* device_name, char const* input_platform) = 0;
 
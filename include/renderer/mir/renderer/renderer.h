@@ -20,6 +20,7 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 
@@ -36,6 +37,13 @@ public:
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     // Mirroring is to be applied after orientation
     virtual void set_output_transform(MirOrientation orientation, MirMirrorMode mode) = 0;
+    /**
+     * The areas (in screen coordinates) that have changed since the previous
+     * frame. This applies to the next render() only; if it's not called then
+     * the whole viewport is assumed to have changed. Renderers that always
+     * redraw the whole viewport can ignore it, as this default does.
+     */
+    virtual void set_damage(geometry::Rectangles const& /*damage*/) {}
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
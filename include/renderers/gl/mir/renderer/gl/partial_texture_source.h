@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_
+#define MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_
+
+#include "mir/geometry/rectangles.h"
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * A texture source that can bring a texture holding an earlier frame of
+ * its stream up to date by uploading only the parts that have changed.
+ *
+ * Frames are identified by serials that are unique across streams; zero
+ * means "unknown".
+ */
+class PartialTextureSource
+{
+public:
+    virtual ~PartialTextureSource() = default;
+
+    /// The frame now held by the buffer
+    virtual uint64_t frame() const = 0;
+
+    /**
+     * Records that the buffer now holds \a frame, which differs from the
+     * stream's \a previous_frame only within \a damage (in buffer
+     * coordinates).
+     */
+    virtual void set_damage(
+        uint64_t frame,
+        uint64_t previous_frame,
+        geometry::Rectangles const& damage) = 0;
+
+    /**
+     * Updates the bound texture, which holds \a texture_frame, to match the
+     * buffer. Returns false without uploading anything if the damage needed
+     * to do so is not known, in which case the caller should bind() instead.
+     */
+    virtual bool bind_changes_since(uint64_t texture_frame) = 0;
+
+protected:
+    PartialTextureSource() = default;
+    PartialTextureSource(PartialTextureSource const&) = delete;
+    PartialTextureSource& operator=(PartialTextureSource const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_ */
@@ -45,6 +45,12 @@ public:
      * in preparation for drawing.
      */
     virtual void bind() = 0;
+    /**
+     * The number of frames since the buffer about to be rendered to was
+     * last swapped, as per EGL_EXT_buffer_age. Zero means its contents
+     * are unknown and everything must be redrawn.
+     */
+    virtual unsigned int buffer_age() { return 0; }
 
 protected:
     RenderTarget() = default;
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_BLIT_H_
+#define MIR_RENDERER_SW_BLIT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/**
+ * Row kernels for compositing 32-bit pixels with the channels in the same
+ * order (e.g. ARGB over ARGB). Source pixels are premultiplied by alpha and
+ * the kernels blend exactly as the GL renderer does.
+ *
+ * The fastest implementation the CPU supports (AVX2, SSE2 or NEON) is
+ * picked the first time any of them is used.
+ */
+namespace blit
+{
+/// dst = src
+void copy(uint32_t* dst, uint32_t const* src, size_t n);
+
+/// dst = src + dst × (1 - src.a)
+void over(uint32_t* dst, uint32_t const* src, size_t n);
+
+/// dst = src × alpha + dst × (1 - src.a × alpha)
+void over(uint32_t* dst, uint32_t const* src, size_t n, uint8_t alpha);
+
+/// dst = src × alpha + dst × (1 - alpha), ignoring src.a
+void blend(uint32_t* dst, uint32_t const* src, size_t n, uint8_t alpha);
+
+/// Swaps the first and third channels, converting ABGR to ARGB and back
+void swap_red_blue(uint32_t* dst, uint32_t const* src, size_t n);
+
+/// The instruction set the kernels use, e.g. "AVX2"
+char const* instruction_set();
+}
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_BLIT_H_ */
@@ -21,6 +21,8 @@
 
 #include "mir/graphics/renderable.h"
 
+#include <chrono>
+
 namespace mir
 {
 namespace compositor
@@ -38,6 +40,13 @@ public:
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
+
+    /// Frames will start \a budget ahead of the vblank they are for
+    virtual void chose_latency_budget(SubCompositorId /*id*/, std::chrono::nanoseconds /*budget*/) {}
+    /// A frame started just in time was not ready for its vblank
+    virtual void missed_frame(SubCompositorId /*id*/) {}
+    /// Collecting the scene for an output and compositing it took \a time, on whichever thread did it
+    virtual void composited_output(SubCompositorId /*id*/, std::chrono::nanoseconds /*time*/) {}
 protected:
     CompositorReport() = default;
     virtual ~CompositorReport() = default;
@@ -55,6 +55,16 @@ public:
      */
     virtual SceneElementSequence scene_elements_for(CompositorID id) = 0;
 
+    /**
+     * Replaces \a elements with what scene_elements_for() would return,
+     * reusing its storage. Compositors that keep one sequence from frame to
+     * frame need not allocate a new one each time.
+     */
+    virtual void collect_scene_elements(CompositorID id, SceneElementSequence& elements)
+    {
+        elements = scene_elements_for(id);
+    }
+
     /**
      * Return the number of additional frames that you need to render to get
      * fully up to date with the latest data in the scene. For a generic
@@ -21,6 +21,7 @@
 
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
+#include "mir/geometry/rectangles.h"
 #include <functional>
 #include <memory>
 
@@ -45,6 +46,16 @@ public:
     virtual ~BufferStream() = default;
     
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
+    /**
+     * As submit_buffer(buffer), but only \a damage has changed since the previous submission.
+     * Streams that don't track damage can ignore it, as this default does.
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& /*damage*/)
+    {
+        submit_buffer(buffer);
+    }
 
     virtual void add_observer(std::shared_ptr<scene::SurfaceObserver> const& observer) = 0;
     virtual void remove_observer(std::weak_ptr<scene::SurfaceObserver> const& observer) = 0;
@@ -28,6 +28,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -54,6 +55,8 @@ public:
 
     virtual bool supports_input() const = 0;
     virtual int client_input_fd() const = 0;
+    /// The shared memory and wakeup of a ring carrying input alongside the fd, if there is one
+    virtual std::vector<int> client_input_ring_fds() const { return {}; }
 
     virtual void set_cursor_image(std::shared_ptr<graphics::CursorImage> const& image) = 0;
     virtual void set_cursor_stream(std::shared_ptr<frontend::BufferStream> const& image,
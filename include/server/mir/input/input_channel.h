@@ -33,6 +33,11 @@ public:
     virtual int client_fd() const = 0;
     virtual int server_fd() const = 0;
 
+    /// The shared memory of a ring carrying input alongside the sockets, or -1 for none
+    virtual int ring_fd() const { return -1; }
+    /// Signals the client that the ring has input, or -1 for no ring
+    virtual int ring_wakeup_fd() const { return -1; }
+
 protected:
     InputChannel() = default;
     InputChannel(InputChannel const&) = delete;
@@ -49,6 +49,7 @@ class Surface
 public:
     virtual std::string name() const = 0;
     virtual geometry::Rectangle input_bounds() const = 0;
+    /// Whether \a point is in the input area, which lies within input_bounds()
     virtual bool input_area_contains(geometry::Point const& point) const = 0;
     virtual std::shared_ptr<input::InputChannel> input_channel() const = 0;
     virtual std::shared_ptr<graphics::CursorImage> cursor_image() const = 0;
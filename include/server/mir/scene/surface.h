@@ -65,6 +65,12 @@ public:
     virtual geometry::Size size() const = 0;
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
+    /// Appends what generate_renderables() would return to \a renderables
+    virtual void collect_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const
+    {
+        auto const generated = generate_renderables(id);
+        renderables.insert(renderables.end(), generated.begin(), generated.end());
+    }
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
 
     virtual float alpha() const = 0; //only used in examples/
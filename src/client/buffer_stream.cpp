@@ -106,11 +106,38 @@ public:
         request.mutable_id()->set_value(stream_id);
         request.mutable_buffer()->set_buffer_id(buffer.rpc_id());
 
+        {
+            std::lock_guard<decltype(mutex)> lock(mutex);
+            if (damage.is_set())
+            {
+                // An empty rectangle tells the server nothing has changed
+                if (damage.value() == geom::Rectangles{})
+                    damage.value().add({});
+
+                for (auto const& rect : damage.value())
+                {
+                    auto const r = request.add_damage();
+                    r->set_left(rect.top_left.x.as_int());
+                    r->set_top(rect.top_left.y.as_int());
+                    r->set_width(rect.size.width.as_uint32_t());
+                    r->set_height(rect.size.height.as_uint32_t());
+                }
+                damage.consume();
+            }
+        }
+
         auto protobuf_void = std::make_shared<mp::Void>();
         server.submit_buffer(&request, protobuf_void.get(),
             google::protobuf::NewCallback(Requests::ignore_response, protobuf_void));
     }
 
+    // Applies to the next submission only
+    void set_damage(geom::Rectangles const& new_damage)
+    {
+        std::lock_guard<decltype(mutex)> lock(mutex);
+        damage = new_damage;
+    }
+
     static void ignore_response(std::shared_ptr<mp::Void>)
     {
     }
@@ -119,6 +146,9 @@ private:
     mclr::DisplayServer& server;
     int stream_id;
     std::shared_ptr<mcl::ClientPlatform> const platform;
+
+    std::mutex mutex;
+    mir::optional_value<geom::Rectangles> damage;
 };
 
 mir::optional_value<int> parse_env_for_swap_interval()
@@ -145,11 +175,12 @@ struct BufferDepository
     BufferDepository(
         std::shared_ptr<mcl::ClientBufferFactory> const& factory,
         std::shared_ptr<mcl::AsyncBufferFactory> const& mirbuffer_factory,
-        std::shared_ptr<mcl::ServerBufferRequests> const& requests,
+        std::shared_ptr<Requests> const& requests,
         std::weak_ptr<mcl::SurfaceMap> const& surface_map,
         geom::Size size, MirPixelFormat format, int usage,
         unsigned int initial_nbuffers) :
         vault(factory, mirbuffer_factory, requests, surface_map, size, format, usage, initial_nbuffers),
+        requests(requests),
         current(nullptr),
         size_(size)
     {
@@ -216,6 +247,11 @@ struct BufferDepository
         return size_;
     }
 
+    void set_damage(geom::Rectangles const& damage)
+    {
+        requests->set_damage(damage);
+    }
+
     void lost_connection()
     {
         vault.disconnected();
@@ -241,6 +277,7 @@ struct BufferDepository
     mir::client::NoTLSFuture<std::shared_ptr<mcl::MirBuffer>> future;
 
     mcl::BufferVault vault;
+    std::shared_ptr<Requests> const requests;
     std::mutex mutable mutex;
     std::shared_ptr<mcl::MirBuffer> current{nullptr};
     MirWaitHandle scale_wait_handle;
@@ -615,6 +652,11 @@ geom::Size mcl::BufferStream::size() const
     return buffer_depository->size();
 }
 
+void mcl::BufferStream::set_damage(geom::Rectangles const& damage)
+{
+    buffer_depository->set_damage(damage);
+}
+
 MirWaitHandle* mcl::BufferStream::set_scale(float scale)
 {
     return buffer_depository->set_scale(scale, mf::BufferStreamId(protobuf_bs->id().value()));
@@ -126,6 +126,7 @@ public:
     void buffer_unavailable() override;
     void set_size(geometry::Size) override;
     geometry::Size size() const override;
+    void set_damage(geometry::Rectangles const& damage) override;
     MirWaitHandle* set_scale(float scale) override;
     char const* get_error_message() const override;
     MirConnection* connection() const override;
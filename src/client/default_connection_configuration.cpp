@@ -36,6 +36,7 @@
 #include "lifecycle_control.h"
 #include "mir/client_platform_factory.h"
 #include "probing_client_platform_factory.h"
+#include "mir/module_probe_cache.h"
 #include "mir_event_distributor.h"
 #include "buffer_factory.h"
 
@@ -106,11 +107,16 @@ mcl::DefaultConnectionConfiguration::the_client_platform_factory()
             else
                 paths.push_back(MIR_CLIENT_PLATFORM_PATH);
 
+            std::shared_ptr<mir::ModuleProbeCache> probe_cache;
+            if (auto const cache = getenv("MIR_CLIENT_PLATFORM_PROBE_CACHE"))
+                probe_cache = std::make_shared<mir::ModuleProbeCache>(cache);
+
             return std::make_shared<mcl::ProbingClientPlatformFactory>(
                                          the_shared_library_prober_report(),
                                          libs,
                                          paths,
-                                         the_logger()
+                                         the_logger(),
+                                         probe_cache
                                          );
         });
 }
@@ -124,3 +124,4 @@ mir::geometry::Size mcl::ErrorStream::size() const
 void mcl::ErrorStream::buffer_available(mir::protobuf::Buffer const&) {}
 void mcl::ErrorStream::buffer_unavailable() {}
 void mcl::ErrorStream::set_size(mir::geometry::Size) {}
+void mcl::ErrorStream::set_damage(mir::geometry::Rectangles const&) {}
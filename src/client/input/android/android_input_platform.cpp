@@ -42,6 +42,25 @@ std::shared_ptr<md::Dispatchable> mircva::AndroidInputPlatform::create_input_rec
     return std::make_shared<mircva::InputReceiver>(fd, keymapper, callback, report);
 }
 
+std::shared_ptr<md::Dispatchable> mircva::AndroidInputPlatform::create_batching_input_receiver(
+    int fd,
+    std::shared_ptr<mircv::XKBMapper> const& keymapper,
+    std::function<void(MirEvent*)> const& callback,
+    std::function<time::PosixTimestamp()> const& next_frame)
+{
+    return std::make_shared<mircva::InputReceiver>(fd, keymapper, callback, report, next_frame);
+}
+
+std::shared_ptr<md::Dispatchable> mircva::AndroidInputPlatform::create_ring_input_receiver(
+    int fd,
+    std::shared_ptr<InputRing> const& ring,
+    std::shared_ptr<mircv::XKBMapper> const& keymapper,
+    std::function<void(MirEvent*)> const& callback,
+    std::function<time::PosixTimestamp()> const& next_frame)
+{
+    return std::make_shared<mircva::InputReceiver>(fd, keymapper, callback, report, next_frame, ring);
+}
+
 std::shared_ptr<mircv::InputPlatform> mircv::InputPlatform::create()
 {
     return create(std::make_shared<mircv::NullInputReceiverReport>());
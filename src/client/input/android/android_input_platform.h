@@ -44,6 +44,17 @@ public:
     std::shared_ptr<dispatch::Dispatchable> create_input_receiver(int fd,
                                                                   std::shared_ptr<XKBMapper> const& mapper,
                                                                   std::function<void(MirEvent*)> const& callback);
+    std::shared_ptr<dispatch::Dispatchable> create_batching_input_receiver(
+        int fd,
+        std::shared_ptr<XKBMapper> const& mapper,
+        std::function<void(MirEvent*)> const& callback,
+        std::function<time::PosixTimestamp()> const& next_frame);
+    std::shared_ptr<dispatch::Dispatchable> create_ring_input_receiver(
+        int fd,
+        std::shared_ptr<InputRing> const& ring,
+        std::shared_ptr<XKBMapper> const& mapper,
+        std::function<void(MirEvent*)> const& callback,
+        std::function<time::PosixTimestamp()> const& next_frame);
 
 protected:
     AndroidInputPlatform(const AndroidInputPlatform&) = delete;
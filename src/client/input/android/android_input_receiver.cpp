@@ -21,6 +21,7 @@
 #include "mir/input/xkb_mapper.h"
 #include "mir/input/input_receiver_report.h"
 #include "mir/input/android/android_input_lexicon.h"
+#include "mir/input/input_ring.h"
 #include "mir/events/event_private.h"
 
 #include <boost/throw_exception.hpp>
@@ -30,6 +31,7 @@
 #include <sys/timerfd.h>
 #include <sys/eventfd.h>
 #include <system_error>
+#include <algorithm>
 #include <cstdlib>
 
 namespace mircv = mir::input::receiver;
@@ -48,34 +50,61 @@ int valid_fd_or_system_error(int fd, char const* message)
                                                  message}));
     return fd;
 }
+
+mir::Fd frame_timer_for(std::function<mir::time::PosixTimestamp()> const& next_frame)
+{
+    if (!next_frame)
+        return mir::Fd{};
+
+    return mir::Fd{valid_fd_or_system_error(
+        timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK),
+        "Failed to create frame timer")};
+}
 }
 
 mircva::InputReceiver::InputReceiver(droidinput::sp<droidinput::InputChannel> const& input_channel,
                                      std::shared_ptr<mircv::XKBMapper> const& keymapper,
                                      std::function<void(MirEvent*)> const& event_handling_callback,
-                                     std::shared_ptr<mircv::InputReceiverReport> const& report)
+                                     std::shared_ptr<mircv::InputReceiverReport> const& report,
+                                     std::function<time::PosixTimestamp()> const& next_frame,
+                                     std::shared_ptr<InputRing> const& ring)
   : wake_fd{valid_fd_or_system_error(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK),
         "Failed to create IO wakeup notifier")},
     input_channel(input_channel),
+    ring{ring},
     handler{event_handling_callback},
     xkb_mapper(keymapper),
     report(report),
-    input_consumer(std::make_shared<droidinput::InputConsumer>(input_channel))
+    input_consumer(std::make_shared<droidinput::InputConsumer>(input_channel)),
+    next_frame{next_frame},
+    frame_timer{frame_timer_for(next_frame)}
 {
     dispatcher.add_watch(wake_fd,
                          [this]() { woke(); });
     dispatcher.add_watch(mir::Fd{mir::IntOwnedFd{input_channel->getFd()}},
                          [this]() { woke(); });
+    if (ring)
+    {
+        dispatcher.add_watch(ring->wakeup_fd(), [this]() { woke(); });
+        // Only now that there is someone to read it will the server use the ring
+        ring->attach_consumer();
+    }
+    if (next_frame)
+        dispatcher.add_watch(frame_timer, [this]() { frame_due(); });
 }
 
 mircva::InputReceiver::InputReceiver(int fd,
                                      std::shared_ptr<mircv::XKBMapper> const& keymapper,
                                      std::function<void(MirEvent*)> const& event_handling_callback,
-                                     std::shared_ptr<mircv::InputReceiverReport> const& report)
-    : InputReceiver(new droidinput::InputChannel(droidinput::String8(""), fd),
+                                     std::shared_ptr<mircv::InputReceiverReport> const& report,
+                                     std::function<time::PosixTimestamp()> const& next_frame,
+                                     std::shared_ptr<InputRing> const& ring)
+    : InputReceiver(new droidinput::InputChannel(droidinput::String8(""), fd, ring),
                     keymapper,
                     event_handling_callback,
-                    report)
+                    report,
+                    next_frame,
+                    ring)
 {
 }
 
@@ -131,13 +160,43 @@ void mircva::InputReceiver::woke()
                                                  "Failed to consume notification"}));
     }
 
+    if (!next_frame)
+    {
+        consume(true, std::chrono::nanoseconds(-1));
+    }
+    else
+    {
+        /*
+         * Any frame time that isn't negative makes the consumer batch motion
+         * rather than return it; frame_due() sends batches on their way.
+         */
+        consume(false, std::chrono::nanoseconds(0));
+        if (input_consumer->hasPendingBatch())
+            schedule_frame();
+    }
+
+    if (input_consumer->hasDeferredEvent())
+    {
+        // input_consumer->consume() can read an event from the fd and find that the event cannot
+        // be added to the current batch.
+        //
+        // In this case, it emits the current batch and leaves the new event pending.
+        // This means we have an event we need to dispatch, but as it has already been read from
+        // the fd we cannot rely on being woken by the fd being readable.
+        //
+        // So, we ensure we'll appear dispatchable by pushing an event to the wakeup pipe.
+        wake();
+    }
+}
+
+bool mircva::InputReceiver::consume(bool consume_batches, std::chrono::nanoseconds sample_time)
+{
     droidinput::InputEvent *android_event;
     uint32_t event_sequence_id;
 
-    auto const frame_time = std::chrono::nanoseconds(-1);
     auto result = input_consumer->consume(&event_factory,
-                                          true,
-                                          frame_time,
+                                          consume_batches,
+                                          sample_time,
                                           &event_sequence_id,
                                           &android_event);
     if (result == droidinput::OK)
@@ -152,18 +211,72 @@ void mircva::InputReceiver::woke()
         //       get passed on to someone else - passed into here:
         input_consumer->sendFinishedSignal(event_sequence_id, true);
     }
-    if (input_consumer->hasDeferredEvent())
+
+    return result == droidinput::OK;
+}
+
+void mircva::InputReceiver::frame_due()
+{
+    uint64_t expirations;
+    if (read(frame_timer, &expirations, sizeof(expirations)) != sizeof(expirations) &&
+        errno != EAGAIN &&
+        errno != EINTR)
     {
-        // input_consumer->consume() can read an event from the fd and find that the event cannot
-        // be added to the current batch.
-        //
-        // In this case, it emits the current batch and leaves the new event pending.
-        // This means we have an event we need to dispatch, but as it has already been read from
-        // the fd we cannot rely on being woken by the fd being readable.
-        //
-        // So, we ensure we'll appear dispatchable by pushing an event to the wakeup pipe.
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to read frame timer"}));
+    }
+
+    frame_pending = false;
+
+    // Each call delivers one device's batch, resampled for the frame
+    while (consume(true, frame_time))
+        ;
+
+    // Samples too recent for this frame wait for the next
+    if (input_consumer->hasPendingBatch())
+        schedule_frame();
+
+    if (input_consumer->hasDeferredEvent())
         wake();
+}
+
+void mircva::InputReceiver::schedule_frame()
+{
+    if (frame_pending)
+        return;
+
+    auto const frame = next_frame();
+    auto const now = time::PosixTimestamp::now(frame.clock_id);
+    auto const delay = frame.nanoseconds - now.nanoseconds;
+
+    if (delay.count() > 0)
+    {
+        auto const monotonic_now = frame.clock_id == CLOCK_MONOTONIC ?
+            now : time::PosixTimestamp::now(CLOCK_MONOTONIC);
+        frame_time = monotonic_now.nanoseconds + delay;
+    }
+    else
+    {
+        // No frame to wait for; hand over whole batches as soon as we can
+        frame_time = std::chrono::nanoseconds(-1);
+    }
+
+    // A zero it_value would disarm the timer, so fire "immediately" as 1ns
+    auto const wait = std::max(delay, std::chrono::nanoseconds{1});
+    itimerspec const timeout{
+        {0, 0},
+        {static_cast<time_t>(wait.count() / 1000000000LL),
+         static_cast<long>(wait.count() % 1000000000LL)}};
+
+    if (timerfd_settime(frame_timer, 0, &timeout, nullptr) == -1)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to arm frame timer"}));
     }
+
+    frame_pending = true;
 }
 
 void mircva::InputReceiver::wake()
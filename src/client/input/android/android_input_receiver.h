@@ -23,6 +23,7 @@
 
 #include "mir/dispatch/dispatchable.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/time/posix_timestamp.h"
 
 #include <utils/StrongPointer.h>
 #include <androidfw/Input.h>
@@ -44,6 +45,8 @@ namespace mir
 {
 namespace input
 {
+class InputRing;
+
 namespace receiver
 {
 class XKBMapper;
@@ -52,18 +55,34 @@ class InputReceiverReport;
 namespace android
 {
 
-/// Synchronously receives input events in a blocking manner
+/**
+ * Synchronously receives input events in a blocking manner
+ *
+ * Given a \a next_frame source, motion is batched rather than delivered as
+ * it arrives: once per frame the receiver delivers each device's motion
+ * resampled to just before the time that source returns. If that time
+ * isn't in the future (there is no frame clock) batches go out at once.
+ * Everything else is delivered as it arrives, after any motion that came
+ * before it.
+ *
+ * Given a \a ring the receiver attaches to it, and takes input from there
+ * once the server has moved over from the socket.
+ */
 class InputReceiver : public dispatch::Dispatchable
 {
 public:
     InputReceiver(droidinput::sp<droidinput::InputChannel> const& input_channel,
                   std::shared_ptr<XKBMapper> const& keymapper,
                   std::function<void(MirEvent*)> const& event_handling_callback,
-                  std::shared_ptr<InputReceiverReport> const& report);
+                  std::shared_ptr<InputReceiverReport> const& report,
+                  std::function<time::PosixTimestamp()> const& next_frame = {},
+                  std::shared_ptr<InputRing> const& ring = {});
     InputReceiver(int fd,
                   std::shared_ptr<XKBMapper> const& keymapper,
                   std::function<void(MirEvent*)> const& event_handling_callback,
-                  std::shared_ptr<InputReceiverReport> const& report);
+                  std::shared_ptr<InputReceiverReport> const& report,
+                  std::function<time::PosixTimestamp()> const& next_frame = {},
+                  std::shared_ptr<InputRing> const& ring = {});
 
     virtual ~InputReceiver();
 
@@ -80,6 +99,7 @@ private:
     Fd const wake_fd;
 
     droidinput::sp<droidinput::InputChannel> input_channel;
+    std::shared_ptr<InputRing> const ring;
     std::function<void(MirEvent*)> const handler;
     std::shared_ptr<XKBMapper> const xkb_mapper;
     std::shared_ptr<InputReceiverReport> const report;
@@ -87,8 +107,16 @@ private:
     std::shared_ptr<droidinput::InputConsumer> input_consumer;
     droidinput::PreallocatedInputEventFactory event_factory;
 
+    std::function<time::PosixTimestamp()> const next_frame;
+    Fd const frame_timer;
+    bool frame_pending{false};
+    std::chrono::nanoseconds frame_time{-1}; // CLOCK_MONOTONIC, as event times are
+
     void woke();
     void wake();
+    bool consume(bool consume_batches, std::chrono::nanoseconds sample_time);
+    void frame_due();
+    void schedule_frame();
 };
 
 }
@@ -19,6 +19,7 @@
 #include "rpc_report.h"
 
 #include "mir/logging/logger.h"
+#include "mir/protobuf/method_ids.h"
 
 #include "mir_protobuf_wire.pb.h"
 
@@ -43,7 +44,7 @@ void mcll::RpcReport::invocation_requested(
 {
     std::stringstream ss;
     ss << "Invocation request: id: " << invocation.id()
-       << " method_name: " << invocation.method_name();
+       << " method_name: " << mir::protobuf::method_name_of(invocation);
 
     logger->log(ml::Severity::debug, ss.str(), component);
 }
@@ -53,7 +54,7 @@ void mcll::RpcReport::invocation_succeeded(
 {
     std::stringstream ss;
     ss << "Invocation succeeded: id: " << invocation.id()
-       << " method_name: " << invocation.method_name();
+       << " method_name: " << mir::protobuf::method_name_of(invocation);
 
     logger->log(ml::Severity::debug, ss.str(), component);
 }
@@ -64,7 +65,7 @@ void mcll::RpcReport::invocation_failed(
 {
     std::stringstream ss;
     ss << "Invocation failed: id: " << invocation.id()
-       << " method_name: " << invocation.method_name()
+       << " method_name: " << mir::protobuf::method_name_of(invocation)
        << " error: " << boost::diagnostic_information(ex);
 
     logger->log(ml::Severity::error, ss.str(), component);
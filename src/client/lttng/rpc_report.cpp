@@ -18,6 +18,7 @@
 
 #include "rpc_report.h"
 #include "mir/report/lttng/mir_tracepoint.h"
+#include "mir/protobuf/method_ids.h"
 
 #include "mir_protobuf_wire.pb.h"
 
@@ -31,14 +32,14 @@ void mcl::lttng::RpcReport::invocation_requested(
     mir::protobuf::wire::Invocation const& invocation)
 {
     mir_tracepoint(mir_client_rpc, invocation_requested,
-                   invocation.id(), invocation.method_name().c_str());
+                   invocation.id(), mir::protobuf::method_name_of(invocation).c_str());
 }
 
 void mcl::lttng::RpcReport::invocation_succeeded(
     mir::protobuf::wire::Invocation const& invocation)
 {
     mir_tracepoint(mir_client_rpc, invocation_succeeded,
-                   invocation.id(), invocation.method_name().c_str());
+                   invocation.id(), mir::protobuf::method_name_of(invocation).c_str());
 }
 
 void mcl::lttng::RpcReport::invocation_failed(
@@ -271,3 +271,20 @@ catch (std::exception const& ex)
     *width = -1;
     *height = -1;
 }
+
+void mir_buffer_stream_set_damage(MirBufferStream* stream, MirRectangle const* rects, int n_rects)
+try
+{
+    mir::require(stream);
+    mir::require(n_rects >= 0);
+    mir::require(rects || n_rects == 0);
+
+    mir::geometry::Rectangles damage;
+    for (auto rect = rects; rect != rects + n_rects; ++rect)
+        damage.add({{rect->left, rect->top}, {rect->width, rect->height}});
+    stream->set_damage(damage);
+}
+catch (std::exception const& ex)
+{
+    MIR_LOG_UNCAUGHT_EXCEPTION(ex);
+}
@@ -29,6 +29,7 @@
 #include "mir/mir_buffer_stream.h"
 #include "mir/dispatch/threaded_dispatcher.h"
 #include "mir/input/input_platform.h"
+#include "mir/input/input_ring.h"
 #include "mir/input/xkb_mapper.h"
 #include "mir/cookie/cookie.h"
 #include "mir_cookie.h"
@@ -54,6 +55,26 @@ namespace
 {
 std::mutex handle_mutex;
 std::unordered_set<MirWindow*> valid_surfaces;
+
+// The server may send the shared memory and wakeup of an input ring after the input fd
+std::shared_ptr<mi::InputRing> input_ring_of(mp::Surface const& surface)
+{
+    if (surface.fd_size() < 3)
+        return nullptr;
+
+    try
+    {
+        // The surface keeps the fds, closing them when it goes
+        return std::make_shared<mi::InputRing>(
+            mir::Fd{mir::IntOwnedFd{surface.fd(1)}},
+            mir::Fd{mir::IntOwnedFd{surface.fd(2)}});
+    }
+    catch (std::exception const&)
+    {
+        // Input still comes through the socket
+        return nullptr;
+    }
+}
 }
 
 #pragma GCC diagnostic push
@@ -141,7 +162,8 @@ MirSurface::MirSurface(
       size({surface_proto.width(), surface_proto.height()}),
       format(static_cast<MirPixelFormat>(surface_proto.pixel_format())),
       usage(static_cast<MirBufferUsage>(surface_proto.buffer_usage())),
-      output_id(spec.output_id.is_set() ? spec.output_id.value() : static_cast<uint32_t>(mir_display_output_id_invalid))
+      output_id(spec.output_id.is_set() ? spec.output_id.value() : static_cast<uint32_t>(mir_display_output_id_invalid)),
+      batch_input(spec.batch_input.is_set() && spec.batch_input.value())
 {
     if (default_stream)
         streams.insert(default_stream);
@@ -179,7 +201,7 @@ MirSurface::MirSurface(
     if (surface_proto.fd_size() > 0 && handle_event_callback)
     {
         input_thread = std::make_shared<md::ThreadedDispatcher>("Input dispatch", 
-            input_platform->create_input_receiver( surface_proto.fd(0), keymapper, handle_event_callback));
+            create_input_receiver(surface_proto.fd(0)));
     }
 
     std::lock_guard<decltype(handle_mutex)> lock(handle_mutex);
@@ -470,14 +492,49 @@ void MirSurface::set_event_handler(MirWindowEventCallback callback,
 
         if (surface->fd_size() > 0 && handle_event_callback)
         {
-            auto input_dispatcher = input_platform->create_input_receiver(surface->fd(0),
-                                                                          keymapper,
-                                                                          handle_event_callback);
+            auto input_dispatcher = create_input_receiver(surface->fd(0));
             input_thread = std::make_shared<md::ThreadedDispatcher>("Input dispatch", input_dispatcher);
         }
     }
 }
 
+std::shared_ptr<md::Dispatchable> MirSurface::create_input_receiver(int fd)
+{
+    auto const ring = input_ring_of(*surface);
+
+    if (!batch_input && ring)
+        return input_platform->create_ring_input_receiver(fd, ring, keymapper, handle_event_callback, {});
+
+    if (!batch_input)
+        return input_platform->create_input_receiver(fd, keymapper, handle_event_callback);
+
+    // Only ever called from the receiver's own dispatch thread
+    auto next_frame = [clock = frame_clock, last = mir::time::PosixTimestamp{}]() mutable
+        {
+            auto next = clock->next_frame_after(last);
+
+            // No period: there's no frame to wait for, so don't
+            if (next == last)
+                return mir::time::PosixTimestamp{};
+
+            // Frames we've already missed are no use for resampling
+            if (next <= mir::time::PosixTimestamp::now(next.clock_id))
+            {
+                auto const after = clock->next_frame_after(next);
+                if (!(after == next))
+                    next = after;
+            }
+
+            last = next;
+            return next;
+        };
+
+    if (ring)
+        return input_platform->create_ring_input_receiver(fd, ring, keymapper, handle_event_callback, next_frame);
+
+    return input_platform->create_batching_input_receiver(fd, keymapper, handle_event_callback, next_frame);
+}
+
 void MirSurface::handle_event(MirEvent const& e)
 {
     std::unique_lock<decltype(mutex)> lock(mutex);
@@ -44,6 +44,7 @@ namespace mir
 {
 namespace dispatch
 {
+class Dispatchable;
 class ThreadedDispatcher;
 }
 namespace input
@@ -143,6 +144,7 @@ struct MirSurfaceSpec
     mir::optional_value<std::vector<ContentInfo>> streams;
     mir::optional_value<std::vector<MirRectangle>> input_shape;
     mir::optional_value<bool> confine_pointer;
+    mir::optional_value<bool> batch_input;
 
     struct EventHandler
     {
@@ -226,6 +228,7 @@ private:
     std::mutex mutable mutex; // Protects all members of *this
 
     void configure_frame_clock();
+    std::shared_ptr<mir::dispatch::Dispatchable> create_input_receiver(int fd);
     void on_configured();
     void on_cursor_configured();
     void acquired_persistent_id(MirWindowIdCallback callback, void* context);
@@ -274,7 +277,7 @@ private:
     MirPixelFormat format;
     MirBufferUsage usage;
     uint32_t output_id;
-
+    bool const batch_input{false};
 };
 
 #pragma GCC diagnostic pop
@@ -397,6 +397,17 @@ catch (std::exception const& ex)
     MIR_LOG_UNCAUGHT_EXCEPTION(ex);
 }
 
+void mir_window_spec_set_input_batching(MirWindowSpec* spec, bool enabled)
+try
+{
+    mir::require(spec);
+    spec->batch_input = enabled;
+}
+catch (std::exception const& ex)
+{
+    MIR_LOG_UNCAUGHT_EXCEPTION(ex);
+}
+
 void mir_window_spec_set_placement(MirWindowSpec* spec,
                                    MirRectangle const* rect,
                                    MirPlacementGravity rect_gravity,
@@ -1,8 +1,10 @@
 #include "probing_client_platform_factory.h"
 #include "mir/client_platform.h"
+#include "mir/client_context.h"
 #include "mir/shared_library.h"
 #include "mir/shared_library_prober.h"
 #include "mir/shared_library_prober_report.h"
+#include "mir/module_probe_cache.h"
 
 #include <boost/exception/all.hpp>
 #include <stdexcept>
@@ -13,11 +15,13 @@ mcl::ProbingClientPlatformFactory::ProbingClientPlatformFactory(
     std::shared_ptr<mir::SharedLibraryProberReport> const& rep,
     StringList const& force_libs,
     StringList const& lib_paths,
-    std::shared_ptr<mir::logging::Logger> const& logger)
+    std::shared_ptr<mir::logging::Logger> const& logger,
+    std::shared_ptr<mir::ModuleProbeCache> const& probe_cache)
     : shared_library_prober_report{rep},
       platform_overrides{force_libs},
       platform_paths{lib_paths},
-      logger{logger}
+      logger{logger},
+      probe_cache{probe_cache}
 {
     if (platform_overrides.empty() && platform_paths.empty())
     {
@@ -32,8 +36,9 @@ mcl::ProbingClientPlatformFactory::create_client_platform(mcl::ClientContext* co
     // Note we don't want to keep unused platform modules loaded any longer
     // than it takes to choose the right one. So this list is local:
     std::vector<std::shared_ptr<mir::SharedLibrary>> platform_modules;
+    ClientPlatformProbe chosen_probe{nullptr};
 
-    auto const module_selector = [context, &platform_modules](std::shared_ptr<mir::SharedLibrary> const& module)
+    auto const module_selector = [context, &platform_modules, &chosen_probe](std::shared_ptr<mir::SharedLibrary> const& module)
     {
         try
         {
@@ -41,6 +46,7 @@ mcl::ProbingClientPlatformFactory::create_client_platform(mcl::ClientContext* co
             if (probe(context))
             {
                 platform_modules.push_back(module);
+                chosen_probe = probe;
                 return Selection::quit;
             }
         }
@@ -62,6 +68,43 @@ mcl::ProbingClientPlatformFactory::create_client_platform(mcl::ClientContext* co
         for (auto const& platform : platform_overrides)
             module_selector(std::make_shared<mir::SharedLibrary>(platform));
     }
+    else if (probe_cache && platform_paths.size() == 1)
+    {
+        // Which module suits depends on the server's, so that is part of the context
+        MirModuleProperties server_graphics_module{};
+        context->populate_graphics_module(server_graphics_module);
+        auto const cache_context =
+            std::string{server_graphics_module.name ? server_graphics_module.name : ""} + ' ' +
+            std::to_string(server_graphics_module.major_version) + '.' +
+            std::to_string(server_graphics_module.minor_version);
+        auto const& path = platform_paths.front();
+
+        mir::ModuleProbeCache::Choice choice;
+        if (probe_cache->lookup(path, cache_context, choice))
+        {
+            try
+            {
+                shared_library_prober_report->loading_library(choice.module);
+                module_selector(std::make_shared<mir::SharedLibrary>(choice.module));
+            }
+            catch (std::runtime_error const& error)
+            {
+                shared_library_prober_report->loading_failed(choice.module, error);
+            }
+        }
+
+        if (platform_modules.empty())
+        {
+            select_libraries_for_path(path, module_selector, *shared_library_prober_report);
+
+            if (chosen_probe)
+            {
+                auto const module = mir::ModuleProbeCache::module_containing(reinterpret_cast<void const*>(chosen_probe));
+                if (!module.empty())
+                    probe_cache->store(path, cache_context, {module, 1});
+            }
+        }
+    }
     else
     {
         for (auto const& path : platform_paths)
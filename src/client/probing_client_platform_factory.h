@@ -8,6 +8,7 @@
 
 namespace mir
 {
+class ModuleProbeCache;
 class SharedLibraryProberReport;
 
 namespace client
@@ -20,7 +21,8 @@ public:
         std::shared_ptr<mir::SharedLibraryProberReport> const& rep,
         StringList const& force_libs,
         StringList const& lib_paths,
-        std::shared_ptr<mir::logging::Logger> const& logger);
+        std::shared_ptr<mir::logging::Logger> const& logger,
+        std::shared_ptr<mir::ModuleProbeCache> const& probe_cache = nullptr);
 
     std::shared_ptr<ClientPlatform> create_client_platform(ClientContext *context) override;
 
@@ -29,6 +31,7 @@ private:
     StringList const platform_overrides;
     StringList const platform_paths;
     std::shared_ptr<mir::logging::Logger> const logger;
+    std::shared_ptr<mir::ModuleProbeCache> const probe_cache;
 };
 
 }
@@ -32,6 +32,7 @@
 #include "../mir_error.h"
 #include "mir/input/input_devices.h"
 #include "mir/variable_length_array.h"
+#include "mir/protobuf/method_ids.h"
 #include "mir/events/event_builders.h"
 #include "mir/events/event_private.h"
 #include "mir/events/serialization.h"
@@ -173,6 +174,9 @@ void mclr::MirProtobufRpcChannel::receive_file_descriptors(google::protobuf::Mes
         auto connection = static_cast<mir::protobuf::Connection*>(response);
         if (connection && connection->has_platform())
             platform = connection->mutable_platform();
+        // Not a file descriptor, but this is where we see the connect() result
+        if (connection && connection->method_ids_accepted())
+            method_ids_accepted = true;
     }
     else if (message_type == "mir.protobuf.SocketFD")
     {
@@ -227,7 +231,17 @@ void mclr::MirProtobufRpcChannel::call_method(
             fds.emplace_back(mir::Fd{IntOwnedFd{fd}});
     }
 
-    auto const& invocation = invocation_for(method_name, parameters, fds.size());
+    auto invocation = invocation_for(method_name, parameters, fds.size());
+
+    if (method_ids_accepted)
+    {
+        auto const id = mir::protobuf::method_id(method_name);
+        if (id != mir::protobuf::MethodId::none)
+        {
+            invocation.set_method_id(static_cast<uint32_t>(id));
+            invocation.set_method_name("");
+        }
+    }
 
     rpc_report->invocation_requested(invocation);
 
@@ -105,6 +105,8 @@ private:
     std::shared_ptr<RpcReport> const rpc_report;
     detail::PendingCallCache pending_calls;
     std::atomic_bool discard{false};
+    // Whether the server dispatches on Invocation::method_id
+    std::atomic_bool method_ids_accepted{false};
 
     static constexpr size_t size_of_header = 2;
     detail::SendBuffer header_bytes;
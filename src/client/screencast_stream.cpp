@@ -285,6 +285,11 @@ geom::Size mcl::ScreencastStream::size() const
     BOOST_THROW_EXCEPTION(std::logic_error("Attempt to get size on screencast is invalid"));
 }
 
+void mcl::ScreencastStream::set_damage(geom::Rectangles const&)
+{
+    BOOST_THROW_EXCEPTION(std::logic_error("Attempt to set damage on screencast is invalid"));
+}
+
 MirWaitHandle* mcl::ScreencastStream::set_scale(float)
 {
     BOOST_THROW_EXCEPTION(std::logic_error("Attempt to set scale on screencast is invalid"));
@@ -22,7 +22,12 @@
 #include "mir/posix_rw_mutex.h"
 
 #include <boost/throw_exception.hpp>
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
 
 #include <sys/epoll.h>
 #include <poll.h>
@@ -36,6 +41,46 @@ namespace md = mir::dispatch;
 
 namespace
 {
+// The most ready sources one dispatch() takes from the kernel. Each
+// wakeup is shared between them, but they are held up by one another
+int const max_sources_per_dispatch{16};
+
+/*
+ * Counts each MultiplexingDispatchable's calls to remove_watch() that removed
+ * something, so that dispatch() can tell when it needs to check that sources
+ * it holds are still wanted. The counts live here rather than in the class so
+ * that its layout, which is part of mircommon's ABI, is unchanged.
+ */
+class RemovalCounts
+{
+public:
+    std::atomic<unsigned>& of(md::MultiplexingDispatchable const* owner)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        return counts.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(owner),
+            std::forward_as_tuple(0u)).first->second;
+    }
+
+    void forget(md::MultiplexingDispatchable const* owner)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        counts.erase(owner);
+    }
+
+private:
+    std::mutex mutex;
+    // Nodes don't move, so references to the counts stay valid until forgotten
+    std::unordered_map<md::MultiplexingDispatchable const*, std::atomic<unsigned>> counts;
+};
+
+RemovalCounts& removal_counts()
+{
+    static RemovalCounts counts;
+    return counts;
+}
+
 class DispatchableAdaptor : public md::Dispatchable
 {
 public:
@@ -81,10 +126,13 @@ md::MultiplexingDispatchable::MultiplexingDispatchable()
                                                  std::system_category(),
                                                  "Failed to create epoll monitor"}));
     }
+
+    removal_counts().of(this);
 }
 
 md::MultiplexingDispatchable::~MultiplexingDispatchable() noexcept
 {
+    removal_counts().forget(this);
 }
 
 md::MultiplexingDispatchable::MultiplexingDispatchable(std::initializer_list<std::shared_ptr<Dispatchable>> dispatchees)
@@ -108,43 +156,89 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    struct ReadySource
+    {
+        std::shared_ptr<md::Dispatchable> source;
+        bool rearm;
+        epoll_event event;
+    };
+
+    std::array<epoll_event, max_sources_per_dispatch> ready_events;
+    std::array<ReadySource, max_sources_per_dispatch> ready;
+    int ready_count{0};
+    auto const& removals = removal_counts().of(this);
+    auto const removals_when_ready = removals.load();
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        ready_count = epoll_wait(epoll_fd, ready_events.data(), ready_events.size(), 0);
 
-        if (result < 0)
+        if (ready_count < 0)
         {
             BOOST_THROW_EXCEPTION((std::system_error{errno,
                                                      std::system_category(),
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        // There may be none, if some other thread stole the event we were
+        // woken for; that's ok.
+        for (int i = 0; i != ready_count; ++i)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(ready_events[i].data.ptr);
+            ready[i] = {event_source->first, event_source->second, ready_events[i]};
         }
-
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
-
-        source = event_source->first;
-        rearm_source = event_source->second;
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
-    {
-        remove_watch(source);
-    }
-    else if (rearm_source)
+    auto const still_watched = [this](std::shared_ptr<md::Dispatchable> const& source)
+        {
+            std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+            return std::any_of(dispatchee_holder.begin(), dispatchee_holder.end(),
+                [&source](std::pair<std::shared_ptr<Dispatchable>, bool> const& candidate)
+                {
+                    return candidate.first == source;
+                });
+        };
+
+    auto const rearm = [this](ReadySource& ready_source)
+        {
+            ready_source.event.events = fd_event_to_epoll(ready_source.source->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ready_source.source->watch_fd(), &ready_source.event);
+        };
+
+    for (int i = 0; i != ready_count; ++i)
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        auto& ready_source = ready[i];
+
+        // An earlier dispatch (or another thread) may have removed it
+        if (removals.load() != removals_when_ready && !still_watched(ready_source.source))
+        {
+            continue;
+        }
+
+        try
+        {
+            if (!ready_source.source->dispatch(epoll_to_fd_event(ready_source.event)))
+            {
+                remove_watch(ready_source.source);
+            }
+            else if (ready_source.rearm)
+            {
+                rearm(ready_source);
+            }
+        }
+        catch (...)
+        {
+            // Don't leave the sources we haven't got to disarmed
+            for (int j = i + 1; j != ready_count; ++j)
+            {
+                if (ready[j].rearm)
+                {
+                    rearm(ready[j]);
+                }
+            }
+            throw;
+        }
     }
 
     return true;
@@ -227,4 +321,5 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
     {
         return candidate.first->watch_fd() == fd;
     });
+    ++removal_counts().of(this);
 }
@@ -35,10 +35,58 @@
 #include "mir/events/surface_placement_event.h"
 
 #include <capnp/serialize.h>
+#include <kj/io.h>
 
 
 namespace ml = mir::logging;
 
+namespace
+{
+// Storage for events that have been freed, kept by each thread to reuse
+size_t const max_spare_events{64};
+
+struct SpareEvents
+{
+    void* storage[max_spare_events];
+    size_t count;
+    bool thread_exiting;
+};
+
+// Trivially destructible, so it can still be used while the thread exits
+thread_local SpareEvents spare_events;
+
+struct SpareEventsCleanup
+{
+    ~SpareEventsCleanup()
+    {
+        while (spare_events.count)
+            ::operator delete(spare_events.storage[--spare_events.count]);
+        spare_events.thread_exiting = true;
+    }
+};
+
+thread_local SpareEventsCleanup spare_events_cleanup;
+}
+
+void* MirEvent::operator new(std::size_t size)
+{
+    if (size == sizeof(MirEvent) && spare_events.count)
+        return spare_events.storage[--spare_events.count];
+
+    return ::operator new(size);
+}
+
+void MirEvent::operator delete(void* event, std::size_t size)
+{
+    // Using the cleanup makes sure it runs when this thread exits
+    (void)&spare_events_cleanup;
+
+    if (size == sizeof(MirEvent) && !spare_events.thread_exiting && spare_events.count != max_spare_events)
+        spare_events.storage[spare_events.count++] = event;
+    else
+        ::operator delete(event);
+}
+
 MirEvent::MirEvent(MirEvent const& e)
 {
     auto reader = e.event.asReader();
@@ -69,10 +117,14 @@ mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
 
 std::string MirEvent::serialize(MirEvent const* event)
 {
-    std::string output;
-    auto flat_event = ::capnp::messageToFlatArray(const_cast<MirEvent*>(event)->message);
+    auto& message = const_cast<MirEvent*>(event)->message;
+
+    // Written straight into the result, rather than flattened and copied
+    std::string output(::capnp::computeSerializedSizeInWords(message) * sizeof(::capnp::word), '\0');
+    kj::ArrayOutputStream stream{kj::arrayPtr(reinterpret_cast<kj::byte*>(&output[0]), output.size())};
+    ::capnp::writeMessage(stream, message);
 
-    return {reinterpret_cast<char*>(flat_event.asBytes().begin()), flat_event.asBytes().size()};
+    return output;
 }
 
 MirEventType MirEvent::type() const
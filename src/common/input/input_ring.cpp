@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/input/input_ring.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Not all of our build targets have headers this recent
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#endif
+#ifndef F_SEAL_SEAL
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+namespace mi = mir::input;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "Ring indices are shared between processes, so must be lock free");
+
+struct mi::InputRing::Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t record_size;
+    std::atomic<uint32_t> consumer_attached;
+    std::atomic<uint32_t> producer_waiting;
+    // On lines of their own, so that each side writes only to its own
+    alignas(64) std::atomic<uint64_t> write_index;
+    alignas(64) std::atomic<uint64_t> read_index;
+};
+
+namespace
+{
+uint32_t const ring_magic{0x4d495252}; // "MIRR"
+uint32_t const ring_version{1};
+
+size_t round_up(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Records start on the cache line after the header's
+size_t const records_offset{192};
+// Far beyond any real use, but small enough that a bogus header can't overflow the sums
+size_t const max_capacity{mi::InputRing::max_capacity};
+size_t const max_record_size{65536};
+
+// Without these either side could resize the file under the other's mapping
+int const required_seals{F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL};
+
+size_t stride_for(size_t record_size)
+{
+    return round_up(sizeof(uint32_t) + record_size, 8);
+}
+
+size_t checked_size(size_t capacity, size_t record_size)
+{
+    if (!capacity || capacity > max_capacity || record_size > max_record_size)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid input ring size"));
+
+    return records_offset + capacity * stride_for(record_size);
+}
+
+mir::Fd create_sealed_file(size_t size)
+{
+    auto const raw_fd = static_cast<int>(
+        syscall(SYS_memfd_create, "mir-input-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (raw_fd == -1)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create input ring memory"));
+
+    mir::Fd fd{raw_fd};
+    if (ftruncate(fd, size) == -1)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to size input ring memory"));
+
+    // The client shares this file; stop it from truncating it under our mapping
+    if (fcntl(fd, F_ADD_SEALS, required_seals) == -1)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to seal input ring memory"));
+
+    return fd;
+}
+
+void* map(int fd, size_t size)
+{
+    auto const mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to map input ring memory"));
+    return mapping;
+}
+}
+
+size_t const mi::InputRing::max_capacity;
+
+mi::InputRing::InputRing(size_t capacity, size_t record_size) :
+    shm{create_sealed_file(checked_size(capacity, record_size))},
+    wakeup{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
+    capacity_{capacity},
+    record_size_{record_size},
+    stride{stride_for(record_size)},
+    mapped_size{checked_size(capacity, record_size)},
+    next_write{0},
+    next_read{0},
+    consuming_{false},
+    header{nullptr}
+{
+    static_assert(sizeof(Header) <= records_offset, "Input ring records overlap its header");
+
+    if (wakeup == Fd::invalid)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create input ring wakeup"));
+
+    header = new (map(shm, mapped_size)) Header;
+    header->magic = ring_magic;
+    header->version = ring_version;
+    header->capacity = capacity;
+    header->record_size = record_size;
+    header->consumer_attached = 0;
+    header->producer_waiting = 0;
+    header->write_index = 0;
+    header->read_index = 0;
+}
+
+mi::InputRing::InputRing(Fd const& shm_fd, Fd const& wakeup_fd) :
+    shm{shm_fd},
+    wakeup{wakeup_fd},
+    consuming_{false},
+    header{nullptr}
+{
+    auto const seals = fcntl(shm, F_GET_SEALS);
+    if (seals == -1 || (seals & required_seals) != required_seals)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Input ring memory is not sealed against resizing"));
+
+    struct stat info;
+    if (fstat(shm, &info) == -1)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to inspect input ring memory"));
+
+    if (info.st_size < static_cast<off_t>(records_offset))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Input ring memory is too small"));
+
+    // Only the header at first: until it checks out, nothing says how big the rest is
+    auto const probe = static_cast<Header*>(map(shm, records_offset));
+    capacity_ = probe->capacity;
+    record_size_ = probe->record_size;
+    auto const valid = probe->magic == ring_magic && probe->version == ring_version &&
+        capacity_ > 0 && capacity_ <= max_capacity && record_size_ <= max_record_size;
+    munmap(probe, records_offset);
+
+    if (!valid)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Not an input ring"));
+
+    stride = stride_for(record_size_);
+    mapped_size = checked_size(capacity_, record_size_);
+
+    if (mapped_size > static_cast<size_t>(info.st_size))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Input ring memory is too small"));
+
+    header = static_cast<Header*>(map(shm, mapped_size));
+    next_write = header->write_index.load();
+    next_read = header->read_index.load();
+}
+
+mi::InputRing::~InputRing()
+{
+    munmap(header, mapped_size);
+}
+
+mir::Fd mi::InputRing::shm_fd() const
+{
+    return shm;
+}
+
+mir::Fd mi::InputRing::wakeup_fd() const
+{
+    return wakeup;
+}
+
+size_t mi::InputRing::capacity() const
+{
+    return capacity_;
+}
+
+size_t mi::InputRing::record_size() const
+{
+    return record_size_;
+}
+
+unsigned char* mi::InputRing::slot(uint64_t index) const
+{
+    return reinterpret_cast<unsigned char*>(header) + records_offset + (index % capacity_) * stride;
+}
+
+bool mi::InputRing::push(void const* record, size_t size)
+{
+    if (size > record_size_)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Record too large for input ring"));
+
+    auto const write = next_write;
+
+    // A read index ahead of what has been written wraps to look full
+    if (write - header->read_index.load(std::memory_order_acquire) >= capacity_)
+    {
+        header->producer_waiting.store(1);
+
+        // The consumer may have made room before it could see the request
+        if (write - header->read_index.load() >= capacity_)
+            return false;
+    }
+
+    auto const target = slot(write);
+    uint32_t const record_bytes = size;
+    std::memcpy(target, &record_bytes, sizeof record_bytes);
+    std::memcpy(target + sizeof record_bytes, record, size);
+
+    next_write = write + 1;
+    header->write_index.store(next_write);
+
+    // Only a consumer that found the ring empty can be asleep
+    if (header->read_index.load() == write)
+        signal_wakeup();
+
+    return true;
+}
+
+bool mi::InputRing::consumer_attached() const
+{
+    return header->consumer_attached.load(std::memory_order_acquire);
+}
+
+void mi::InputRing::attach_consumer()
+{
+    consuming_ = true;
+    header->consumer_attached.store(1, std::memory_order_release);
+}
+
+bool mi::InputRing::consuming() const
+{
+    return consuming_;
+}
+
+bool mi::InputRing::empty() const
+{
+    return header->write_index.load(std::memory_order_acquire) == next_read;
+}
+
+size_t mi::InputRing::pop(void* record, size_t max_size)
+{
+    auto const read = next_read;
+
+    if (header->write_index.load(std::memory_order_acquire) == read)
+    {
+        clear_wakeup();
+
+        // The producer may have pushed, and signalled, just before the wakeup was cleared
+        if (header->write_index.load() == read)
+            return 0;
+
+        // Stay readable for whatever follows this record
+        signal_wakeup();
+    }
+
+    auto const source = slot(read);
+    uint32_t record_bytes;
+    std::memcpy(&record_bytes, source, sizeof record_bytes);
+    auto const size = std::min<size_t>({record_bytes, record_size_, max_size});
+    std::memcpy(record, source + sizeof record_bytes, size);
+
+    next_read = read + 1;
+    header->read_index.store(next_read);
+
+    return size;
+}
+
+bool mi::InputRing::take_room_request()
+{
+    return header->producer_waiting.load() && header->producer_waiting.exchange(0);
+}
+
+void mi::InputRing::signal_wakeup()
+{
+    uint64_t const one{1};
+    if (write(wakeup, &one, sizeof one) != sizeof one && errno != EAGAIN)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to wake input ring consumer"));
+}
+
+void mi::InputRing::clear_wakeup()
+{
+    uint64_t count;
+    if (read(wakeup, &count, sizeof count) != sizeof count && errno != EAGAIN)
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to clear input ring wakeup"));
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/module_probe_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+// Where the display hardware a platform probes for shows up
+char const* const hardware_directories[] = {"/dev/dri", "/dev/graphics", "/sys/class/drm"};
+
+// FNV-1a: unlike std::hash, it is the same from one build to the next
+std::string hash_of(std::string const& text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof hex, "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+void describe_directory(std::string const& path, std::ostream& out)
+{
+    std::vector<std::string> names;
+    if (auto const dir = opendir(path.c_str()))
+    {
+        while (auto const entry = readdir(dir))
+            names.push_back(entry->d_name);
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+
+    out << path << '\n';
+    for (auto const& name : names)
+    {
+        struct stat info;
+        if (name == "." || name == ".." || stat((path + '/' + name).c_str(), &info) != 0)
+            continue;
+
+        out << name << ' ' << info.st_ino << ' ' << info.st_rdev << ' ' << info.st_size << ' '
+            << info.st_mtim.tv_sec << '.' << info.st_mtim.tv_nsec << ' '
+            << info.st_ctim.tv_sec << '.' << info.st_ctim.tv_nsec << '\n';
+    }
+}
+
+std::string fingerprint_of(std::string const& path)
+{
+    std::ostringstream description;
+    describe_directory(path, description);
+    for (auto const hardware : hardware_directories)
+        describe_directory(hardware, description);
+
+    return hash_of(description.str());
+}
+
+struct Entry
+{
+    std::string path;
+    std::string context;
+    std::string fingerprint;
+    mir::ModuleProbeCache::Choice choice;
+};
+
+std::vector<Entry> read_entries(std::string const& file)
+{
+    std::vector<Entry> entries;
+    std::ifstream in{file};
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields{line};
+        Entry entry;
+        if (std::getline(fields, entry.path, '\t') &&
+            std::getline(fields, entry.context, '\t') &&
+            std::getline(fields, entry.fingerprint, '\t') &&
+            fields >> entry.choice.priority &&
+            fields.get() == '\t' &&
+            std::getline(fields, entry.choice.module))
+        {
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+}
+
+mir::ModuleProbeCache::ModuleProbeCache(std::string const& file) :
+    file{file}
+{
+}
+
+bool mir::ModuleProbeCache::lookup(std::string const& path, std::string const& context, Choice& choice) const
+{
+    auto const context_hash = hash_of(context);
+
+    for (auto const& entry : read_entries(file))
+    {
+        if (entry.path == path && entry.context == context_hash)
+        {
+            if (entry.fingerprint != fingerprint_of(path))
+                return false;
+
+            choice = entry.choice;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void mir::ModuleProbeCache::store(std::string const& path, std::string const& context, Choice const& choice)
+{
+    auto const context_hash = hash_of(context);
+
+    auto entries = read_entries(file);
+    entries.erase(
+        std::remove_if(entries.begin(), entries.end(),
+            [&](Entry const& entry) { return entry.path == path && entry.context == context_hash; }),
+        entries.end());
+    entries.push_back({path, context_hash, fingerprint_of(path), choice});
+
+    auto const temporary = file + '.' + std::to_string(getpid());
+    {
+        std::ofstream out{temporary};
+        for (auto const& entry : entries)
+        {
+            out << entry.path << '\t' << entry.context << '\t' << entry.fingerprint << '\t'
+                << entry.choice.priority << '\t' << entry.choice.module << '\n';
+        }
+        if (!out.flush())
+        {
+            unlink(temporary.c_str());
+            return;
+        }
+    }
+
+    // Either the old cache or the new one, never a mixture
+    if (rename(temporary.c_str(), file.c_str()) != 0)
+        unlink(temporary.c_str());
+}
+
+std::string mir::ModuleProbeCache::module_containing(void const* symbol)
+{
+    Dl_info info;
+    if (dladdr(symbol, &info) && info.dli_fname)
+        return info.dli_fname;
+
+    return {};
+}
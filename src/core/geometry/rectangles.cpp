@@ -37,6 +37,45 @@ geom::Rectangle rect_from_points(geom::Point const& tl, geom::Point const& br)
     return {tl, as_size(br-tl)};
 }
 
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+void subtract_into(
+    std::vector<geom::Rectangle> const& from,
+    geom::Rectangle const& rect,
+    std::vector<geom::Rectangle>& into)
+{
+    for (auto const& r : from)
+    {
+        if (is_empty(r))
+            continue;
+
+        auto const hole = r.intersection_with(rect);
+        if (is_empty(hole))
+        {
+            into.push_back(r);
+            continue;
+        }
+
+        // Up to four pieces: full width above and below, then either side
+        geom::Rectangle const pieces[] =
+            {
+                rect_from_points(r.top_left, {r.right(), hole.top()}),
+                rect_from_points({r.left(), hole.bottom()}, r.bottom_right()),
+                rect_from_points({r.left(), hole.top()}, hole.bottom_left()),
+                rect_from_points(hole.top_right(), {r.right(), hole.bottom()})
+            };
+
+        for (auto const& piece : pieces)
+        {
+            if (!is_empty(piece))
+                into.push_back(piece);
+        }
+    }
+}
+
 }
 
 geom::Rectangles::Rectangles()
@@ -64,6 +103,45 @@ void geom::Rectangles::clear()
     rectangles.clear();
 }
 
+void geom::Rectangles::subtract(Rectangle const& rect)
+{
+    std::vector<Rectangle> remaining;
+    remaining.reserve(rectangles.size());
+
+    subtract_into(rectangles, rect, remaining);
+
+    rectangles.swap(remaining);
+}
+
+bool geom::Rectangles::covers(Rectangle const& rect) const
+{
+    if (is_empty(rect))
+        return true;
+
+    for (auto const& r : rectangles)
+    {
+        if (r.contains(rect))
+            return true;
+    }
+
+    // The compositor asks this for every window on every frame, so reuse
+    // the scratch space rather than allocating it each time
+    thread_local std::vector<Rectangle> uncovered;
+    thread_local std::vector<Rectangle> remaining;
+
+    uncovered.assign(1, rect);
+    for (auto const& r : rectangles)
+    {
+        remaining.clear();
+        subtract_into(uncovered, r, remaining);
+        uncovered.swap(remaining);
+        if (uncovered.empty())
+            return true;
+    }
+
+    return false;
+}
+
 void geom::Rectangles::confine(geom::Point& point) const
 {
     geom::Point ret_point{point};
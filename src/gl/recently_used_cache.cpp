@@ -20,6 +20,7 @@
 #include "recently_used_cache.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/gl/partial_texture_source.h"
 
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
@@ -40,11 +41,22 @@ std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const&
     if (!texture_source)
         BOOST_THROW_EXCEPTION(std::logic_error("Buffer does not support GL rendering"));
 
-    if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding))
+    auto const partial_source =
+        dynamic_cast<mrgl::PartialTextureSource*>(buffer->native_buffer_base());
+    auto const frame = partial_source ? partial_source->frame() : 0;
+
+    if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding) ||
+        (texture.frame != frame))
     {
-        texture_source->bind();
+        // Keep the texture storage and upload only what changed if we can
+        if (!texture.valid_binding || !partial_source ||
+            !partial_source->bind_changes_since(texture.frame))
+        {
+            texture_source->bind();
+        }
         texture.resource = buffer;
         texture.last_bound_buffer = buffer_id;
+        texture.frame = frame;
     }
     texture_source->secure_for_render();
 
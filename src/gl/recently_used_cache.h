@@ -25,6 +25,7 @@
 #include "mir/graphics/buffer_id.h"
 #include "mir/graphics/renderable.h"
 #include <unordered_map>
+#include <cstdint>
 
 namespace mir
 {
@@ -46,6 +47,7 @@ private:
         {}
         std::shared_ptr<Texture> texture;
         graphics::BufferID last_bound_buffer;
+        uint64_t frame{0};
         bool used{true};
         bool valid_binding{false};
         std::shared_ptr<graphics::Buffer> resource;
@@ -20,6 +20,7 @@
 #define MIR_INPUT_RECEIVER_PLATFORM_H_
 
 #include "mir_toolkit/event.h"
+#include "mir/time/posix_timestamp.h"
 
 #include <memory>
 #include <functional>
@@ -32,6 +33,8 @@ class Dispatchable;
 }
 namespace input
 {
+class InputRing;
+
 namespace receiver
 {
 class InputReceiverThread;
@@ -47,6 +50,32 @@ public:
     virtual std::shared_ptr<dispatch::Dispatchable> create_input_receiver(
         int fd, std::shared_ptr<XKBMapper> const& xkb_mapper, std::function<void(MirEvent*)> const& callback) = 0;
 
+    /// As create_input_receiver(), but delivering motion once per frame, resampled to the time next_frame gives
+    virtual std::shared_ptr<dispatch::Dispatchable> create_batching_input_receiver(
+        int fd,
+        std::shared_ptr<XKBMapper> const& xkb_mapper,
+        std::function<void(MirEvent*)> const& callback,
+        std::function<time::PosixTimestamp()> const& /*next_frame*/)
+    {
+        return create_input_receiver(fd, xkb_mapper, callback);
+    }
+
+    /**
+     * As create_batching_input_receiver() (or create_input_receiver(), given no next_frame),
+     * but also taking input through ring, for platforms that can
+     */
+    virtual std::shared_ptr<dispatch::Dispatchable> create_ring_input_receiver(
+        int fd,
+        std::shared_ptr<InputRing> const& /*ring*/,
+        std::shared_ptr<XKBMapper> const& xkb_mapper,
+        std::function<void(MirEvent*)> const& callback,
+        std::function<time::PosixTimestamp()> const& next_frame)
+    {
+        if (next_frame)
+            return create_batching_input_receiver(fd, xkb_mapper, callback, next_frame);
+        return create_input_receiver(fd, xkb_mapper, callback);
+    }
+
     static std::shared_ptr<InputPlatform> create();
     static std::shared_ptr<InputPlatform> create(std::shared_ptr<InputReceiverReport> const& report);
 
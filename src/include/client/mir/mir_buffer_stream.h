@@ -24,6 +24,7 @@
 
 #include "mir/frontend/buffer_stream_id.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 
 #include "mir_toolkit/client_types.h"
 #include "mir_toolkit/mir_native_buffer.h"
@@ -99,6 +100,7 @@ public:
     virtual bool valid() const = 0;
     virtual void set_size(mir::geometry::Size) = 0;
     virtual mir::geometry::Size size() const = 0;
+    virtual void set_damage(mir::geometry::Rectangles const& damage) = 0;
     virtual MirWaitHandle* set_scale(float) = 0;
     virtual char const* get_error_message() const = 0;
     virtual MirConnection* connection() const = 0;
@@ -25,6 +25,7 @@
 
 #include <capnp/message.h>
 
+#include <cstddef>
 #include <cstring>
 
 struct MirEvent
@@ -72,10 +73,20 @@ struct MirEvent
     static mir::EventUPtr deserialize(std::string const& bytes);
     static std::string serialize(MirEvent const* event);
 
+    // Events are made at input device rates, so their storage is recycled
+    static void* operator new(std::size_t size);
+    static void operator delete(void* event, std::size_t size);
+
 protected:
     MirEvent() = default;
 
-    ::capnp::MallocMessageBuilder message;
+private:
+    // Enough for any input event, so building one doesn't allocate
+    static std::size_t const first_segment_words = 128;
+    ::capnp::word first_segment[first_segment_words]{};
+
+protected:
+    ::capnp::MallocMessageBuilder message{kj::arrayPtr(first_segment, first_segment_words)};
     mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
 };
 
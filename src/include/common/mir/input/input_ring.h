@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_INPUT_RING_H_
+#define MIR_INPUT_INPUT_RING_H_
+
+#include "mir/fd.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace input
+{
+/**
+ * A single producer, single consumer ring of fixed size records in shared
+ * memory, for passing input from the server to a client without a system
+ * call per event.
+ *
+ * The consumer only needs waking when the ring goes from empty to not
+ * empty, so the producer signals the wakeup eventfd just then. The consumer
+ * acknowledges records by advancing the shared read index; when the ring is
+ * full the producer asks to be told once there is room again, and the
+ * consumer answers that through whatever channel the two already share.
+ *
+ * The producer takes nothing the consumer writes on trust: a read index
+ * that makes no sense leaves the ring full. The memory is a memfd sealed
+ * against resizing, and rings are only mapped from fds sealed that way, so
+ * neither side can truncate it under the other.
+ */
+class InputRing
+{
+public:
+    /// The most records a ring can hold
+    static size_t const max_capacity{65536};
+
+    /// Creates a ring with room for \a capacity records of up to \a record_size bytes
+    InputRing(size_t capacity, size_t record_size);
+    /// Maps a ring created elsewhere, given the (sealed) fds it was shared through
+    InputRing(Fd const& shm_fd, Fd const& wakeup_fd);
+    ~InputRing();
+
+    Fd shm_fd() const;
+    /// Readable while the consumer may have records to read
+    Fd wakeup_fd() const;
+
+    size_t capacity() const;
+    size_t record_size() const;
+
+    /// Copies a record in. Returns false if the ring is full.
+    bool push(void const* record, size_t size);
+    /// Whether a consumer has said it reads from the ring
+    bool consumer_attached() const;
+
+    void attach_consumer();
+    /// Whether this side attached as the consumer
+    bool consuming() const;
+    bool empty() const;
+    /**
+     * Copies the oldest record out into \a record, returning its size, or 0
+     * if there is none. The wakeup fd is cleared once the ring is found empty.
+     */
+    size_t pop(void* record, size_t max_size);
+    /// Whether the producer is waiting to hear there is room. Clears the request.
+    bool take_room_request();
+
+private:
+    struct Header;
+
+    InputRing(InputRing const&) = delete;
+    InputRing& operator=(InputRing const&) = delete;
+
+    unsigned char* slot(uint64_t index) const;
+    void signal_wakeup();
+    void clear_wakeup();
+
+    Fd const shm;
+    Fd const wakeup;
+    // Kept out of the shared memory, so that the other side can't change them
+    size_t capacity_;
+    size_t record_size_;
+    size_t stride;
+    size_t mapped_size;
+    uint64_t next_write;
+    uint64_t next_read;
+    bool consuming_;
+
+    Header* header;
+};
+}
+}
+
+#endif /* MIR_INPUT_INPUT_RING_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_MODULE_PROBE_CACHE_H_
+#define MIR_MODULE_PROBE_CACHE_H_
+
+#include <string>
+
+namespace mir
+{
+/**
+ * Remembers which module in a directory was chosen by probing, so that the
+ * next process to probe it can load just that module instead of all of them.
+ *
+ * A choice is only remembered for as long as nothing that went into it
+ * changes: not the modules in the directory (by name, inode, size, mtime or
+ * ctime), not the display hardware (the DRM and framebuffer devices), and
+ * not the caller's context (whatever else its probes depend on). Callers
+ * should still probe the remembered module, and fall back to probing all
+ * of them unless it gives the same priority as before.
+ *
+ * The cache is a small text file. It is replaced atomically, so processes
+ * starting at the same time never see it half written.
+ */
+class ModuleProbeCache
+{
+public:
+    explicit ModuleProbeCache(std::string const& file);
+
+    struct Choice
+    {
+        std::string module;
+        int priority;
+    };
+
+    /// Looks up the choice made for \a path in \a context, if it still holds
+    bool lookup(std::string const& path, std::string const& context, Choice& choice) const;
+
+    void store(std::string const& path, std::string const& context, Choice const& choice);
+
+    /// The file name of the loaded module that \a symbol is in
+    static std::string module_containing(void const* symbol);
+
+private:
+    std::string const file;
+};
+}
+
+#endif /* MIR_MODULE_PROBE_CACHE_H_ */
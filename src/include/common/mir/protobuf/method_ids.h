@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PROTOBUF_METHOD_IDS_H_
+#define MIR_PROTOBUF_METHOD_IDS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace mir
+{
+namespace protobuf
+{
+/**
+ * Numbers that stand in for DisplayServer method names on the wire.
+ *
+ * Clients may send Invocation::method_id instead of a method_name once the
+ * server has set Connection::method_ids_accepted. The values are part of
+ * the protocol: only ever append to this list (and to method_name() below).
+ */
+enum class MethodId : uint32_t
+{
+    none,
+    connect,
+    create_surface,
+    submit_buffer,
+    allocate_buffers,
+    release_buffers,
+    release_surface,
+    platform_operation,
+    configure_display,
+    remove_session_configuration,
+    set_base_display_configuration,
+    configure_surface,
+    modify_surface,
+    create_screencast,
+    screencast_buffer,
+    screencast_to_buffer,
+    release_screencast,
+    create_buffer_stream,
+    release_buffer_stream,
+    configure_cursor,
+    new_fds_for_prompt_providers,
+    start_prompt_session,
+    stop_prompt_session,
+    disconnect,
+    pong,
+    configure_buffer_stream,
+    raise_surface,
+    translate_surface_to_screen,
+    request_persistent_surface_id,
+    preview_base_display_configuration,
+    confirm_base_display_configuration,
+    cancel_base_display_configuration_preview,
+
+    count // Not a method
+};
+
+/// The name of method \a id, or "" if it isn't one
+inline std::string const& method_name(MethodId id)
+{
+    static std::string const names[] = {
+        "",
+        "connect",
+        "create_surface",
+        "submit_buffer",
+        "allocate_buffers",
+        "release_buffers",
+        "release_surface",
+        "platform_operation",
+        "configure_display",
+        "remove_session_configuration",
+        "set_base_display_configuration",
+        "configure_surface",
+        "modify_surface",
+        "create_screencast",
+        "screencast_buffer",
+        "screencast_to_buffer",
+        "release_screencast",
+        "create_buffer_stream",
+        "release_buffer_stream",
+        "configure_cursor",
+        "new_fds_for_prompt_providers",
+        "start_prompt_session",
+        "stop_prompt_session",
+        "disconnect",
+        "pong",
+        "configure_buffer_stream",
+        "raise_surface",
+        "translate_surface_to_screen",
+        "request_persistent_surface_id",
+        "preview_base_display_configuration",
+        "confirm_base_display_configuration",
+        "cancel_base_display_configuration_preview",
+    };
+    static_assert(sizeof names / sizeof names[0] == static_cast<size_t>(MethodId::count),
+                  "Every MethodId needs a name");
+
+    return id < MethodId::count ? names[static_cast<size_t>(id)] : names[0];
+}
+
+/// The id of the method called \a name, or MethodId::none if there isn't one
+inline MethodId method_id(std::string const& name)
+{
+    static auto const ids = []
+        {
+            std::unordered_map<std::string, MethodId> ids;
+            for (uint32_t i = 1; i != static_cast<uint32_t>(MethodId::count); ++i)
+                ids.emplace(method_name(static_cast<MethodId>(i)), static_cast<MethodId>(i));
+            return ids;
+        }();
+
+    auto const id = ids.find(name);
+    return id != ids.end() ? id->second : MethodId::none;
+}
+
+/// The method a wire Invocation calls, by whichever of id or name it was sent with
+template<typename Invocation>
+std::string const& method_name_of(Invocation const& invocation)
+{
+    return invocation.has_method_id() ?
+        method_name(static_cast<MethodId>(invocation.method_id())) :
+        invocation.method_name();
+}
+}
+}
+
+#endif /* MIR_PROTOBUF_METHOD_IDS_H_ */
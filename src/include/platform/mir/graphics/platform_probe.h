@@ -26,6 +26,9 @@
 
 namespace mir
 {
+class ModuleProbeCache;
+class SharedLibraryProberReport;
+
 namespace graphics
 {
 class Platform;
@@ -34,6 +37,17 @@ std::shared_ptr<SharedLibrary> module_for_device(
          std::vector<std::shared_ptr<SharedLibrary>> const& modules,
          options::ProgramOption const& options);
 
+/**
+ * Picks the module in \a path that best supports this system. If \a cache remembers which
+ * module was picked last time, and that module still probes the same, no
+ * other module is loaded.
+ */
+std::shared_ptr<SharedLibrary> module_for_device(
+         std::string const& path,
+         options::ProgramOption const& options,
+         SharedLibraryProberReport& report,
+         ModuleProbeCache& cache);
+
 }
 }
 
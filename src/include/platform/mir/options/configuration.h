@@ -51,6 +51,11 @@ extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const nbuffers_opt;
 extern char const* const composite_delay_opt;
+extern char const* const parallel_composite_opt;
+extern char const* const shm_cache_opt;
+extern char const* const frame_timeline_opt;
+extern char const* const frame_timeline_file_opt;
+extern char const* const input_ring_opt;
 extern char const* const enable_key_repeat_opt;
 
 extern char const* const name_opt;
@@ -64,6 +69,7 @@ extern char const* const lttng_opt_value;
 extern char const* const platform_graphics_lib;
 extern char const* const platform_input_lib;
 extern char const* const platform_path;
+extern char const* const platform_probe_cache;
 
 class Configuration
 {
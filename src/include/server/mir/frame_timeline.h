@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MIR_FRAME_TIMELINE_H_
+#define MIR_FRAME_TIMELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace mir
+{
+/**
+ * Records when each stage of a frame's trip through the server happened,
+ * from the client submitting a buffer to the buffer going back to it.
+ *
+ * Each thread records into a ring of its own, so recording takes no locks
+ * and only ever costs a clock read and a few stores. Only the most recent
+ * spans of each thread are kept. While disabled nothing is recorded.
+ *
+ * Spans are keyed by buffer id and by the stream or output they concern,
+ * so that one frame can be followed from stage to stage.
+ */
+class FrameTimeline
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    enum class Stage : uint32_t
+    {
+        submit_received,    ///< key: the stream
+        buffer_scheduled,   ///< key: the stream
+        compositor_acquire, ///< key: the stream
+        render,             ///< key: the output's compositor
+        post,               ///< key: the display sync group
+        buffer_returned     ///< key: none, the buffer id alone
+    };
+
+    /**
+     * Starts recording, keeping the last \a spans_per_thread spans of each
+     * thread. The size is fixed by the first call that records anything.
+     */
+    static void enable(size_t spans_per_thread);
+    static void disable();
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void record(Stage stage, void const* key, uint32_t buffer_id, TimePoint start, TimePoint end);
+
+    /// Writes what every thread has recorded as Chrome trace event JSON
+    static void dump(std::ostream& out);
+
+    /**
+     * Writes the dump to \a path. It is written to a new file next to it,
+     * readable only by the owner, then renamed over \a path, so whatever
+     * was there before (a symlink included) is replaced rather than written
+     * through.
+     * \throws std::system_error if the file cannot be written
+     */
+    static void dump(std::string const& path);
+
+    /// Records the span of its own lifetime, if the timeline is enabled when it starts
+    class Span
+    {
+    public:
+        Span(Stage stage, void const* key, uint32_t buffer_id = 0) :
+            stage{stage},
+            key{key},
+            buffer_id{buffer_id},
+            start{enabled() ? std::chrono::steady_clock::now() : TimePoint{}}
+        {
+        }
+
+        ~Span()
+        {
+            if (start != TimePoint{})
+                record(stage, key, buffer_id, start, std::chrono::steady_clock::now());
+        }
+
+        /// For when the buffer is only known by the end of the span
+        void set_buffer(uint32_t id) { buffer_id = id; }
+
+        Span(Span const&) = delete;
+        Span& operator=(Span const&) = delete;
+
+    private:
+        Stage const stage;
+        void const* const key;
+        uint32_t buffer_id;
+        TimePoint const start;
+    };
+
+private:
+    static std::atomic<bool> enabled_;
+};
+}
+
+#endif /* MIR_FRAME_TIMELINE_H_ */
@@ -22,6 +22,7 @@
 #include <google/protobuf/stubs/common.h>
 
 #include <mir/fd.h>
+#include <mir/protobuf/method_ids.h>
 #include <vector>
 
 namespace mir
@@ -44,6 +45,7 @@ public:
         invocation(invocation) {}
 
     const ::std::string& method_name() const;
+    protobuf::MethodId method_id() const;
     const ::std::string& parameters() const;
     google::protobuf::uint32 id() const;
 private:
@@ -21,6 +21,7 @@
 #define MIR_INPUT_INPUT_SCENE_H_
 
 #include "mir/input/input_channel_factory.h"
+#include "mir/geometry/point.h"
 
 #include <memory>
 
@@ -45,6 +46,8 @@ public:
     virtual ~Scene() = default;
 
     virtual void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) = 0;
+    /// The topmost of the surfaces for_each() offers whose input area contains \a point, if any
+    virtual auto input_surface_at(geometry::Point const& point) -> std::shared_ptr<input::Surface> = 0;
 
     virtual void add_observer(std::shared_ptr<scene::Observer> const& observer) = 0;
     virtual void remove_observer(std::weak_ptr<scene::Observer> const& observer) = 0;
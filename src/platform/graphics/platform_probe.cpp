@@ -19,30 +19,40 @@
 #include "mir/log.h"
 #include "mir/graphics/platform.h"
 #include "mir/graphics/platform_probe.h"
+#include "mir/module_probe_cache.h"
+#include "mir/shared_library_prober.h"
 
 #include <boost/throw_exception.hpp>
 
-std::shared_ptr<mir::SharedLibrary>
-mir::graphics::module_for_device(std::vector<std::shared_ptr<SharedLibrary>> const& modules, mir::options::ProgramOption const& options)
+namespace mg = mir::graphics;
+
+namespace
 {
-    mir::graphics::PlatformPriority best_priority_so_far = mir::graphics::unsupported;
-    std::shared_ptr<mir::SharedLibrary> best_module_so_far;
+struct ProbedModule
+{
+    std::shared_ptr<mir::SharedLibrary> module;
+    mg::PlatformPriority priority;
+    mg::PlatformProbe probe;
+};
+
+ProbedModule best_module_of(
+    std::vector<std::shared_ptr<mir::SharedLibrary>> const& modules,
+    mir::options::ProgramOption const& options)
+{
+    ProbedModule best{nullptr, mg::unsupported, nullptr};
     for (auto& module : modules)
     {
         try
         {
-            auto probe = module->load_function<PlatformProbe>(
+            auto probe = module->load_function<mg::PlatformProbe>(
                  "probe_graphics_platform",
                  MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
 
             auto module_priority = probe(options);
-            if (module_priority > best_priority_so_far)
-            {
-                best_priority_so_far = module_priority;
-                best_module_so_far = module;
-            }
+            if (module_priority > best.priority)
+                best = ProbedModule{module, module_priority, probe};
 
-            auto describe = module->load_function<DescribeModule>(
+            auto describe = module->load_function<mg::DescribeModule>(
                 "describe_graphics_module",
                 MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
             auto desc = describe();
@@ -56,9 +66,66 @@ mir::graphics::module_for_device(std::vector<std::shared_ptr<SharedLibrary>> con
         {
         }
     }
-    if (best_priority_so_far > mir::graphics::unsupported)
+    if (best.priority > mg::unsupported)
     {
-        return best_module_so_far;
+        return best;
     }
     BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to find platform for current system"}));
 }
+
+// Probes may look at options the server doesn't know, such as ones for the platform
+std::string probe_context(mir::options::ProgramOption const& options)
+{
+    std::string context;
+    for (auto const& token : options.unparsed_command_line())
+        context += token + '\n';
+    return context;
+}
+}
+
+std::shared_ptr<mir::SharedLibrary>
+mir::graphics::module_for_device(std::vector<std::shared_ptr<SharedLibrary>> const& modules, mir::options::ProgramOption const& options)
+{
+    return best_module_of(modules, options).module;
+}
+
+std::shared_ptr<mir::SharedLibrary> mir::graphics::module_for_device(
+    std::string const& path,
+    mir::options::ProgramOption const& options,
+    SharedLibraryProberReport& report,
+    ModuleProbeCache& cache)
+{
+    auto const context = probe_context(options);
+
+    ModuleProbeCache::Choice choice;
+    if (cache.lookup(path, context, choice))
+    {
+        try
+        {
+            report.loading_library(choice.module);
+            auto const module = std::make_shared<SharedLibrary>(choice.module);
+            auto probe = module->load_function<PlatformProbe>(
+                 "probe_graphics_platform",
+                 MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
+
+            // A module can probe differently for reasons no fingerprint catches
+            if (static_cast<int>(probe(options)) == choice.priority)
+                return module;
+        }
+        catch (std::runtime_error const& error)
+        {
+            report.loading_failed(choice.module, error);
+        }
+    }
+
+    auto const modules = libraries_for_path(path, report);
+    if (modules.empty())
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to find any platform plugins in: " + path}));
+
+    auto const best = best_module_of(modules, options);
+    auto const module_path = ModuleProbeCache::module_containing(reinterpret_cast<void const*>(best.probe));
+    if (!module_path.empty())
+        cache.store(path, context, {module_path, static_cast<int>(best.priority)});
+
+    return best.module;
+}
@@ -22,6 +22,7 @@
 #include "mir/default_configuration.h"
 #include "mir/abnormal_exit.h"
 #include "mir/shared_library_prober.h"
+#include "mir/module_probe_cache.h"
 #include "mir/logging/null_shared_library_prober_report.h"
 #include "mir/graphics/platform_probe.h"
 
@@ -51,6 +52,11 @@ char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::parallel_composite_opt      = "parallel-composite";
+char const* const mo::shm_cache_opt               = "shm-cache-size";
+char const* const mo::frame_timeline_opt          = "frame-timeline";
+char const* const mo::frame_timeline_file_opt     = "frame-timeline-file";
+char const* const mo::input_ring_opt              = "input-ring";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 
 char const* const mo::off_opt_value = "off";
@@ -60,6 +66,7 @@ char const* const mo::lttng_opt_value = "lttng";
 char const* const mo::platform_graphics_lib = "platform-graphics-lib";
 char const* const mo::platform_input_lib = "platform-input-lib";
 char const* const mo::platform_path = "platform-path";
+char const* const mo::platform_probe_cache = "platform-probe-cache";
 
 namespace
 {
@@ -150,6 +157,9 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Library to use for platform input support (default: input-stub.so)")
         (platform_path, po::value<std::string>()->default_value(MIR_SERVER_PLATFORM_PATH),
             "Directory to look for platform libraries (default: " MIR_SERVER_PLATFORM_PATH ")")
+        (platform_probe_cache, po::value<std::string>(),
+            "File to remember the platform library chosen from the platform path in,"
+            " so that later starts need not load the others")
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
@@ -174,11 +184,32 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "How to handle the SharedLibraryProber report. [{log,lttng,off}]")
         (shell_report_opt, po::value<std::string>()->default_value(off_opt_value),
          "How to handle the Shell report. [{log,off}]")
+        (frontend_threads_opt, po::value<int>()->default_value(1),
+            "Number of threads handling client requests. Each client's "
+            "requests are still handled in order.")
         (composite_delay_opt, po::value<int>()->default_value(0),
             "Compositor frame delay in milliseconds (how long to wait for new "
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (parallel_composite_opt, po::value<bool>()->default_value(false),
+            "Composite each output that shares a display sync group (e.g. "
+            "cloned outputs) on a thread of its own, rather than one after "
+            "the other.")
+        (shm_cache_opt, po::value<int>()->default_value(32),
+            "MiB of released software buffer memory kept per client for reuse "
+            "by its next buffers. 0 disables reuse.")
+        (frame_timeline_opt, po::value<int>()->default_value(0),
+            "Record the timeline of each frame, from buffer submission to "
+            "the buffer's return, keeping this many spans per thread. "
+            "SIGUSR2 writes it out as Chrome trace event JSON. 0 disables it.")
+        (frame_timeline_file_opt, po::value<std::string>(),
+            "Where SIGUSR2 writes the frame timeline. "
+            "[string:default=$XDG_RUNTIME_DIR/mir-frame-timeline.json]")
+        (input_ring_opt, po::value<int>()->default_value(0),
+            "Also send input to clients that can take it through a shared "
+            "memory ring of this many events per surface, rather than only "
+            "through a socket. At most 65536; 0 disables it.")
         (name_opt, po::value<std::string>(),
             "When nested, the name Mir uses when registering with the host.")
         (nested_passthrough_opt, po::value<bool>()->default_value(true),
@@ -207,6 +238,9 @@ void mo::DefaultConfiguration::add_platform_options()
         (platform_path,
          po::value<std::string>()->default_value(MIR_SERVER_PLATFORM_PATH),
         "");
+    program_options.add_options()
+        (platform_probe_cache,
+         po::value<std::string>(), "");
     mo::ProgramOption options;
     options.parse_arguments(program_options, argc, argv);
 
@@ -227,8 +261,19 @@ void mo::DefaultConfiguration::add_platform_options()
         {
             mir::logging::NullSharedLibraryProberReport null_report;
             auto const plugin_path = env_libpath ? env_libpath : options.get<std::string>(platform_path);
-            auto plugins = mir::libraries_for_path(plugin_path, null_report);
-            platform_graphics_library = mir::graphics::module_for_device(plugins, options);
+            auto const env_probe_cache = ::getenv("MIR_SERVER_PLATFORM_PROBE_CACHE");
+            if (options.is_set(platform_probe_cache) || env_probe_cache)
+            {
+                mir::ModuleProbeCache cache{
+                    options.is_set(platform_probe_cache) ?
+                        options.get<std::string>(platform_probe_cache) : env_probe_cache};
+                platform_graphics_library = mir::graphics::module_for_device(plugin_path, options, null_report, cache);
+            }
+            else
+            {
+                auto plugins = mir::libraries_for_path(plugin_path, null_report);
+                platform_graphics_library = mir::graphics::module_for_device(plugins, options);
+            }
         }
 
         auto add_platform_options = platform_graphics_library->load_function<mir::graphics::AddPlatformOptions>("add_graphics_platform_options", MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
@@ -45,7 +45,9 @@ bool error_indicates_tmpfile_not_supported(int error)
                             // that incorrectly returns EINVAL. Yay.
 }
 
-mir::Fd create_anonymous_file(size_t size)
+}
+
+mir::Fd mgc::detail::create_anonymous_file(size_t size)
 {
     auto raw_fd = open("/dev/shm", O_TMPFILE | O_RDWR | O_EXCL | O_CLOEXEC, S_IRWXU);
 
@@ -81,8 +83,6 @@ mir::Fd create_anonymous_file(size_t size)
     return fd;
 }
 
-}
-
 /*************
  * MapHandle *
  *************/
@@ -113,7 +113,7 @@ mgc::detail::MapHandle::operator void*() const
  ********************/
 
 mgc::AnonymousShmFile::AnonymousShmFile(size_t size)
-    : fd_{create_anonymous_file(size)},
+    : fd_{detail::create_anonymous_file(size)},
       mapping{fd_, size}
 {
 }
@@ -32,6 +32,9 @@ namespace common
 
 namespace detail
 {
+/// An unlinked file of \a size bytes in /dev/shm
+Fd create_anonymous_file(size_t size);
+
 class MapHandle
 {
 public:
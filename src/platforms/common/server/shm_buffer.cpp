@@ -36,6 +36,21 @@ namespace geom = mir::geometry;
 
 namespace {
 
+// Core in desktop GL and GLES 3; GLES 2 needs GL_EXT_unpack_subimage
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+
+bool supports_unpack_row_length()
+{
+#ifdef GL_VERSION_1_1
+    return true;
+#else
+    auto const extensions = reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS));
+    return extensions && strstr(extensions, "GL_EXT_unpack_subimage");
+#endif
+}
+
 bool get_gl_pixel_format(MirPixelFormat mir_format,
                          GLenum& gl_format, GLenum& gl_type)
 {
@@ -185,3 +200,83 @@ void mgc::ShmBuffer::bind()
 void mgc::ShmBuffer::secure_for_render()
 {
 }
+
+uint64_t mgc::ShmBuffer::frame() const
+{
+    std::lock_guard<decltype(damage_mutex)> lock{damage_mutex};
+    return frame_;
+}
+
+void mgc::ShmBuffer::set_damage(
+    uint64_t frame,
+    uint64_t previous_frame,
+    geom::Rectangles const& damage)
+{
+    std::lock_guard<decltype(damage_mutex)> lock{damage_mutex};
+    this->frame_ = frame;
+    this->previous_frame = previous_frame;
+    this->damage = damage;
+}
+
+bool mgc::ShmBuffer::bind_changes_since(uint64_t texture_frame)
+{
+    std::lock_guard<decltype(damage_mutex)> lock{damage_mutex};
+
+    GLenum format, type;
+    if (texture_frame == 0 || texture_frame != previous_frame ||
+        !get_gl_pixel_format(pixel_format_, format, type))
+    {
+        return false;
+    }
+
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(pixel_format_);
+    auto const stride = stride_.as_int();
+
+    // GL_UNPACK_ROW_LENGTH counts whole pixels, and without it the source
+    // rows must follow one another with no padding between them
+    if (stride % bytes_per_pixel != 0)
+        return false;
+
+    if (unpack_row_length == Support::unknown)
+        unpack_row_length = supports_unpack_row_length() ? Support::supported : Support::unsupported;
+
+    auto const row_length = unpack_row_length == Support::supported;
+    if (!row_length && stride != size_.width.as_int() * bytes_per_pixel)
+        return false;
+
+    geom::Rectangle const buffer_area{{0, 0}, size_};
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (row_length)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bytes_per_pixel);
+
+    for (auto const& rect : damage)
+    {
+        auto const area = rect.intersection_with(buffer_area);
+        if (area.size.width.as_int() <= 0 || area.size.height.as_int() <= 0)
+            continue;
+
+        auto const x = area.top_left.x.as_int();
+        auto const y = area.top_left.y.as_int();
+        auto const row = static_cast<char const*>(pixels) + y * stride;
+
+        if (row_length)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y,
+                            area.size.width.as_int(), area.size.height.as_int(),
+                            format, type, row + x * bytes_per_pixel);
+        }
+        else
+        {
+            // The rows are contiguous, so upload whole stripes of the buffer
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y,
+                            size_.width.as_int(), area.size.height.as_int(),
+                            format, type, row);
+        }
+    }
+
+    if (row_length)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    return true;
+}
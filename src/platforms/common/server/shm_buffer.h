@@ -25,9 +25,12 @@
 #include "mir/geometry/size.h"
 #include "mir_toolkit/common.h"
 #include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/gl/partial_texture_source.h"
 #include "mir_toolkit/mir_native_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 
+#include <mutex>
+
 namespace mir
 {
 namespace graphics
@@ -39,6 +42,7 @@ class ShmFile;
 
 class ShmBuffer : public BufferBasic, public NativeBufferBase,
                   public renderer::gl::TextureSource,
+                  public renderer::gl::PartialTextureSource,
                   public renderer::software::PixelSource
 {
 public:
@@ -52,6 +56,12 @@ public:
     void gl_bind_to_texture() override;
     void bind() override;
     void secure_for_render() override;
+    uint64_t frame() const override;
+    void set_damage(
+        uint64_t frame,
+        uint64_t previous_frame,
+        geometry::Rectangles const& damage) override;
+    bool bind_changes_since(uint64_t texture_frame) override;
     void write(unsigned char const* data, size_t size) override;
     void read(std::function<void(unsigned char const*)> const& do_with_pixels) override;
     NativeBufferBase* native_buffer_base() override;
@@ -75,6 +85,12 @@ private:
     MirPixelFormat const pixel_format_;
     geometry::Stride const stride_;
     void* const pixels;
+
+    std::mutex mutable damage_mutex;
+    uint64_t frame_{0};
+    uint64_t previous_frame{0};
+    geometry::Rectangles damage;
+    enum class Support { unknown, supported, unsupported } unpack_row_length{Support::unknown};
 };
 
 }
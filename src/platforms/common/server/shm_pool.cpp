@@ -0,0 +1,198 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_pool.h"
+
+#include <boost/throw_exception.hpp>
+#include <system_error>
+
+#include <algorithm>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Not all of our build targets have headers this recent
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#endif
+#ifndef F_SEAL_SEAL
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+namespace mgc = mir::graphics::common;
+
+namespace
+{
+size_t const page_size{4096};
+// Up to here size classes are whole pages; beyond, each power of two is split in four
+size_t const max_paged_class{64 * 1024};
+
+mir::Fd create_sealed_file(size_t size)
+{
+#ifdef SYS_memfd_create
+    auto const raw_fd = static_cast<int>(
+        syscall(SYS_memfd_create, "mir-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+
+    if (raw_fd == -1 && errno != ENOSYS)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create memfd"));
+    }
+
+    if (raw_fd != -1)
+    {
+        mir::Fd fd{raw_fd};
+
+        if (ftruncate(fd, size) == -1)
+        {
+            BOOST_THROW_EXCEPTION(
+                std::system_error(errno, std::system_category(), "Failed to resize memfd"));
+        }
+
+        // The client shares this file; stop it from truncating it under our mapping
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)
+        {
+            BOOST_THROW_EXCEPTION(
+                std::system_error(errno, std::system_category(), "Failed to seal memfd"));
+        }
+
+        return fd;
+    }
+#endif
+
+    return mgc::detail::create_anonymous_file(size);
+}
+}
+
+class mgc::ShmPool::PooledFile : public ShmFile
+{
+public:
+    PooledFile(std::weak_ptr<ShmPool> const& pool, Block block)
+        : pool{pool},
+          block(std::move(block))
+    {
+    }
+
+    ~PooledFile()
+    {
+        if (auto const live_pool = pool.lock())
+            live_pool->release(std::move(block));
+    }
+
+    void* base_ptr() const override
+    {
+        return *block.mapping;
+    }
+
+    int fd() const override
+    {
+        return block.fd;
+    }
+
+private:
+    std::weak_ptr<ShmPool> const pool;
+    Block block;
+};
+
+mgc::ShmPool::ShmPool(size_t max_cached_bytes)
+    : max_cached_bytes{max_cached_bytes}
+{
+}
+
+size_t mgc::ShmPool::size_class_for(size_t size)
+{
+    if (size <= max_paged_class)
+        return std::max((size + page_size - 1) / page_size, size_t{1}) * page_size;
+
+    auto power_of_two = max_paged_class;
+    while (power_of_two <= size / 2)
+        power_of_two *= 2;
+
+    auto const step = power_of_two / 4;
+    return (size + step - 1) / step * step;
+}
+
+std::unique_ptr<mgc::ShmFile> mgc::ShmPool::file_for(size_t size)
+{
+    auto const size_class = size_class_for(size);
+
+    {
+        std::lock_guard<std::mutex> lock{guard};
+
+        for (auto i = cached.begin(); i != cached.end(); ++i)
+        {
+            if (i->size == size_class)
+            {
+                auto block = std::move(*i);
+                cached.erase(i);
+                cached_size -= size_class;
+                in_use += size_class;
+                return std::make_unique<PooledFile>(shared_from_this(), std::move(block));
+            }
+        }
+    }
+
+    Block block;
+    block.fd = create_sealed_file(size_class);
+    block.size = size_class;
+    block.mapping = std::make_unique<detail::MapHandle>(block.fd, size_class);
+
+    std::lock_guard<std::mutex> lock{guard};
+    in_use += size_class;
+    return std::make_unique<PooledFile>(shared_from_this(), std::move(block));
+}
+
+void mgc::ShmPool::release(Block block)
+{
+    std::list<Block> evicted;
+
+    {
+        std::lock_guard<std::mutex> lock{guard};
+        in_use -= block.size;
+        cached_size += block.size;
+        cached.push_front(std::move(block));
+
+        while (cached_size > max_cached_bytes)
+        {
+            cached_size -= cached.back().size;
+            evicted.splice(evicted.begin(), cached, std::prev(cached.end()));
+        }
+    }
+
+    // evicted is unmapped and closed here, outside the lock
+}
+
+size_t mgc::ShmPool::bytes_in_use() const
+{
+    std::lock_guard<std::mutex> lock{guard};
+    return in_use;
+}
+
+size_t mgc::ShmPool::bytes_cached() const
+{
+    std::lock_guard<std::mutex> lock{guard};
+    return cached_size;
+}
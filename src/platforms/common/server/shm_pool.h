@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_SHM_POOL_H_
+#define MIR_GRAPHICS_COMMON_SHM_POOL_H_
+
+#include "mir/graphics/shm_pool.h"
+#include "anonymous_shm_file.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+/**
+ * Recycles the memory of released ShmFiles.
+ *
+ * Requests are rounded up to a size class so that a client resizing by a
+ * few pixels gets its old memory back. Memory comes from sealed memfds
+ * where the kernel has them, so that the client cannot shrink it from under
+ * the server.
+ */
+class ShmPool : public graphics::ShmPool, public std::enable_shared_from_this<ShmPool>
+{
+public:
+    explicit ShmPool(size_t max_cached_bytes);
+
+    /// A mapped file of at least \a size bytes, whose memory returns to the pool when it is destroyed
+    std::unique_ptr<ShmFile> file_for(size_t size);
+
+    size_t bytes_in_use() const override;
+    size_t bytes_cached() const override;
+
+    static size_t size_class_for(size_t size);
+
+    struct Block
+    {
+        Fd fd;
+        size_t size;
+        std::unique_ptr<detail::MapHandle> mapping;
+    };
+
+private:
+    class PooledFile;
+
+    void release(Block block);
+
+    size_t const max_cached_bytes;
+
+    std::mutex mutable guard;
+    std::list<Block> cached; // Most recently released first
+    size_t in_use{0};
+    size_t cached_size{0};
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_COMMON_SHM_POOL_H_ */
@@ -20,6 +20,7 @@
 #define MIR_PLATFORMS_EGLSTREAM_BUFFER_ALLOCATOR_
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/shm_pool.h"
 #include "mir/graphics/buffer_id.h"
 
 #include <memory>
@@ -32,7 +33,7 @@ namespace graphics
 namespace eglstream
 {
 
-class BufferAllocator: public graphics::GraphicBufferAllocator
+class BufferAllocator: public graphics::GraphicBufferAllocator, public graphics::ShmPoolAllocator
 {
 public:
     BufferAllocator();
@@ -44,6 +45,10 @@ public:
         geometry::Size size, uint32_t native_format, uint32_t native_flags) override;
 
     std::vector<MirPixelFormat> supported_pixel_formats() override;
+
+    std::shared_ptr<ShmPool> create_shm_pool(size_t max_cached_bytes) override;
+    std::shared_ptr<Buffer> alloc_software_buffer(
+        geometry::Size size, MirPixelFormat format, ShmPool& pool) override;
 };
 
 }
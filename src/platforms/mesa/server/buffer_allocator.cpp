@@ -22,6 +22,7 @@
 #include "buffer_texture_binder.h"
 #include "anonymous_shm_file.h"
 #include "shm_buffer.h"
+#include "shm_pool.h"
 #include "display_helpers.h"
 #include "software_buffer.h"
 #include "gbm_format_conversions.h"
@@ -199,6 +200,19 @@ auto make_texture_binder(
         return std::make_unique<NativePixmapTextureBinder>(bo, egl_extensions);
 }
 
+size_t software_buffer_size(geom::Size size, MirPixelFormat format)
+{
+    if (!mgc::ShmBuffer::supports(format))
+    {
+        BOOST_THROW_EXCEPTION(
+            std::runtime_error(
+                "Trying to create SHM buffer with unsupported pixel format"));
+    }
+
+    auto const stride = geom::Stride{MIR_BYTES_PER_PIXEL(format) * size.width.as_uint32_t()};
+    return stride.as_int() * size.height.as_int();
+}
+
 }
 
 mgm::BufferAllocator::BufferAllocator(
@@ -279,17 +293,21 @@ std::shared_ptr<mg::Buffer> mgm::BufferAllocator::alloc_buffer(
 std::shared_ptr<mg::Buffer> mgm::BufferAllocator::alloc_software_buffer(
     geom::Size size, MirPixelFormat format)
 {
-    if (!mgc::ShmBuffer::supports(format))
-    {
-        BOOST_THROW_EXCEPTION(
-            std::runtime_error(
-                "Trying to create SHM buffer with unsupported pixel format"));
-    }
+    return std::make_shared<mgm::SoftwareBuffer>(
+        std::make_unique<mgc::AnonymousShmFile>(software_buffer_size(size, format)), size, format);
+}
 
-    auto const stride = geom::Stride{MIR_BYTES_PER_PIXEL(format) * size.width.as_uint32_t()};
-    size_t const size_in_bytes = stride.as_int() * size.height.as_int();
+std::shared_ptr<mg::ShmPool> mgm::BufferAllocator::create_shm_pool(size_t max_cached_bytes)
+{
+    return std::make_shared<mgc::ShmPool>(max_cached_bytes);
+}
+
+std::shared_ptr<mg::Buffer> mgm::BufferAllocator::alloc_software_buffer(
+    geom::Size size, MirPixelFormat format, mg::ShmPool& pool)
+{
+    auto const size_in_bytes = software_buffer_size(size, format);
     return std::make_shared<mgm::SoftwareBuffer>(
-        std::make_unique<mgc::AnonymousShmFile>(size_in_bytes), size, format);
+        dynamic_cast<mgc::ShmPool&>(pool).file_for(size_in_bytes), size, format);
 }
 
 std::vector<MirPixelFormat> mgm::BufferAllocator::supported_pixel_formats()
@@ -21,6 +21,7 @@
 
 #include "platform_common.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/shm_pool.h"
 #include "mir/graphics/buffer_id.h"
 #include "mir_toolkit/mir_native_buffer.h"
 
@@ -46,7 +47,7 @@ enum class BufferImportMethod
     dma_buf
 };
 
-class BufferAllocator: public graphics::GraphicBufferAllocator
+class BufferAllocator: public graphics::GraphicBufferAllocator, public graphics::ShmPoolAllocator
 {
 public:
     BufferAllocator(gbm_device* device, BypassOption bypass_option, BufferImportMethod const buffer_import_method);
@@ -57,6 +58,10 @@ public:
     std::shared_ptr<Buffer> alloc_buffer(graphics::BufferProperties const& buffer_properties) override;
     std::vector<MirPixelFormat> supported_pixel_formats() override;
 
+    std::shared_ptr<ShmPool> create_shm_pool(size_t max_cached_bytes) override;
+    std::shared_ptr<Buffer> alloc_software_buffer(
+        geometry::Size size, MirPixelFormat format, ShmPool& pool) override;
+
 private:
     std::shared_ptr<Buffer> alloc_hardware_buffer(
         graphics::BufferProperties const& buffer_properties);
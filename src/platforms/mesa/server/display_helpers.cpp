@@ -32,6 +32,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <xf86drm.h>
+#include <EGL/eglext.h>
 #include <fcntl.h>
 
 namespace mg = mir::graphics;
@@ -317,7 +318,8 @@ mgmh::EGLHelper::EGLHelper(GLConfig const& gl_config)
       stencil_buffer_bits{gl_config.stencil_buffer_bits()},
       egl_display{EGL_NO_DISPLAY}, egl_config{0},
       egl_context{EGL_NO_CONTEXT}, egl_surface{EGL_NO_SURFACE},
-      should_terminate_egl{false}
+      should_terminate_egl{false},
+      has_buffer_age{false}
 {
 }
 
@@ -375,6 +377,9 @@ void mgmh::EGLHelper::setup(GBMHelper const& gbm, gbm_surface* surface_gbm,
     if(egl_surface == EGL_NO_SURFACE)
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL window surface"));
 
+    auto const extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+    has_buffer_age = extensions && strstr(extensions, "EGL_EXT_buffer_age");
+
     egl_context = eglCreateContext(egl_display, egl_config, shared_context, context_attr);
     if (egl_context == EGL_NO_CONTEXT)
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
@@ -403,6 +408,16 @@ bool mgmh::EGLHelper::swap_buffers()
     return (ret == EGL_TRUE);
 }
 
+unsigned int mgmh::EGLHelper::buffer_age() const
+{
+    EGLint age = 0;
+    if (!has_buffer_age ||
+        eglQuerySurface(egl_display, egl_surface, EGL_BUFFER_AGE_EXT, &age) != EGL_TRUE ||
+        age < 0)
+        return 0;
+    return age;
+}
+
 bool mgmh::EGLHelper::make_current() const
 {
     auto ret = eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
@@ -236,6 +236,11 @@ void mgm::DisplayBuffer::for_each_display_buffer(
     f(*this);
 }
 
+unsigned int mgm::DisplayBuffer::buffer_age()
+{
+    return egl.buffer_age();
+}
+
 void mgm::DisplayBuffer::swap_buffers()
 {
     if (!egl.swap_buffers())
@@ -363,6 +368,12 @@ std::chrono::milliseconds mgm::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+mg::Frame mgm::DisplayBuffer::last_frame() const
+{
+    // In clone mode the outputs flip together, so any one of them will do
+    return outputs.front()->last_frame();
+}
+
 mgm::BufferObject* mgm::DisplayBuffer::get_front_buffer_object()
 {
     auto front = gbm_surface_lock_front_buffer(surface_gbm.get());
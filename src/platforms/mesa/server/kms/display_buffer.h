@@ -66,6 +66,7 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    unsigned int buffer_age() override;
     bool overlay(RenderableList const& renderlist) override;
     void bind() override;
 
@@ -73,6 +74,7 @@ public:
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
 
     MirOrientation orientation() const override;
     MirMirrorMode mirror_mode() const override;
@@ -109,6 +109,11 @@ bool mgx::DisplayBuffer::overlay(RenderableList const& /*renderlist*/)
     return false;
 }
 
+unsigned int mgx::DisplayBuffer::buffer_age()
+{
+    return egl.buffer_age();
+}
+
 void mgx::DisplayBuffer::swap_buffers()
 {
     if (!egl.swap_buffers())
@@ -60,6 +60,7 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    unsigned int buffer_age() override;
     void bind() override;
     bool overlay(RenderableList const& renderlist) override;
     void set_orientation(MirOrientation const new_orientation);
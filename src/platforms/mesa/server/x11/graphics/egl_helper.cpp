@@ -22,6 +22,8 @@
 #include "mir/graphics/egl_error.h"
 
 #include <boost/throw_exception.hpp>
+#include <EGL/eglext.h>
+#include <cstring>
 
 namespace mg = mir::graphics;
 namespace mgx = mg::X;
@@ -32,7 +34,8 @@ mgxh::EGLHelper::EGLHelper(GLConfig const& gl_config)
       stencil_buffer_bits{gl_config.stencil_buffer_bits()},
       egl_display{EGL_NO_DISPLAY}, egl_config{0},
       egl_context{EGL_NO_CONTEXT}, egl_surface{EGL_NO_SURFACE},
-      should_terminate_egl{false}
+      should_terminate_egl{false},
+      has_buffer_age{false}
 {
 }
 
@@ -90,6 +93,9 @@ void mgxh::EGLHelper::setup(::Display* const x_dpy, Window win,
     if(egl_surface == EGL_NO_SURFACE)
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL window surface"));
 
+    auto const extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+    has_buffer_age = extensions && strstr(extensions, "EGL_EXT_buffer_age");
+
     egl_context = eglCreateContext(egl_display, egl_config, shared_context, context_attr);
     if (egl_context == EGL_NO_CONTEXT)
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
@@ -118,6 +124,16 @@ bool mgxh::EGLHelper::swap_buffers()
     return (ret == EGL_TRUE);
 }
 
+unsigned int mgxh::EGLHelper::buffer_age() const
+{
+    EGLint age = 0;
+    if (!has_buffer_age ||
+        eglQuerySurface(egl_display, egl_surface, EGL_BUFFER_AGE_EXT, &age) != EGL_TRUE ||
+        age < 0)
+        return 0;
+    return age;
+}
+
 bool mgxh::EGLHelper::make_current() const
 {
     auto ret = eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
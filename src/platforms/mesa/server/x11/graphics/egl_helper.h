@@ -53,6 +53,7 @@ public:
     bool swap_buffers();
     bool make_current() const;
     bool release_current() const;
+    unsigned int buffer_age() const;
 
     EGLContext context() { return egl_context; }
     EGLDisplay display() { return egl_display; }
@@ -70,6 +71,7 @@ private:
     EGLContext egl_context;
     EGLSurface egl_surface;
     bool should_terminate_egl;
+    bool has_buffer_age;
 };
 
 }
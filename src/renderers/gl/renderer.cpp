@@ -37,7 +37,10 @@
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 
 namespace mg = mir::graphics;
 namespace mgl = mir::gl;
@@ -77,6 +80,102 @@ float sine_for(MirOrientation orientation)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid orientation"));
     }
 }
+
+// Older buffers than this are rare, and redrawing them in full is fine
+unsigned int const max_tracked_buffer_age = 3;
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+geom::Rectangle rect_from_points(geom::Point const& tl, geom::Point const& br)
+{
+    return {tl, as_size(br - tl)};
+}
+
+geom::Rectangle bounding_rectangle_of(geom::Rectangle const& a, geom::Rectangle const& b)
+{
+    if (is_empty(a))
+        return b;
+    if (is_empty(b))
+        return a;
+    return geom::Rectangles{a, b}.bounding_rectangle();
+}
+
+bool hides_what_is_below(mg::Renderable const& renderable)
+{
+    static glm::mat4 const identity;
+    return renderable.alpha() == 1.0f && !renderable.shaped() &&
+           renderable.transformation() == identity;
+}
+
+bool is_integral(GLfloat f)
+{
+    return f == std::floor(f);
+}
+
+/*
+ * The clipping below only deals with the screen-aligned textured rectangles
+ * tessellate_renderable_into_rectangle() produces. Anything fancier is
+ * drawn in full.
+ */
+bool is_clippable_rectangle(mgl::Primitive const& p)
+{
+    if (p.type != GL_TRIANGLE_STRIP || p.nvertices != 4)
+        return false;
+
+    auto const& v = p.vertices;
+    for (auto const& vertex : v)
+    {
+        if (vertex.position[2] != 0.0f ||
+            !is_integral(vertex.position[0]) || !is_integral(vertex.position[1]))
+            return false;
+    }
+
+    return v[0].position[0] == v[1].position[0] && v[2].position[0] == v[3].position[0] &&
+           v[0].position[1] == v[2].position[1] && v[1].position[1] == v[3].position[1] &&
+           v[0].texcoord[0] == v[1].texcoord[0] && v[2].texcoord[0] == v[3].texcoord[0] &&
+           v[0].texcoord[1] == v[2].texcoord[1] && v[1].texcoord[1] == v[3].texcoord[1] &&
+           v[0].position[0] < v[2].position[0] && v[0].position[1] < v[1].position[1];
+}
+
+geom::Rectangle rectangle_of(mgl::Primitive const& p)
+{
+    auto const& v = p.vertices;
+    int const left = v[0].position[0];
+    int const top = v[0].position[1];
+    return {{left, top},
+            {static_cast<int>(v[3].position[0]) - left, static_cast<int>(v[3].position[1]) - top}};
+}
+
+mgl::Primitive part_of(mgl::Primitive const& p, geom::Rectangle const& part)
+{
+    auto const& v = p.vertices;
+    GLfloat const left = v[0].position[0];
+    GLfloat const top = v[0].position[1];
+    GLfloat const width = v[3].position[0] - left;
+    GLfloat const height = v[3].position[1] - top;
+    GLfloat const tex_left = v[0].texcoord[0];
+    GLfloat const tex_top = v[0].texcoord[1];
+    GLfloat const tex_width = v[3].texcoord[0] - tex_left;
+    GLfloat const tex_height = v[3].texcoord[1] - tex_top;
+
+    auto const tex_x = [&](GLfloat x) { return tex_left + (x - left) / width * tex_width; };
+    auto const tex_y = [&](GLfloat y) { return tex_top + (y - top) / height * tex_height; };
+
+    GLfloat const l = part.left().as_int();
+    GLfloat const r = part.right().as_int();
+    GLfloat const t = part.top().as_int();
+    GLfloat const b = part.bottom().as_int();
+
+    mgl::Primitive result = p;
+    result.vertices[0] = {{l, t, 0.0f}, {tex_x(l), tex_y(t)}};
+    result.vertices[1] = {{l, b, 0.0f}, {tex_x(l), tex_y(b)}};
+    result.vertices[2] = {{r, t, 0.0f}, {tex_x(r), tex_y(t)}};
+    result.vertices[3] = {{r, b, 0.0f}, {tex_x(r), tex_y(b)}};
+    return result;
+}
 }
 mrg::CurrentRenderTarget::CurrentRenderTarget(mg::DisplayBuffer* display_buffer)
     : render_target{
@@ -109,6 +208,11 @@ void mrg::CurrentRenderTarget::swap_buffers()
     render_target->swap_buffers();
 }
 
+unsigned int mrg::CurrentRenderTarget::buffer_age()
+{
+    return render_target->buffer_age();
+}
+
 const GLchar* const mrg::Renderer::vshader =
 {
     "attribute vec3 position;\n"
@@ -219,6 +323,7 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
     mir::log_info("GL framebuffer bits: RGBA=%d%d%d%d, depth=%d, stencil=%d",
                   rbits, gbits, bbits, abits, dbits, sbits);
 
+    glGenBuffers(1, &vertex_buffer);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     set_viewport(display_buffer.view_area());
@@ -227,6 +332,7 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+    glDeleteBuffers(1, &vertex_buffer);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
@@ -240,130 +346,445 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
     render_target.bind();
 
+    auto const area = redraw_area();
+    bool const partial = area != viewport;
+    if (partial)
+    {   // GL window coordinates have their origin at the bottom left
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(area.top_left.x.as_int() - viewport.top_left.x.as_int(),
+                  viewport.bottom().as_int() - area.bottom().as_int(),
+                  area.size.width.as_int(),
+                  area.size.height.as_int());
+    }
+
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT);
 
+    /*
+     * Pixels under opaque renderables don't need drawing. A lone renderable
+     * can't be hidden by anything so don't bother looking.
+     */
+    occluders.clear();
+    if (renderables.size() > 1)
+    {
+        for (auto const& r : renderables)
+        {
+            if (hides_what_is_below(*r))
+                occluders.add(r->screen_position());
+        }
+    }
+
     ++frameno;
+    glActiveTexture(GL_TEXTURE0);
     for (auto const& r : renderables)
+    {
+        // Only what's above a renderable can hide it
+        if (occluders.size() > 0 && hides_what_is_below(*r))
+            occluders.remove(r->screen_position());
+
         draw(*r, r->alpha() < 1.0f ? alpha_program : default_program);
+    }
+    draw_queued();
+
+    if (partial)
+        glDisable(GL_SCISSOR_TEST);
 
     texture_cache->drop_unused();
 
     render_target.swap_buffers();
 }
 
-void mrg::Renderer::draw(mg::Renderable const& renderable,
-                          Renderer::Program const& prog) const
+geom::Rectangle mrg::Renderer::redraw_area() const
 {
-    glUseProgram(prog.id);
-    if (prog.last_used_frameno != frameno)
-    {   // Avoid reloading the screen-global uniforms on every renderable
-        prog.last_used_frameno = frameno;
-        glUniform1i(prog.tex_uniform, 0);
-        glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
-                           glm::value_ptr(display_transform));
-        glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
-                           glm::value_ptr(screen_to_gl_coords));
-    }
+    damage_history.push_front(damage_set ? damage : viewport);
+    if (damage_history.size() > max_tracked_buffer_age + 1)
+        damage_history.pop_back();
+    damage_set = false;
 
-    glActiveTexture(GL_TEXTURE0);
-
-    auto const& rect = renderable.screen_position();
-    GLfloat centrex = rect.top_left.x.as_int() +
-                      rect.size.width.as_int() / 2.0f;
-    GLfloat centrey = rect.top_left.y.as_int() +
-                      rect.size.height.as_int() / 2.0f;
-    glUniform2f(prog.centre_uniform, centrex, centrey);
-
-    glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
-                       glm::value_ptr(renderable.transformation()));
+    /*
+     * The buffer we're about to draw on holds what we rendered buffer_age
+     * frames ago, so is missing the damage of the frames since (including
+     * this one). If we didn't render it, or would have to map the damage
+     * through a rotation or mirroring, then just redraw everything.
+     */
+    auto const age = render_target.buffer_age();
+    if (age == 0 || age >= damage_history.size() ||
+        orientation != mir_orientation_normal ||
+        mirror_mode != mir_mirror_mode_none)
+        return viewport;
 
-    if (prog.alpha_uniform >= 0)
-        glUniform1f(prog.alpha_uniform, renderable.alpha());
+    geom::Rectangle area;
+    for (unsigned int i = 0; i < age; ++i)
+        area = bounding_rectangle_of(area, damage_history[i]);
 
-    glEnableVertexAttribArray(prog.position_attr);
-    glEnableVertexAttribArray(prog.texcoord_attr);
+    return area.intersection_with(viewport);
+}
 
+void mrg::Renderer::draw(mg::Renderable const& renderable,
+                          Renderer::Program const& prog) const
+{
     primitives.clear();
     tessellate(primitives, renderable);
 
+    static glm::mat4 const identity;
+    auto const transform = renderable.transformation();
+    bool const untransformed = transform == identity;
+    if (occluders.size() > 0 && untransformed)
+        clip_occluded(primitives);
+
     // if we fail to load the texture, we need to carry on (part of lp:1629275)
     try
     {
-        auto surface_tex = texture_cache->load(renderable);
-
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
-        {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
+        auto const surface_tex = texture_cache->load(renderable);
+        auto const alpha = renderable.alpha();
+
+        DrawState client_state;
+        client_state.program = &prog;
+        client_state.texture = surface_tex.get();
+        client_state.tex_id = 0;
+        client_state.alpha = alpha;
+        client_state.transform = transform;
+
+        // The centre only matters to the transformation, so leave it out of
+        // the state of untransformed renderables and let them draw together
+        auto const& rect = renderable.screen_position();
+        client_state.centre[0] = untransformed ? 0.0f :
+            rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f;
+        client_state.centre[1] = untransformed ? 0.0f :
+            rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f;
 
         // These renderable method names could be better (see LP: #1236224)
         if (renderable.shaped())  // Client is RGBA:
         {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
+            GLenum const blend[] = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                                    GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
+            std::copy(std::begin(blend), std::end(blend), client_state.blend);
         }
-        else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
+        else if (alpha == 1.0f)  // RGBX and no window translucency:
         {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
+            GLenum const blend[] = {GL_ONE,  GL_ZERO,
+                                    GL_ZERO, GL_ONE};  // Avoid using src_alpha!
+            std::copy(std::begin(blend), std::end(blend), client_state.blend);
         }
         else
         {   // Client is RGBX but we also have window translucency.
             // The texture alpha channel is possibly uninitialized so we must be
             // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
-            glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
+            GLenum const blend[] = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                                    GL_ZERO, GL_ONE};
+            std::copy(std::begin(blend), std::end(blend), client_state.blend);
         }
 
+        // Some other texture from the shell (e.g. decorations) which
+        // is always RGBA (valid SRC_ALPHA).
+        DrawState shell_state = client_state;
+        shell_state.texture = nullptr;
+        GLenum const shell_blend[] = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                                      GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
+        std::copy(std::begin(shell_blend), std::end(shell_blend), shell_state.blend);
+
         for (auto const& p : primitives)
         {
-            BlendSeparate blend;
-
             if (p.tex_id == 0)   // The client surface texture
             {
-                blend = client_blend;
-                surface_tex->bind();
+                queue(client_state, p, untransformed);
             }
-            else   // Some other texture from the shell (e.g. decorations) which
-            {      // is always RGBA (valid SRC_ALPHA).
-                blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                         GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
-                glBindTexture(GL_TEXTURE_2D, p.tex_id);
+            else
+            {
+                shell_state.tex_id = p.tex_id;
+                queue(shell_state, p, untransformed);
             }
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        report_exception();
+    }
+}
 
-            glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].position);
-            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
+bool mrg::Renderer::DrawState::operator==(DrawState const& other) const
+{
+    return program == other.program &&
+           texture == other.texture &&
+           tex_id == other.tex_id &&
+           std::equal(std::begin(blend), std::end(blend), std::begin(other.blend)) &&
+           alpha == other.alpha &&
+           centre[0] == other.centre[0] &&
+           centre[1] == other.centre[1] &&
+           transform == other.transform;
+}
 
-            if (blend.dst_rgb == GL_ZERO)
-            {
-                glDisable(GL_BLEND);
-            }
-            else
+void mrg::Renderer::queue(DrawState const& state, mgl::Primitive const& p, bool untransformed) const
+{
+    GLint const first = queued_vertices.size();
+    int const n = std::min<int>(p.nvertices, mgl::Primitive::max_vertices);
+    auto const& v = p.vertices;
+
+    // Triangles of any kind go in as plain triangles, so that they can share a draw call
+    GLenum type = GL_TRIANGLES;
+    switch (p.type)
+    {
+    case GL_TRIANGLES:
+        queued_vertices.insert(queued_vertices.end(), v, v + n / 3 * 3);
+        break;
+    case GL_TRIANGLE_STRIP:
+        for (int i = 0; i + 2 < n; ++i)
+        {   // Keep the winding of every triangle the same as the first's
+            queued_vertices.push_back(v[i % 2 ? i + 1 : i]);
+            queued_vertices.push_back(v[i % 2 ? i : i + 1]);
+            queued_vertices.push_back(v[i + 2]);
+        }
+        break;
+    case GL_TRIANGLE_FAN:
+        for (int i = 1; i + 1 < n; ++i)
+        {
+            queued_vertices.push_back(v[0]);
+            queued_vertices.push_back(v[i]);
+            queued_vertices.push_back(v[i + 1]);
+        }
+        break;
+    default:
+        type = p.type;
+        queued_vertices.insert(queued_vertices.end(), v, v + n);
+        break;
+    }
+
+    GLsizei const count = queued_vertices.size() - first;
+    if (count == 0)
+        return;
+
+    // Where flat, untransformed triangles land is just their vertices' bounding box
+    bool bounded = untransformed && type == GL_TRIANGLES;
+    auto const& start = queued_vertices[first].position;
+    GLfloat left{start[0]}, top{start[1]}, right{start[0]}, bottom{start[1]};
+    for (auto i = queued_vertices.begin() + first; bounded && i != queued_vertices.end(); ++i)
+    {
+        auto const& position = i->position;
+        bounded = position[2] == 0.0f;
+        left = std::min(left, position[0]);
+        top = std::min(top, position[1]);
+        right = std::max(right, position[0]);
+        bottom = std::max(bottom, position[1]);
+    }
+
+    geom::Rectangle bounds;
+    if (bounded)
+    {
+        bounds = rect_from_points(
+            {static_cast<int>(std::floor(left)), static_cast<int>(std::floor(top))},
+            {static_cast<int>(std::ceil(right)), static_cast<int>(std::ceil(bottom))});
+    }
+
+    /*
+     * Join the most recent batch drawing with the same state, provided that
+     * doesn't mean drawing this before anything queued since which it
+     * overlaps.
+     */
+    auto batch = batches.size();
+    if (type == GL_TRIANGLES)
+    {
+        for (auto i = batches.size(); i-- != 0;)
+        {
+            auto const& candidate = batches[i];
+            if (candidate.type == GL_TRIANGLES && candidate.state == state)
             {
-                glEnable(GL_BLEND);
-                glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
-                                    blend.src_alpha, blend.dst_alpha);
+                batch = i;
+                break;
             }
 
-            glDrawArrays(p.type, 0, p.nvertices);
+            if (!bounded || !candidate.bounded || candidate.bounds.overlaps(bounds))
+                break;
         }
     }
-    catch (std::exception const& ex)
+
+    if (batch == batches.size())
     {
-        report_exception();
+        batches.push_back({state, type, 0, count, bounded, bounds});
+    }
+    else
+    {
+        auto& joined = batches[batch];
+        joined.count += count;
+        joined.bounded = joined.bounded && bounded;
+        if (joined.bounded)
+            joined.bounds = bounding_rectangle_of(joined.bounds, bounds);
+    }
+
+    draw_commands.push_back({batch, first, count});
+}
+
+void mrg::Renderer::draw_queued() const
+{
+    if (batches.empty())
+    {
+        queued_vertices.clear();
+        return;
+    }
+
+    // Lay the vertices out batch by batch, so that each is one range of the buffer
+    GLint next = 0;
+    for (auto& batch : batches)
+    {
+        batch.first = next;
+        next += batch.count;
+    }
+
+    batched_vertices.resize(next);
+    for (auto& batch : batches)
+        batch.count = 0;
+    for (auto const& command : draw_commands)
+    {
+        auto& batch = batches[command.batch];
+        std::copy(queued_vertices.begin() + command.first,
+                  queued_vertices.begin() + command.first + command.count,
+                  batched_vertices.begin() + batch.first + batch.count);
+        batch.count += command.count;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, batched_vertices.size() * sizeof(mgl::Vertex),
+                 batched_vertices.data(), GL_STREAM_DRAW);
+
+    DrawState const* current = nullptr;
+    for (auto const& batch : batches)
+    {
+        apply(batch.state, current);
+        glDrawArrays(batch.type, batch.first, batch.count);
+        current = &batch.state;
+    }
+
+    glDisableVertexAttribArray(current->program->texcoord_attr);
+    glDisableVertexAttribArray(current->program->position_attr);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    queued_vertices.clear();
+    draw_commands.clear();
+    batches.clear();
+}
+
+void mrg::Renderer::apply(DrawState const& state, DrawState const* current) const
+{
+    auto const& prog = *state.program;
+    if (!current || current->program != &prog)
+    {
+        if (current)
+        {
+            glDisableVertexAttribArray(current->program->texcoord_attr);
+            glDisableVertexAttribArray(current->program->position_attr);
+        }
+
+        glUseProgram(prog.id);
+        if (prog.last_used_frameno != frameno)
+        {   // Avoid reloading the screen-global uniforms on every renderable
+            prog.last_used_frameno = frameno;
+            glUniform1i(prog.tex_uniform, 0);
+            glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                               glm::value_ptr(display_transform));
+            glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                               glm::value_ptr(screen_to_gl_coords));
+            glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
+                               glm::value_ptr(state.transform));
+            glUniform2f(prog.centre_uniform, state.centre[0], state.centre[1]);
+            if (prog.alpha_uniform >= 0)
+                glUniform1f(prog.alpha_uniform, state.alpha);
+            prog.transform = state.transform;
+            prog.centre[0] = state.centre[0];
+            prog.centre[1] = state.centre[1];
+            prog.alpha = state.alpha;
+        }
+
+        glEnableVertexAttribArray(prog.position_attr);
+        glEnableVertexAttribArray(prog.texcoord_attr);
+        glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<GLvoid const*>(offsetof(mgl::Vertex, position)));
+        glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<GLvoid const*>(offsetof(mgl::Vertex, texcoord)));
+    }
+
+    if (prog.transform != state.transform)
+    {
+        prog.transform = state.transform;
+        glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE, glm::value_ptr(state.transform));
+    }
+
+    if (prog.centre[0] != state.centre[0] || prog.centre[1] != state.centre[1])
+    {
+        prog.centre[0] = state.centre[0];
+        prog.centre[1] = state.centre[1];
+        glUniform2f(prog.centre_uniform, state.centre[0], state.centre[1]);
+    }
+
+    if (prog.alpha_uniform >= 0 && prog.alpha != state.alpha)
+    {
+        prog.alpha = state.alpha;
+        glUniform1f(prog.alpha_uniform, state.alpha);
+    }
+
+    // Loading textures binds them, so the first batch can't trust what is bound
+    if (!current || current->texture != state.texture || current->tex_id != state.tex_id)
+    {
+        if (state.texture)
+            state.texture->bind();
+        else
+            glBindTexture(GL_TEXTURE_2D, state.tex_id);
+    }
+
+    auto const& blend = state.blend;
+    bool const blending = blend[1] != GL_ZERO;
+    bool const was_blending = current && current->blend[1] != GL_ZERO;
+    if (!blending)
+    {
+        if (!current || was_blending)
+            glDisable(GL_BLEND);
+    }
+    else
+    {
+        if (!current || !was_blending)
+            glEnable(GL_BLEND);
+
+        if (!current || !was_blending ||
+            !std::equal(std::begin(blend), std::end(blend), std::begin(current->blend)))
+            glBlendFuncSeparate(blend[0], blend[1], blend[2], blend[3]);
+
+        if (blend[1] == GL_ONE_MINUS_CONSTANT_ALPHA &&
+            (!current || current->blend[1] != GL_ONE_MINUS_CONSTANT_ALPHA || current->alpha != state.alpha))
+            glBlendColor(0.0f, 0.0f, 0.0f, state.alpha);
+    }
+}
+
+void mrg::Renderer::clip_occluded(std::vector<mgl::Primitive>& primitives) const
+{
+    visible_primitives.clear();
+
+    for (auto const& p : primitives)
+    {
+        if (!is_clippable_rectangle(p))
+        {
+            visible_primitives.push_back(p);
+            continue;
+        }
+
+        auto const whole = rectangle_of(p);
+        geom::Rectangles visible{whole};
+        for (auto const& occluder : occluders)
+        {
+            if (occluder.overlaps(whole))
+                visible.subtract(occluder);
+        }
+
+        if (visible.size() == 1 && *visible.begin() == whole)
+        {
+            visible_primitives.push_back(p);
+        }
+        else
+        {
+            for (auto const& part : visible)
+                visible_primitives.push_back(part_of(p, part));
+        }
     }
 
-    glDisableVertexAttribArray(prog.texcoord_attr);
-    glDisableVertexAttribArray(prog.position_attr);
+    primitives.swap(visible_primitives);
 }
 
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
@@ -371,6 +792,8 @@ void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
     if (rect == viewport)
         return;
 
+    damage_history.clear();
+
     /*
      * Here we provide a 3D perspective projection with a default 30 degrees
      * vertical field of view. This projection matrix is carefully designed
@@ -430,10 +853,21 @@ void mrg::Renderer::set_output_transform(MirOrientation new_orientation, MirMirr
     display_transform = glm::mat4(mirror_matrix*rotation_matrix);
     orientation = new_orientation;
     mirror_mode = new_mirror_mode;
+    damage_history.clear();
+}
+
+void mrg::Renderer::set_damage(geom::Rectangles const& rects)
+{
+    damage = geom::Rectangle{};
+    for (auto const& rect : rects)
+        damage = bounding_rectangle_of(damage, rect);
+    damage_set = true;
 }
 
 void mrg::Renderer::suspend()
 {
     texture_cache->invalidate();
+    // Frames skipped while suspended aren't in the damage history
+    damage_history.clear();
 }
 
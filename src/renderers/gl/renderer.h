@@ -23,19 +23,21 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
 #include "mir/renderer/gl/render_target.h"
 
 #include MIR_SERVER_GL_H
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace mir
 {
-namespace gl { class TextureCache; }
+namespace gl { class Texture; class TextureCache; }
 namespace graphics { class DisplayBuffer; }
 namespace renderer
 {
@@ -51,6 +53,7 @@ public:
     void ensure_current();
     void bind();
     void swap_buffers();
+    unsigned int buffer_age();
 
 private:
     renderer::gl::RenderTarget* const render_target;
@@ -65,6 +68,7 @@ public:
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(MirOrientation orientation, MirMirrorMode mode) override;
+    void set_damage(geometry::Rectangles const& damage) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
@@ -111,6 +115,12 @@ protected:
        GLint alpha_uniform = -1;
        mutable long long last_used_frameno = 0;
 
+       // What the per-renderable uniforms were last set to, so as to skip
+       // setting them again. Only valid while last_used_frameno is current.
+       mutable glm::mat4 transform;
+       mutable GLfloat centre[2] = {0.0f, 0.0f};
+       mutable GLfloat alpha = 1.0f;
+
        Program(GLuint program_id);
     };
     Program default_program, alpha_program;
@@ -119,10 +129,53 @@ protected:
     static const GLchar* const default_fshader;
     static const GLchar* const alpha_fshader;
 
+    /**
+     * Queues the renderable to be drawn with \a prog. Nothing reaches GL
+     * until the end of render(), when everything queued is drawn in as few
+     * batches as z-order allows.
+     */
     virtual void draw(graphics::Renderable const& renderable,
                       Renderer::Program const& prog) const;
 
 private:
+    // Everything that has to be the same for primitives to be drawn together
+    struct DrawState
+    {
+        Program const* program;
+        mir::gl::Texture const* texture; // The client's texture, else tex_id
+        GLuint tex_id;
+        GLenum blend[4]; // As for glBlendFuncSeparate()
+        GLfloat alpha;
+        glm::mat4 transform;
+        GLfloat centre[2];
+
+        bool operator==(DrawState const& other) const;
+    };
+
+    struct Batch
+    {
+        DrawState state;
+        GLenum type;
+        GLint first;
+        GLsizei count;
+        bool bounded; // Otherwise it might be anywhere on screen
+        geometry::Rectangle bounds;
+    };
+
+    struct DrawCommand
+    {
+        size_t batch;
+        GLint first;
+        GLsizei count;
+    };
+
+    void queue(DrawState const& state, mir::gl::Primitive const& primitive, bool untransformed) const;
+    void draw_queued() const;
+    void apply(DrawState const& state, DrawState const* current) const;
+
+    geometry::Rectangle redraw_area() const;
+    void clip_occluded(std::vector<mir::gl::Primitive>& primitives) const;
+
     std::unique_ptr<mir::gl::TextureCache> const texture_cache;
     MirOrientation orientation;
     MirMirrorMode mirror_mode;
@@ -130,6 +183,18 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+    std::vector<mir::gl::Primitive> mutable visible_primitives;
+    geometry::Rectangles mutable occluders;
+    bool mutable damage_set = false;
+    geometry::Rectangle damage;
+    std::deque<geometry::Rectangle> mutable damage_history;
+
+    // All the frame's vertices are streamed through this in one upload
+    GLuint vertex_buffer = 0;
+    std::vector<mir::gl::Vertex> mutable queued_vertices;
+    std::vector<mir::gl::Vertex> mutable batched_vertices;
+    std::vector<DrawCommand> mutable draw_commands;
+    std::vector<Batch> mutable batches;
 };
 
 }
@@ -0,0 +1,416 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/blit.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define MIR_SW_BLIT_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIR_SW_BLIT_NEON
+#endif
+
+namespace blit = mir::renderer::software::blit;
+
+namespace
+{
+/*
+ * Every implementation rounds identically to the scalar one, so which gets
+ * picked makes no difference to the output.
+ */
+enum class Mode
+{
+    over,       // premultiplied source over destination
+    over_alpha, // as over, with the source first scaled by a constant alpha
+    blend       // constant alpha blend, ignoring the source alpha
+};
+
+// Exactly round(t / 255) for t in [0, 255 * 255]
+inline uint32_t div255(uint32_t t)
+{
+    t += 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline uint32_t scale(uint32_t p, uint32_t a)
+{
+    return div255((p & 0xff) * a) |
+           div255(((p >> 8) & 0xff) * a) << 8 |
+           div255(((p >> 16) & 0xff) * a) << 16 |
+           div255((p >> 24) * a) << 24;
+}
+
+inline uint32_t add_saturated(uint32_t x, uint32_t y)
+{
+    uint32_t sum = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        auto const c = ((x >> shift) & 0xff) + ((y >> shift) & 0xff);
+        sum |= (c > 0xff ? 0xff : c) << shift;
+    }
+    return sum;
+}
+
+template<Mode mode>
+void composite_scalar(uint32_t* dst, uint32_t const* src, size_t n, uint8_t alpha)
+{
+    for (size_t i = 0; i != n; ++i)
+    {
+        if (mode == Mode::blend)
+        {
+            dst[i] = add_saturated(scale(src[i], alpha), scale(dst[i], 255 - alpha));
+        }
+        else
+        {
+            auto const s = (mode == Mode::over_alpha) ? scale(src[i], alpha) : src[i];
+            dst[i] = add_saturated(s, scale(dst[i], 255 - (s >> 24)));
+        }
+    }
+}
+
+void swap_red_blue_scalar(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    for (size_t i = 0; i != n; ++i)
+    {
+        auto const p = src[i];
+        dst[i] = (p & 0xff00ff00) | ((p >> 16) & 0xff) | ((p & 0xff) << 16);
+    }
+}
+
+#ifdef MIR_SW_BLIT_X86
+/*
+ * Pixels are widened to 16 bits per channel, so each register holds half as
+ * many pixels as it would at 8 bits.
+ */
+inline __m128i div255_sse2(__m128i t)
+{
+    t = _mm_add_epi16(t, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+inline __m128i alpha_of_sse2(__m128i p)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+}
+
+template<Mode mode>
+inline __m128i composite_wide_sse2(__m128i s, __m128i d, __m128i alpha)
+{
+    auto const max = _mm_set1_epi16(255);
+    if (mode == Mode::blend)
+    {
+        return _mm_add_epi16(div255_sse2(_mm_mullo_epi16(s, alpha)),
+                             div255_sse2(_mm_mullo_epi16(d, _mm_sub_epi16(max, alpha))));
+    }
+
+    if (mode == Mode::over_alpha)
+        s = div255_sse2(_mm_mullo_epi16(s, alpha));
+    auto const inverse = _mm_sub_epi16(max, alpha_of_sse2(s));
+    return _mm_add_epi16(s, div255_sse2(_mm_mullo_epi16(d, inverse)));
+}
+
+template<Mode mode>
+void composite_sse2(uint32_t* dst, uint32_t const* src, size_t n, uint8_t a)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const opaque = _mm_set1_epi32(0xff000000);
+    auto const alpha = _mm_set1_epi16(a);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        if (mode == Mode::over)
+        {
+            // Runs of opaque or fully transparent pixels are common
+            auto const s_alpha = _mm_and_si128(s, opaque);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(s_alpha, opaque)) == 0xffff)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+                continue;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+                continue;
+        }
+
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        auto const lo = composite_wide_sse2<mode>(
+            _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), alpha);
+        auto const hi = composite_wide_sse2<mode>(
+            _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+
+    composite_scalar<mode>(dst + i, src + i, n - i, a);
+}
+
+void swap_red_blue_sse2(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    auto const alpha_green = _mm_set1_epi32(0xff00ff00);
+    auto const low_byte = _mm_set1_epi32(0xff);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto const p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        auto const swapped = _mm_or_si128(
+            _mm_and_si128(p, alpha_green),
+            _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(p, 16), low_byte),
+                _mm_slli_epi32(_mm_and_si128(p, low_byte), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), swapped);
+    }
+
+    swap_red_blue_scalar(dst + i, src + i, n - i);
+}
+
+#define MIR_SW_AVX2 __attribute__((target("avx2")))
+
+MIR_SW_AVX2 inline __m256i div255_avx2(__m256i t)
+{
+    t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+MIR_SW_AVX2 inline __m256i alpha_of_avx2(__m256i p)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(p, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+}
+
+template<Mode mode>
+MIR_SW_AVX2 inline __m256i composite_wide_avx2(__m256i s, __m256i d, __m256i alpha)
+{
+    auto const max = _mm256_set1_epi16(255);
+    if (mode == Mode::blend)
+    {
+        return _mm256_add_epi16(div255_avx2(_mm256_mullo_epi16(s, alpha)),
+                                div255_avx2(_mm256_mullo_epi16(d, _mm256_sub_epi16(max, alpha))));
+    }
+
+    if (mode == Mode::over_alpha)
+        s = div255_avx2(_mm256_mullo_epi16(s, alpha));
+    auto const inverse = _mm256_sub_epi16(max, alpha_of_avx2(s));
+    return _mm256_add_epi16(s, div255_avx2(_mm256_mullo_epi16(d, inverse)));
+}
+
+// Unpacking and packing work within 128-bit lanes, so they undo each other
+template<Mode mode>
+MIR_SW_AVX2 void composite_avx2(uint32_t* dst, uint32_t const* src, size_t n, uint8_t a)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const opaque = _mm256_set1_epi32(0xff000000);
+    auto const alpha = _mm256_set1_epi16(a);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        if (mode == Mode::over)
+        {
+            auto const s_alpha = _mm256_and_si256(s, opaque);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s_alpha, opaque)) == -1)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+                continue;
+            }
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+                continue;
+        }
+
+        auto const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        auto const lo = composite_wide_avx2<mode>(
+            _mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), alpha);
+        auto const hi = composite_wide_avx2<mode>(
+            _mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+
+    composite_sse2<mode>(dst + i, src + i, n - i, a);
+}
+
+MIR_SW_AVX2 void swap_red_blue_avx2(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    auto const alpha_green = _mm256_set1_epi32(0xff00ff00);
+    auto const low_byte = _mm256_set1_epi32(0xff);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto const p = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        auto const swapped = _mm256_or_si256(
+            _mm256_and_si256(p, alpha_green),
+            _mm256_or_si256(
+                _mm256_and_si256(_mm256_srli_epi32(p, 16), low_byte),
+                _mm256_slli_epi32(_mm256_and_si256(p, low_byte), 16)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), swapped);
+    }
+
+    swap_red_blue_sse2(dst + i, src + i, n - i);
+}
+#endif
+
+#ifdef MIR_SW_BLIT_NEON
+inline uint8x8_t div255_neon(uint16x8_t t)
+{
+    return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+
+// NEON can split pixels into planes of channels as it loads them
+template<Mode mode>
+void composite_neon(uint32_t* dst, uint32_t const* src, size_t n, uint8_t a)
+{
+    auto const alpha = vdup_n_u8(a);
+    auto const inverse_alpha = vdup_n_u8(255 - a);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto s = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        auto d = vld4_u8(reinterpret_cast<uint8_t const*>(dst + i));
+
+        if (mode == Mode::blend)
+        {
+            for (int c = 0; c != 4; ++c)
+            {
+                d.val[c] = vqadd_u8(div255_neon(vmull_u8(s.val[c], alpha)),
+                                    div255_neon(vmull_u8(d.val[c], inverse_alpha)));
+            }
+        }
+        else
+        {
+            if (mode == Mode::over_alpha)
+            {
+                for (int c = 0; c != 4; ++c)
+                    s.val[c] = div255_neon(vmull_u8(s.val[c], alpha));
+            }
+            auto const inverse = vmvn_u8(s.val[3]);
+            for (int c = 0; c != 4; ++c)
+                d.val[c] = vqadd_u8(s.val[c], div255_neon(vmull_u8(d.val[c], inverse)));
+        }
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+
+    composite_scalar<mode>(dst + i, src + i, n - i, a);
+}
+
+void swap_red_blue_neon(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto p = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        auto const red = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = red;
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), p);
+    }
+
+    swap_red_blue_scalar(dst + i, src + i, n - i);
+}
+#endif
+
+struct Kernels
+{
+    char const* name;
+    void (*over)(uint32_t*, uint32_t const*, size_t, uint8_t);
+    void (*over_alpha)(uint32_t*, uint32_t const*, size_t, uint8_t);
+    void (*blend)(uint32_t*, uint32_t const*, size_t, uint8_t);
+    void (*swap_red_blue)(uint32_t*, uint32_t const*, size_t);
+};
+
+Kernels select_kernels()
+{
+#ifdef MIR_SW_BLIT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {"AVX2",
+                composite_avx2<Mode::over>,
+                composite_avx2<Mode::over_alpha>,
+                composite_avx2<Mode::blend>,
+                swap_red_blue_avx2};
+    }
+#endif
+#if defined(MIR_SW_BLIT_X86)
+    return {"SSE2",
+            composite_sse2<Mode::over>,
+            composite_sse2<Mode::over_alpha>,
+            composite_sse2<Mode::blend>,
+            swap_red_blue_sse2};
+#elif defined(MIR_SW_BLIT_NEON)
+    return {"NEON",
+            composite_neon<Mode::over>,
+            composite_neon<Mode::over_alpha>,
+            composite_neon<Mode::blend>,
+            swap_red_blue_neon};
+#else
+    return {"none",
+            composite_scalar<Mode::over>,
+            composite_scalar<Mode::over_alpha>,
+            composite_scalar<Mode::blend>,
+            swap_red_blue_scalar};
+#endif
+}
+
+Kernels const& kernels()
+{
+    static Kernels const selected = select_kernels();
+    return selected;
+}
+}
+
+void blit::copy(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    // libc already picks the best copy for the CPU
+    memcpy(dst, src, n * sizeof *dst);
+}
+
+void blit::over(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    kernels().over(dst, src, n, 255);
+}
+
+void blit::over(uint32_t* dst, uint32_t const* src, size_t n, uint8_t alpha)
+{
+    if (alpha == 255)
+        kernels().over(dst, src, n, alpha);
+    else if (alpha != 0)
+        kernels().over_alpha(dst, src, n, alpha);
+}
+
+void blit::blend(uint32_t* dst, uint32_t const* src, size_t n, uint8_t alpha)
+{
+    if (alpha == 255)
+        copy(dst, src, n);
+    else if (alpha != 0)
+        kernels().blend(dst, src, n, alpha);
+}
+
+void blit::swap_red_blue(uint32_t* dst, uint32_t const* src, size_t n)
+{
+    kernels().swap_red_blue(dst, src, n);
+}
+
+char const* blit::instruction_set()
+{
+    return kernels().name;
+}
@@ -0,0 +1,578 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/renderer/sw/blit.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/log.h"
+#include "mir/report_exception.h"
+
+#include <boost/throw_exception.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+namespace blit = mir::renderer::software::blit;
+
+namespace
+{
+// Older buffers than this are rare, and redrawing them in full is fine
+unsigned int const max_tracked_buffer_age = 3;
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+// Adds the parts of rect not already in region, so region stays disjoint
+void add_to_region(geom::Rectangles& region, geom::Rectangle const& rect)
+{
+    if (is_empty(rect))
+        return;
+
+    geom::Rectangles uncovered{rect};
+    for (auto const& r : region)
+        uncovered.subtract(r);
+    for (auto const& r : uncovered)
+        region.add(r);
+}
+
+bool hides_what_is_below(mg::Renderable const& renderable)
+{
+    static glm::mat4 const identity;
+    return renderable.alpha() == 1.0f && !renderable.shaped() &&
+           renderable.transformation() == identity;
+}
+
+bool is_readable(MirPixelFormat format)
+{
+    return format != mir_pixel_format_invalid &&
+           format != mir_pixel_format_bgr_888 &&
+           format < mir_pixel_formats;
+}
+
+uint32_t expand(uint32_t value, int bits)
+{
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+uint32_t argb_pixel(unsigned char const* p, MirPixelFormat format)
+{
+    uint32_t p32;
+    uint16_t p16;
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        memcpy(&p32, p, sizeof p32);
+        return p32;
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        memcpy(&p32, p, sizeof p32);
+        return (p32 & 0xff00ff00) | ((p32 >> 16) & 0xff) | ((p32 & 0xff) << 16);
+    case mir_pixel_format_rgb_888:
+        return 0xff000000 | p[0] << 16 | p[1] << 8 | p[2];
+    case mir_pixel_format_rgb_565:
+        memcpy(&p16, p, sizeof p16);
+        return 0xff000000 |
+               expand(p16 >> 11, 5) << 16 |
+               expand((p16 >> 5) & 0x3f, 6) << 8 |
+               expand(p16 & 0x1f, 5);
+    case mir_pixel_format_rgba_5551:
+        memcpy(&p16, p, sizeof p16);
+        return ((p16 & 1) ? 0xff000000 : 0) |
+               expand(p16 >> 11, 5) << 16 |
+               expand((p16 >> 6) & 0x1f, 5) << 8 |
+               expand((p16 >> 1) & 0x1f, 5);
+    case mir_pixel_format_rgba_4444:
+        memcpy(&p16, p, sizeof p16);
+        return ((p16 & 0xf) * 0x11) << 24 |
+               (p16 >> 12) * 0x11 << 16 |
+               ((p16 >> 8) & 0xf) * 0x11 << 8 |
+               ((p16 >> 4) & 0xf) * 0x11;
+    default:
+        return 0;
+    }
+}
+
+// A row of n pixels as ARGB, converted into scratch if need be
+uint32_t const* argb_row(
+    unsigned char const* row, size_t n, MirPixelFormat format, uint32_t* scratch)
+{
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        return reinterpret_cast<uint32_t const*>(row);
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        blit::swap_red_blue(scratch, reinterpret_cast<uint32_t const*>(row), n);
+        return scratch;
+    default:
+        auto const bpp = MIR_BYTES_PER_PIXEL(format);
+        for (size_t i = 0; i != n; ++i)
+            scratch[i] = argb_pixel(row + i * bpp, format);
+        return scratch;
+    }
+}
+
+// Blends the same way the GL renderer does
+struct Blend
+{
+    bool shaped;
+    uint8_t alpha;
+
+    void operator()(uint32_t* dst, uint32_t const* src, size_t n) const
+    {
+        if (!shaped)
+            blit::blend(dst, src, n, alpha);
+        else if (alpha == 255)
+            blit::over(dst, src, n);
+        else
+            blit::over(dst, src, n, alpha);
+    }
+};
+
+/*
+ * Where a renderable's buffer lands on screen: stretched over its
+ * screen_position, then transformed about the centre of it. Only the 2D
+ * affine part of the transformation is honoured.
+ */
+struct Placement
+{
+    Placement(mg::Renderable const& renderable, geom::Size const& buffer_size)
+    {
+        static glm::mat4 const identity;
+        auto const rect = renderable.screen_position();
+        auto const t = renderable.transformation();
+
+        float const left = rect.left().as_int();
+        float const top = rect.top().as_int();
+        float const width = rect.size.width.as_int();
+        float const height = rect.size.height.as_int();
+
+        one_to_one = t == identity && rect.size == buffer_size;
+        if (one_to_one || is_empty(rect))
+        {
+            visible = !is_empty(rect);
+            bounds = rect;
+            return;
+        }
+
+        // glm matrices are indexed [column][row]
+        float const a = t[0][0], b = t[1][0], c = t[0][1], d = t[1][1];
+        float const det = a * d - b * c;
+        visible = std::abs(det) > 1e-6f;
+        if (!visible)
+            return;
+
+        float const cx = left + width / 2.0f;
+        float const cy = top + height / 2.0f;
+        float const tx = t[3][0];
+        float const ty = t[3][1];
+
+        float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+        struct { float x, y; } const corners[] =
+            {{left, top}, {left + width, top}, {left, top + height}, {left + width, top + height}};
+        for (auto const& corner : corners)
+        {
+            float const x = a * (corner.x - cx) + b * (corner.y - cy) + tx + cx;
+            float const y = c * (corner.x - cx) + d * (corner.y - cy) + ty + cy;
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+        }
+        bounds = {{static_cast<int>(std::floor(min_x)), static_cast<int>(std::floor(min_y))},
+                  {static_cast<int>(std::ceil(max_x) - std::floor(min_x)),
+                   static_cast<int>(std::ceil(max_y) - std::floor(min_y))}};
+
+        // Screen to buffer coordinates: undo the transformation, then the stretch
+        float const sx = buffer_size.width.as_int() / width;
+        float const sy = buffer_size.height.as_int() / height;
+        float const ia = d / det, ib = -b / det, ic = -c / det, id = a / det;
+
+        u_x = sx * ia;
+        u_y = sx * ib;
+        u_0 = sx * (cx - left - ia * (cx + tx) - ib * (cy + ty));
+        v_x = sy * ic;
+        v_y = sy * id;
+        v_0 = sy * (cy - top - ic * (cx + tx) - id * (cy + ty));
+    }
+
+    bool visible;
+    bool one_to_one;
+    geom::Rectangle bounds;
+    float u_x = 0, u_y = 0, u_0 = 0;
+    float v_x = 0, v_y = 0, v_0 = 0;
+};
+
+unsigned char* pixel_at(mrs::Renderer::Canvas const& canvas, int x, int y)
+{
+    return canvas.pixels +
+           (y - canvas.area.top().as_int()) * canvas.stride.as_int() +
+           (x - canvas.area.left().as_int()) * sizeof(uint32_t);
+}
+
+void draw(mg::Renderable const& renderable,
+          mg::Buffer const& buffer,
+          mrs::PixelSource& source,
+          Placement const& placement,
+          geom::Rectangles const& parts,
+          mrs::Renderer::Canvas const& canvas,
+          std::vector<uint32_t>& row)
+{
+    auto const format = buffer.pixel_format();
+    auto const bpp = MIR_BYTES_PER_PIXEL(format);
+    auto const size = buffer.size();
+    int const width = size.width.as_int();
+    int const height = size.height.as_int();
+    auto const rect = renderable.screen_position();
+    Blend const blend{renderable.shaped(),
+                      static_cast<uint8_t>(std::lround(std::min(renderable.alpha(), 1.0f) * 255))};
+
+    source.read([&](unsigned char const* pixels)
+    {
+        int const stride = source.stride().as_int();
+
+        for (auto const& part : parts)
+        {
+            int const part_left = part.left().as_int();
+            int const part_width = part.size.width.as_int();
+            if (row.size() < static_cast<size_t>(part_width))
+                row.resize(part_width);
+
+            for (int y = part.top().as_int(); y != part.bottom().as_int(); ++y)
+            {
+                auto const dst = reinterpret_cast<uint32_t*>(pixel_at(canvas, part_left, y));
+
+                if (placement.one_to_one)
+                {
+                    auto const src_row = pixels +
+                        (y - rect.top().as_int()) * stride +
+                        (part_left - rect.left().as_int()) * bpp;
+                    blend(dst, argb_row(src_row, part_width, format, row.data()), part_width);
+                    continue;
+                }
+
+                // Nearest neighbour, blending each run of pixels the buffer covers
+                float const py = y + 0.5f;
+                int run_start = -1;
+                for (int i = 0; i <= part_width; ++i)
+                {
+                    bool inside = false;
+                    if (i != part_width)
+                    {
+                        float const px = part_left + i + 0.5f;
+                        float const u = placement.u_x * px + placement.u_y * py + placement.u_0;
+                        float const v = placement.v_x * px + placement.v_y * py + placement.v_0;
+                        if (u >= 0.0f && v >= 0.0f && u < width && v < height)
+                        {
+                            row[i] = argb_pixel(
+                                pixels + static_cast<int>(v) * stride + static_cast<int>(u) * bpp,
+                                format);
+                            inside = true;
+                        }
+                    }
+
+                    if (inside && run_start < 0)
+                    {
+                        run_start = i;
+                    }
+                    else if (!inside && run_start >= 0)
+                    {
+                        blend(dst + run_start, row.data() + run_start, i - run_start);
+                        run_start = -1;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void clear(geom::Rectangles const& region, mrs::Renderer::Canvas const& canvas)
+{
+    for (auto const& r : region)
+    {
+        auto const bytes = r.size.width.as_int() * sizeof(uint32_t);
+        for (int y = r.top().as_int(); y != r.bottom().as_int(); ++y)
+            memset(pixel_at(canvas, r.left().as_int(), y), 0, bytes);
+    }
+}
+}
+
+mrs::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())},
+      orientation(mir_orientation_normal),
+      mirror_mode(mir_mirror_mode_none)
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+
+    mir::log_info("Software renderer blitting with %s", blit::instruction_set());
+
+    set_viewport(display_buffer.view_area());
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    auto const framebuffer = render_target->map_framebuffer();
+    if (framebuffer.format != mir_pixel_format_argb_8888 &&
+        framebuffer.format != mir_pixel_format_xrgb_8888)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Unsupported framebuffer format for software rendering"));
+
+    damage_history.push_front(damage_set ? damage : geom::Rectangles{viewport});
+    if (damage_history.size() > max_tracked_buffer_age + 1)
+        damage_history.pop_back();
+    damage_set = false;
+
+    if (orientation == mir_orientation_normal && mirror_mode == mir_mirror_mode_none)
+    {
+        Canvas const canvas{framebuffer.pixels, framebuffer.stride,
+                            {viewport.top_left, framebuffer.size}};
+        compose(renderables, redraw_region(render_target->buffer_age()), canvas);
+    }
+    else
+    {
+        /*
+         * Compose unrotated into a frame of our own, which we can keep up to
+         * date with just this frame's damage, then copy out what the
+         * framebuffer is missing.
+         */
+        auto const width = viewport.size.width.as_int();
+        auto const height = viewport.size.height.as_int();
+        if (!logical_frame_valid)
+            logical_frame.assign(width * height, 0);
+
+        Canvas const canvas{reinterpret_cast<unsigned char*>(logical_frame.data()),
+                            geom::Stride{width * sizeof(uint32_t)},
+                            viewport};
+        compose(renderables, redraw_region(logical_frame_valid ? 1 : 0), canvas);
+        logical_frame_valid = true;
+
+        copy_transformed(redraw_region(render_target->buffer_age()), framebuffer);
+    }
+
+    render_target->swap_buffers();
+}
+
+geom::Rectangles mrs::Renderer::redraw_region(unsigned int buffer_age) const
+{
+    /*
+     * The buffer we're about to draw on holds what we rendered buffer_age
+     * frames ago, so is missing the damage of the frames since (including
+     * this one). If we didn't render it then just redraw everything.
+     */
+    if (buffer_age == 0 || buffer_age >= damage_history.size())
+        return {viewport};
+
+    geom::Rectangles region;
+    for (unsigned int i = 0; i < buffer_age; ++i)
+    {
+        for (auto const& rect : damage_history[i])
+            add_to_region(region, rect.intersection_with(viewport));
+    }
+    return region;
+}
+
+void mrs::Renderer::compose(
+    mg::RenderableList const& renderables,
+    geom::Rectangles const& region,
+    Canvas const& canvas) const
+{
+    struct Layer
+    {
+        mg::Renderable const& renderable;
+        std::shared_ptr<mg::Buffer> const buffer;
+        PixelSource* const source;
+        Placement const placement;
+        geom::Rectangles parts;
+    };
+    std::vector<Layer> layers;
+
+    geom::Rectangles area;
+    for (auto const& r : region)
+    {
+        auto const clipped = r.intersection_with(canvas.area);
+        if (!is_empty(clipped))
+            area.add(clipped);
+    }
+
+    // Work down from the top, so nothing is drawn where it would be hidden
+    geom::Rectangles covered;
+    for (auto r = renderables.rbegin(); r != renderables.rend(); ++r)
+    {
+        auto const& renderable = **r;
+        auto const buffer = renderable.buffer();
+        auto const source = buffer ? dynamic_cast<PixelSource*>(buffer->native_buffer_base()) : nullptr;
+        if (!source || !is_readable(buffer->pixel_format()) || renderable.alpha() <= 0.0f)
+            continue;
+
+        Placement const placement{renderable, buffer->size()};
+        if (!placement.visible)
+            continue;
+
+        geom::Rectangles parts;
+        for (auto const& a : area)
+        {
+            auto const part = a.intersection_with(placement.bounds);
+            if (!is_empty(part))
+                parts.add(part);
+        }
+        for (auto const& c : covered)
+            parts.subtract(c);
+
+        if (hides_what_is_below(renderable))
+            covered.add(renderable.screen_position());
+
+        if (parts.size() > 0)
+            layers.push_back({renderable, buffer, source, placement, parts});
+    }
+
+    for (auto const& c : covered)
+        area.subtract(c);
+    clear(area, canvas);
+
+    for (auto l = layers.rbegin(); l != layers.rend(); ++l)
+    {
+        // If we fail to read a buffer we need to carry on (as the GL renderer does)
+        try
+        {
+            draw(l->renderable, *l->buffer, *l->source, l->placement, l->parts, canvas, row);
+        }
+        catch (std::exception const& ex)
+        {
+            report_exception();
+        }
+    }
+}
+
+void mrs::Renderer::copy_transformed(
+    geom::Rectangles const& region,
+    MappedFramebuffer const& framebuffer) const
+{
+    int const width = viewport.size.width.as_int();
+    int const height = viewport.size.height.as_int();
+    bool const sideways = orientation == mir_orientation_left || orientation == mir_orientation_right;
+    int const fb_width = sideways ? height : width;
+    int const fb_height = sideways ? width : height;
+
+    if (framebuffer.size.width.as_int() < fb_width || framebuffer.size.height.as_int() < fb_height)
+        BOOST_THROW_EXCEPTION(std::logic_error("Framebuffer is smaller than the transformed viewport"));
+
+    /*
+     * Logical pixel (x, y) goes to framebuffer pixel
+     *   (x0 + x * x_x + y * x_y, y0 + x * y_x + y * y_y)
+     * with the mirroring applied after the rotation.
+     */
+    int x0 = 0, x_x = 1, x_y = 0;
+    int y0 = 0, y_x = 0, y_y = 1;
+    switch (orientation)
+    {
+    case mir_orientation_left:
+        x0 = 0;          x_x = 0;  x_y = 1;
+        y0 = width - 1;  y_x = -1; y_y = 0;
+        break;
+    case mir_orientation_inverted:
+        x0 = width - 1;  x_x = -1; x_y = 0;
+        y0 = height - 1; y_x = 0;  y_y = -1;
+        break;
+    case mir_orientation_right:
+        x0 = height - 1; x_x = 0;  x_y = -1;
+        y0 = 0;          y_x = 1;  y_y = 0;
+        break;
+    default:
+        break;
+    }
+
+    if (mirror_mode == mir_mirror_mode_horizontal)
+    {
+        x0 = fb_width - 1 - x0; x_x = -x_x; x_y = -x_y;
+    }
+    else if (mirror_mode == mir_mirror_mode_vertical)
+    {
+        y0 = fb_height - 1 - y0; y_x = -y_x; y_y = -y_y;
+    }
+
+    ptrdiff_t const stride = framebuffer.stride.as_int();
+    ptrdiff_t const step = x_x * static_cast<ptrdiff_t>(sizeof(uint32_t)) + y_x * stride;
+
+    for (auto const& screen_rect : region)
+    {
+        int const left = screen_rect.left().as_int() - viewport.left().as_int();
+        int const top = screen_rect.top().as_int() - viewport.top().as_int();
+        int const n = screen_rect.size.width.as_int();
+
+        for (int y = top; y != top + screen_rect.size.height.as_int(); ++y)
+        {
+            auto const src = logical_frame.data() + y * width + left;
+            auto dst = framebuffer.pixels +
+                       (y0 + left * y_x + y * y_y) * stride +
+                       (x0 + left * x_x + y * x_y) * static_cast<ptrdiff_t>(sizeof(uint32_t));
+
+            if (step == sizeof(uint32_t))
+            {
+                memcpy(dst, src, n * sizeof(uint32_t));
+                continue;
+            }
+
+            for (int i = 0; i != n; ++i, dst += step)
+                memcpy(dst, src + i, sizeof(uint32_t));
+        }
+    }
+}
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+    damage_history.clear();
+    logical_frame_valid = false;
+}
+
+void mrs::Renderer::set_output_transform(MirOrientation new_orientation, MirMirrorMode new_mirror_mode)
+{
+    if (new_orientation == orientation && new_mirror_mode == mirror_mode)
+        return;
+
+    orientation = new_orientation;
+    mirror_mode = new_mirror_mode;
+    damage_history.clear();
+    logical_frame_valid = false;
+}
+
+void mrs::Renderer::set_damage(geom::Rectangles const& rects)
+{
+    damage = rects;
+    damage_set = true;
+}
+
+void mrs::Renderer::suspend()
+{
+    // Frames skipped while suspended aren't in the damage history
+    damage_history.clear();
+    logical_frame_valid = false;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDERER_H_
+#define MIR_RENDERER_SW_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/graphics/renderable.h>
+#include "mir/renderer/sw/render_target.h"
+
+#include <deque>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * Composites with the CPU into framebuffers the display buffer maps into
+ * memory, for hardware without a usable GPU. Only buffers that are also
+ * PixelSources (e.g. shm buffers) can be drawn; others are skipped.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(MirOrientation orientation, MirMirrorMode mode) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+    /// A 32-bit image being drawn on, covering \a area of the screen
+    struct Canvas
+    {
+        unsigned char* pixels;
+        geometry::Stride stride;
+        geometry::Rectangle area;
+    };
+
+private:
+    geometry::Rectangles redraw_region(unsigned int buffer_age) const;
+    void compose(graphics::RenderableList const& renderables,
+                 geometry::Rectangles const& region,
+                 Canvas const& canvas) const;
+    void copy_transformed(geometry::Rectangles const& region,
+                          MappedFramebuffer const& framebuffer) const;
+
+    RenderTarget* const render_target;
+    MirOrientation orientation;
+    MirMirrorMode mirror_mode;
+    geometry::Rectangle viewport;
+    bool mutable damage_set = false;
+    geometry::Rectangles damage;
+    std::deque<geometry::Rectangles> mutable damage_history;
+
+    // The unrotated frame, when the output is rotated or mirrored
+    std::vector<uint32_t> mutable logical_frame;
+    bool mutable logical_frame_valid = false;
+    std::vector<uint32_t> mutable row;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDERER_H_
@@ -19,6 +19,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/frontend/buffer_sink.h"
 #include "buffer_map.h"
+#include "mir/frame_timeline.h"
 #include <boost/throw_exception.hpp>
 #include <algorithm>
 
@@ -75,6 +76,7 @@ void mc::BufferMap::send_buffer(mg::BufferID id)
     auto it = buffers.find(id);
     if (it != buffers.end())
     {
+        FrameTimeline::Span const span{FrameTimeline::Stage::buffer_returned, nullptr, id.as_value()};
         auto buffer = it->second.buffer;
         it->second.owner = Owner::client;
         lk.unlock();
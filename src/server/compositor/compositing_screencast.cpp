@@ -28,13 +28,20 @@
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/geometry/rectangles.h"
+#include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/raii.h"
+#include "mir/thread_name.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 namespace mg = mir::graphics;
+namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
 namespace
@@ -65,6 +72,17 @@ std::unique_ptr<mg::VirtualOutput> make_virtual_output(mg::Display& display, geo
 }
 }
 
+/*
+ * Composites on its own thread, so that screencasting doesn't hold up the
+ * IPC thread a frame at a time. Frames are composited at the rate the client
+ * captures them, and only once something in the captured region has changed.
+ * At most one frame waits to be captured: a fresher frame replaces it rather
+ * than waiting for a client that has fallen behind.
+ *
+ * The display buffer and its compositor are created, used and destroyed only
+ * on that thread, so the screencast's GL context is never current anywhere
+ * else. Compositing into a client's own buffer is handed to the thread too.
+ */
 class mc::detail::ScreencastSessionContext
 {
 public:
@@ -79,9 +97,14 @@ public:
         int nbuffers,
         MirMirrorMode mirror_mode)
     : scene{scene},
-      display_buffer{std::make_unique<ScreencastDisplayBuffer>(capture_region, capture_size, mirror_mode, free_queue, ready_queue, display)},
-      display_buffer_compositor{db_compositor_factory.create_compositor_for(*display_buffer)},
-      virtual_output{make_virtual_output(display, capture_region)}
+      virtual_output{make_virtual_output(display, capture_region)},
+      observer{std::make_shared<ms::LegacySceneChangeNotification>(
+          [this] { scene_damaged(); },
+          [this, capture_region](int, geom::Rectangle const& damage)
+          {
+              if (damage.overlaps(capture_region))
+                  scene_damaged();
+          })}
     {
         mg::BufferProperties const buffer_properties{capture_size, pixel_format, mg::BufferUsage::hardware};
         for (int i = 0; i < nbuffers; i++)
@@ -90,49 +113,277 @@ public:
         scene->register_compositor(this);
         if (virtual_output)
             virtual_output->enable();
+
+        scene->add_observer(observer);
+        thread = std::thread{
+            [this, &display, &db_compositor_factory, capture_region, capture_size, mirror_mode]
+            {
+                run(display, db_compositor_factory, capture_region, capture_size, mirror_mode);
+            }};
+
+        // Anything that stops the thread setting up is the session's creation failing
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        changed.wait(lock, [this] { return started || error; });
+        if (error)
+        {
+            lock.unlock();
+            stop();
+            std::rethrow_exception(error);
+        }
     }
     ~ScreencastSessionContext()
     {
-        scene->unregister_compositor(this);
+        stop();
     }
 
     std::shared_ptr<mg::Buffer> capture()
     {
-        std::lock_guard<decltype(mutex)> lk(mutex);
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        pace_to_capture(Clock::now());
+
+        // Nothing has changed since the client's last frame, so that is still current
+        if (!latest_frame && !damaged && last_captured_buffer)
+            return last_captured_buffer;
+
         //FIXME:: the client needs a better way to express it is no longer
         //using the last captured buffer
         if (last_captured_buffer)
+        {
             free_queue.schedule(last_captured_buffer);
+            last_captured_buffer.reset();
+        }
+
+        if (!latest_frame)
+        {
+            if (!free_queue.num_scheduled())
+                BOOST_THROW_EXCEPTION(std::logic_error("no buffer scheduled"));
 
-        display_buffer_compositor->composite(scene->scene_elements_for(this));
+            // The client is ahead of us: it has to wait for its frame after all
+            if (!frame_in_progress)
+            {
+                damaged = true;
+                next_composite = {};
+                changed.notify_all();
+            }
+            changed.wait(lock, [this] { return latest_frame || error; });
+        }
 
-        last_captured_buffer = ready_queue.next_buffer();
+        if (error)
+            std::rethrow_exception(error);
+
+        last_captured_buffer = std::move(latest_frame);
+        changed.notify_all();
         return last_captured_buffer;
     }
 
     void capture(std::shared_ptr<mg::Buffer> const& buffer)
     {
-        std::lock_guard<decltype(mutex)> lk(mutex);
-        auto scheduled = free_queue.num_scheduled();
-        free_queue.schedule(buffer);
-        for(auto i = 0u; i < scheduled; i++)
-            free_queue.schedule(free_queue.next_buffer());
-
-        display_buffer_compositor->composite(scene->scene_elements_for(this));
-        if (buffer != ready_queue.next_buffer())
-            throw std::runtime_error("unable to capture to buffer");
+        std::function<void()> const composite_into_buffer{
+            [this, &buffer]
+            {
+                // Keeps our own frames from being composited into the client's buffer
+                std::lock_guard<decltype(mutex)> lock{mutex};
+                auto scheduled = free_queue.num_scheduled();
+                free_queue.schedule(buffer);
+                for(auto i = 0u; i < scheduled; i++)
+                    free_queue.schedule(free_queue.next_buffer());
+
+                display_buffer_compositor->composite(scene->scene_elements_for(this));
+                if (buffer != ready_queue.next_buffer())
+                    throw std::runtime_error("unable to capture to buffer");
+            }};
+
+        run_on_session_thread(composite_into_buffer);
     }
 
 private:
-    std::mutex mutex;
+    typedef std::chrono::steady_clock Clock;
+
+    void stop()
+    {
+        scene->remove_observer(observer);
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            running = false;
+        }
+        changed.notify_all();
+        thread.join();
+        scene->unregister_compositor(this);
+    }
+
+    /// Runs \a work on the session thread, rethrowing anything it throws
+    void run_on_session_thread(std::function<void()> const& work)
+    {
+        // One caller at a time has work waiting for the thread
+        std::lock_guard<decltype(posting)> posting_lock{posting};
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        if (error)
+            std::rethrow_exception(error);
+
+        task = &work;
+        changed.notify_all();
+        changed.wait(lock, [this] { return !task || error; });
+
+        if (task)
+        {
+            // The thread died before it got to the work
+            task = nullptr;
+            std::rethrow_exception(error);
+        }
+
+        if (auto const thrown = task_error)
+        {
+            task_error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+    }
+
+    void scene_damaged()
+    {
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            damaged = true;
+        }
+        changed.notify_all();
+    }
+
+    void pace_to_capture(Clock::time_point now)
+    {
+        if (last_capture != Clock::time_point{})
+        {
+            auto const gap = now - last_capture;
+            capture_interval = capture_interval.count() ? (3 * capture_interval + gap) / 4 : gap;
+        }
+        last_capture = now;
+
+        // Aim to have the next frame composited just as the client comes for it
+        if (capture_interval.count())
+            next_composite = now + capture_interval - std::min(composite_time, capture_interval);
+    }
+
+    void run(
+        mg::Display& display,
+        DisplayBufferCompositorFactory& db_compositor_factory,
+        geom::Rectangle const& capture_region,
+        geom::Size const& capture_size,
+        MirMirrorMode mirror_mode)
+    try
+    {
+        mir::set_thread_name("Mir/Screencast");
+
+        display_buffer = std::make_unique<ScreencastDisplayBuffer>(
+            capture_region, capture_size, mirror_mode, free_queue, ready_queue, display);
+        display_buffer_compositor = db_compositor_factory.create_compositor_for(*display_buffer);
+
+        auto const teardown = mir::raii::paired_calls(
+            [this]
+            {
+                std::lock_guard<decltype(mutex)> lock{mutex};
+                started = true;
+                changed.notify_all();
+            },
+            [this]
+            {
+                display_buffer_compositor.reset();
+                display_buffer.reset();
+            });
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        while (running)
+        {
+            if (task)
+            {
+                lock.unlock();
+                std::exception_ptr thrown;
+                try
+                {
+                    (*task)();
+                }
+                catch (...)
+                {
+                    thrown = std::current_exception();
+                }
+                lock.lock();
+
+                task_error = thrown;
+                task = nullptr;
+                changed.notify_all();
+                continue;
+            }
+
+            if (!damaged || !free_queue.num_scheduled())
+            {
+                changed.wait(lock);
+                continue;
+            }
+
+            if (Clock::now() < next_composite)
+            {
+                changed.wait_until(lock, next_composite);
+                continue;
+            }
+
+            damaged = false;
+            frame_in_progress = true;
+            lock.unlock();
+
+            auto const start = Clock::now();
+            display_buffer_compositor->composite(scene->scene_elements_for(this));
+            auto frame = ready_queue.next_buffer();
+            auto const more_frames = scene->frames_pending(this) > 0;
+
+            lock.lock();
+            if (latest_frame)
+                free_queue.schedule(latest_frame);
+            latest_frame = std::move(frame);
+            frame_in_progress = false;
+            damaged = damaged || more_frames;
+            composite_time = Clock::now() - start;
+            next_composite = start + capture_interval;
+            changed.notify_all();
+        }
+    }
+    catch (...)
+    {
+        display_buffer_compositor.reset();
+        display_buffer.reset();
+
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        error = std::current_exception();
+        changed.notify_all();
+    }
+
     std::shared_ptr<Scene> const scene;
     QueueingSchedule free_queue;
     QueueingSchedule ready_queue;
-    std::unique_ptr<ScreencastDisplayBuffer> display_buffer;
 
+    // Only touched on the session thread
+    std::unique_ptr<ScreencastDisplayBuffer> display_buffer;
     std::unique_ptr<compositor::DisplayBufferCompositor> display_buffer_compositor;
+
     std::unique_ptr<graphics::VirtualOutput> virtual_output;
+    std::shared_ptr<ms::Observer> const observer;
+
+    std::mutex posting;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool started{false};
+    bool running{true};
+    bool damaged{true};
+    bool frame_in_progress{false};
+    std::exception_ptr error;
+    std::function<void()> const* task{nullptr};
+    std::exception_ptr task_error;
+    std::shared_ptr<mg::Buffer> latest_frame;
     std::shared_ptr<mg::Buffer> last_captured_buffer;
+
+    Clock::time_point last_capture;
+    Clock::duration capture_interval{0};
+    Clock::duration composite_time{0};
+    Clock::time_point next_composite;
+
+    std::thread thread;
 };
 
 
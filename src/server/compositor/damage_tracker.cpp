@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "damage_tracker.h"
+#include "mir/graphics/buffer.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+void add_damage(geom::Rectangles& damage, geom::Rectangle const& rect, geom::Rectangle const& area)
+{
+    auto const clipped = rect.intersection_with(area);
+    if (clipped != geom::Rectangle{})
+        damage.add(clipped);
+}
+}
+
+geom::Rectangles const& mc::DamageTracker::damage_for(
+    mg::RenderableList const& renderables,
+    geom::Rectangle const& area)
+{
+    static glm::mat4 const identity;
+    auto const by_id = [](RenderableState const& lhs, RenderableState const& rhs) { return lhs.id < rhs.id; };
+
+    bool full_damage = !have_last_frame || area != last_area;
+    this_frame.clear();
+    damage.clear();
+
+    size_t stacking_index = 0;
+    for (auto const& renderable : renderables)
+    {
+        // We can't bound what a transformed renderable covers, so give up
+        if (renderable->transformation() != identity)
+            full_damage = true;
+
+        /*
+         * Like the texture cache we rely on a new frame from the client
+         * arriving in a buffer with a different ID to the last one.
+         */
+        RenderableState const state{
+            renderable->id(),
+            renderable->buffer()->id(),
+            renderable->screen_position(),
+            renderable->alpha(),
+            renderable->shaped(),
+            stacking_index++,
+            false};
+
+        auto const previous = std::lower_bound(last_frame.begin(), last_frame.end(), state, by_id);
+        if (previous == last_frame.end() || previous->id != state.id || previous->matched)
+        {
+            add_damage(damage, state.position, area);
+        }
+        else
+        {
+            auto const& old = *previous;
+            if (old.position != state.position)
+            {
+                add_damage(damage, old.position, area);
+                add_damage(damage, state.position, area);
+            }
+            else if (old.buffer_id != state.buffer_id ||
+                     old.alpha != state.alpha ||
+                     old.shaped != state.shaped ||
+                     old.stacking_index != state.stacking_index)
+            {
+                add_damage(damage, state.position, area);
+            }
+            previous->matched = true;
+        }
+
+        this_frame.push_back(state);
+    }
+
+    // Whatever is left has gone away since the last frame
+    for (auto const& gone : last_frame)
+    {
+        if (!gone.matched)
+            add_damage(damage, gone.position, area);
+    }
+
+    std::sort(this_frame.begin(), this_frame.end(), by_id);
+    std::swap(last_frame, this_frame);
+    last_area = area;
+    have_last_frame = true;
+
+    if (full_damage)
+    {
+        damage.clear();
+        damage.add(area);
+    }
+
+    return damage;
+}
+
+void mc::DamageTracker::reset()
+{
+    have_last_frame = false;
+    last_frame.clear();
+}
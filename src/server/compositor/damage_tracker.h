@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Works out which parts of an output have changed between consecutive
+ * frames by comparing the renderables of each frame with the last.
+ */
+class DamageTracker
+{
+public:
+    /**
+     * Returns the parts of \a area that need redrawing to turn the
+     * previous frame into one showing \a renderables. The result is valid
+     * until the next call.
+     */
+    geometry::Rectangles const& damage_for(
+        graphics::RenderableList const& renderables,
+        geometry::Rectangle const& area);
+
+    /// Forgets the previous frame so the next one is damaged in full
+    void reset();
+
+private:
+    struct RenderableState
+    {
+        graphics::Renderable::ID id;
+        graphics::BufferID buffer_id;
+        geometry::Rectangle position;
+        float alpha;
+        bool shaped;
+        size_t stacking_index;
+        bool matched;
+    };
+
+    bool have_last_frame{false};
+    geometry::Rectangle last_area;
+    // Sorted by id. The two are swapped every frame, so once the scene is
+    // steady neither needs to allocate.
+    std::vector<RenderableState> last_frame;
+    std::vector<RenderableState> this_frame;
+    geometry::Rectangles damage;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_DAMAGE_TRACKER_H_ */
@@ -26,12 +26,19 @@
 #include "compositing_screencast.h"
 #include "timeout_frame_dropping_policy_factory.h"
 #include "mir/main_loop.h"
+#include "mir/frame_timeline.h"
+#include "mir/abnormal_exit.h"
+#include "mir/log.h"
 
 #include "mir/frontend/screencast.h"
 #include "mir/options/configuration.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
 namespace mf = mir::frontend;
@@ -85,6 +92,35 @@ mir::DefaultServerConfiguration::the_compositor()
             std::chrono::milliseconds const composite_delay(
                 the_options()->get<int>(options::composite_delay_opt));
 
+            auto const timeline_spans = the_options()->get<int>(options::frame_timeline_opt);
+            if (timeline_spans > 0)
+            {
+                std::string file;
+                if (the_options()->is_set(options::frame_timeline_file_opt))
+                    file = the_options()->get<std::string>(options::frame_timeline_file_opt);
+                else if (auto const runtime_dir = getenv("XDG_RUNTIME_DIR"))
+                    file = std::string{runtime_dir} + "/mir-frame-timeline.json";
+                else
+                    throw AbnormalExit(
+                        std::string{"Exiting Mir! Reason: --"} + options::frame_timeline_opt +
+                        " needs --" + options::frame_timeline_file_opt + " when XDG_RUNTIME_DIR is not set");
+
+                FrameTimeline::enable(timeline_spans);
+                the_main_loop()->register_signal_handler(
+                    {SIGUSR2},
+                    [file](int)
+                    {
+                        try
+                        {
+                            FrameTimeline::dump(file);
+                        }
+                        catch (std::exception const& error)
+                        {
+                            log_error("Frame timeline not written: %s", error.what());
+                        }
+                    });
+            }
+
             return std::make_shared<mc::MultiThreadedCompositor>(
                 the_display(),
                 the_scene(),
@@ -92,7 +128,8 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_shell(),
                 the_compositor_report(),
                 composite_delay,
-                !the_options()->is_set(options::host_socket_opt));
+                !the_options()->is_set(options::host_socket_opt),
+                the_options()->get<bool>(options::parallel_composite_opt));
         });
 }
 
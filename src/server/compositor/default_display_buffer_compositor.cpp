@@ -27,6 +27,7 @@
 #include "mir/compositor/buffer_stream.h"
 #include "mir/renderer/renderer.h"
 #include "occlusion.h"
+#include "mir/frame_timeline.h"
 #include <mutex>
 #include <cstdlib>
 #include <algorithm>
@@ -49,13 +50,14 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     report->began_frame(this);
 
     auto const& view_area = display_buffer.view_area();
-    auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
+    mc::filter_occlusions_from(scene_elements, view_area, occlusions, coverage);
 
     for (auto const& element : occlusions)
         element->occluded();
+    occlusions.clear();
 
-    mg::RenderableList renderable_list;
-    renderable_list.reserve(scene_elements.size());
+    // Kept from frame to frame so that, once the scene is steady, nothing here allocates
+    renderable_list.clear();
     for (auto const& element : scene_elements)
     {
         element->rendered();
@@ -66,7 +68,7 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      * Note: Buffer lifetimes are ensured by the two objects holding
      *       references to them; scene_elements and renderable_list.
      *       So no buffer is going to be released back to the client till
-     *       both of those containers get destroyed (end of the function).
+     *       both of those containers are cleared (by the end of the function).
      *       Actually, there's a third reference held by the texture cache
      *       in GLRenderer, but that gets released earlier in render().
      */
@@ -76,11 +78,17 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+        damage_tracker.reset();
+        renderable_list.clear();
     }
     else
     {
         renderer->set_output_transform(display_buffer.orientation(), display_buffer.mirror_mode());
-        renderer->render(renderable_list);
+        renderer->set_damage(damage_tracker.damage_for(renderable_list, view_area));
+        {
+            FrameTimeline::Span const span{FrameTimeline::Stage::render, this};
+            renderer->render(renderable_list);
+        }
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
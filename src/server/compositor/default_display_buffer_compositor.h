@@ -21,6 +21,10 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "damage_tracker.h"
+#include "mir/compositor/scene.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/renderable.h"
 #include <memory>
 
 namespace mir
@@ -52,6 +56,10 @@ private:
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    DamageTracker damage_tracker;
+    SceneElementSequence occlusions;
+    geometry::Rectangles coverage;
+    graphics::RenderableList renderable_list;
 };
 
 }
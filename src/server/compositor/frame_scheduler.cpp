@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "frame_scheduler.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+// Fewer render samples than this and a percentile means little
+size_t const min_render_samples{8};
+auto const min_margin = 1ms;
+// Beyond this the vblank we know of is too old to extrapolate from
+auto const max_vblank_age = 1s;
+
+template<size_t size>
+std::chrono::nanoseconds percentile(
+    std::array<std::chrono::nanoseconds, size> samples, size_t count, size_t percent)
+{
+    count = std::min(count, size);
+    auto const nth = samples.begin() + std::min(count * percent / 100, count - 1);
+    std::nth_element(samples.begin(), nth, samples.begin() + count);
+    return *nth;
+}
+}
+
+auto mc::FrameScheduler::next_start(TimePoint now, TimePoint fallback) -> TimePoint
+{
+    target_msc = 0;
+
+    if (period_count < 2 || render_count < min_render_samples || now - last_vblank > max_vblank_age)
+        return fallback;
+
+    auto const period = percentile(periods, period_count, 50);
+    auto const budget = latency_budget();
+
+    if (budget >= period)
+        return now;
+
+    // The soonest vblank that still leaves the whole budget to render in
+    auto const vblanks = std::max<int64_t>((now + budget - last_vblank + period - 1ns) / period, 1);
+
+    target_msc = last_msc + vblanks;
+    target_vblank = last_vblank + vblanks * period;
+
+    return target_vblank - budget;
+}
+
+bool mc::FrameScheduler::targets_vblank() const
+{
+    return target_msc != 0;
+}
+
+void mc::FrameScheduler::frame_started(TimePoint time)
+{
+    frame_start = time;
+}
+
+bool mc::FrameScheduler::frame_rendered(TimePoint time)
+{
+    render_times[render_count++ % render_samples] = time - frame_start;
+
+    if (!target_msc)
+        return false;
+
+    if (time > target_vblank)
+    {
+        target_msc = 0;
+        missed();
+        return true;
+    }
+
+    margin = std::max<std::chrono::nanoseconds>(margin - margin / 64, min_margin);
+    return false;
+}
+
+bool mc::FrameScheduler::frame_displayed(int64_t msc, TimePoint vblank)
+{
+    if (msc <= 0)
+        return false;
+
+    if (msc < last_msc)
+    {
+        // The output has been reset, so its old timing means nothing
+        period_count = 0;
+        target_msc = 0;
+    }
+    else if (last_msc > 0 && msc > last_msc)
+    {
+        auto const period = (vblank - last_vblank) / (msc - last_msc);
+        if (period >= 1ms && period <= 1s)
+            periods[period_count++ % periods.size()] = period;
+    }
+
+    if (msc != last_msc)
+    {
+        last_msc = msc;
+        last_vblank = vblank;
+    }
+
+    if (target_msc && msc >= target_msc)
+    {
+        auto const late = msc > target_msc;
+        target_msc = 0;
+
+        if (late)
+        {
+            missed();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::chrono::nanoseconds mc::FrameScheduler::latency_budget() const
+{
+    if (!render_count)
+        return margin;
+
+    return percentile(render_times, render_count, 95) + margin;
+}
+
+void mc::FrameScheduler::missed()
+{
+    auto const max_margin = period_count ? percentile(periods, period_count, 50) / 2 : 8ms;
+    margin = std::min<std::chrono::nanoseconds>(margin * 2, max_margin);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+#define MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Decides when a compositing thread should start its next frame.
+ *
+ * The later a frame starts, the fresher the scene it shows. So once the
+ * display has reported a couple of vblanks, frames start just in time for
+ * the next vblank they can make: a latency budget ahead of it. The budget
+ * is a high percentile of recent render times plus a margin, which doubles
+ * whenever a frame misses its vblank and slowly shrinks while none do.
+ *
+ * Until the display's timing is known, the caller's fallback applies.
+ */
+class FrameScheduler
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    /**
+     * When to start the next frame, asked for at \a now. If the display's
+     * timing isn't known yet that is \a fallback.
+     */
+    TimePoint next_start(TimePoint now, TimePoint fallback);
+    /// Whether the frame about to start was timed for a particular vblank
+    bool targets_vblank() const;
+
+    void frame_started(TimePoint time);
+    /// Returns whether the frame finished rendering after the vblank it was started for
+    bool frame_rendered(TimePoint time);
+    /// Returns whether the display reached the vblank for the last frame before showing it
+    bool frame_displayed(int64_t msc, TimePoint vblank);
+
+    /// How far ahead of the vblank frames start
+    std::chrono::nanoseconds latency_budget() const;
+
+private:
+    void missed();
+
+    // Enough to ride out a slow frame or two without chasing every spike
+    static size_t const render_samples{64};
+    std::array<std::chrono::nanoseconds, render_samples> render_times;
+    size_t render_count{0};
+    TimePoint frame_start;
+
+    std::array<std::chrono::nanoseconds, 8> periods;
+    size_t period_count{0};
+    int64_t last_msc{0};
+    TimePoint last_vblank;
+
+    std::chrono::nanoseconds margin{std::chrono::milliseconds{2}};
+
+    // The vblank the current frame was started for, if it was started just in time
+    int64_t target_msc{0};
+    TimePoint target_vblank;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_FRAME_SCHEDULER_H_ */
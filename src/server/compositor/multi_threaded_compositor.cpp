@@ -17,6 +17,7 @@
  */
 
 #include "multi_threaded_compositor.h"
+#include "frame_scheduler.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/compositor/display_buffer_compositor.h"
@@ -31,6 +32,7 @@
 #include "mir/raii.h"
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
+#include "mir/frame_timeline.h"
 
 #include <thread>
 #include <chrono>
@@ -43,6 +45,98 @@ namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
 
+namespace
+{
+/*
+ * The thread an output is composited on, when a group's outputs are
+ * composited in parallel. Its compositor is created, used and destroyed only
+ * there, so the output's GL context is never current anywhere else.
+ */
+class OutputThread
+{
+public:
+    OutputThread() :
+        thread{[this]{ work(); }}
+    {
+    }
+
+    ~OutputThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            exiting = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+
+    /// Starts \a task, which has to live until the wait() for it returns
+    void start(std::function<void()> const& task)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        this->task = &task;
+        cv.notify_all();
+    }
+
+    /// Waits for the task started last, and rethrows anything it threw
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this]{ return !task; });
+
+        if (auto const thrown = error)
+        {
+            error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+    }
+
+    void run(std::function<void()> const& task)
+    {
+        start(task);
+        wait();
+    }
+
+private:
+    void work() noexcept
+    {
+        mir::set_thread_name("Mir/Comp/Out");
+
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!exiting)
+        {
+            cv.wait(lock, [this]{ return task || exiting; });
+
+            if (task)
+            {
+                std::exception_ptr thrown;
+                lock.unlock();
+                try
+                {
+                    (*task)();
+                }
+                catch (...)
+                {
+                    thrown = std::current_exception();
+                }
+                lock.lock();
+
+                error = thrown;
+                task = nullptr;
+                cv.notify_all();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::function<void()> const* task{nullptr};
+    std::exception_ptr error;
+    bool exiting{false};
+    std::thread thread; // Last, so that all it uses exists before it starts
+};
+}
+
 namespace mir
 {
 namespace compositor
@@ -57,6 +151,7 @@ public:
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
+        bool parallel_outputs,
         std::shared_ptr<CompositorReport> const& report) :
         compositor_factory{db_compositor_factory},
         group(group),
@@ -64,6 +159,7 @@ public:
         running{true},
         frames_scheduled{0},
         force_sleep{fixed_composite_delay},
+        parallel_outputs{parallel_outputs},
         display_listener{display_listener},
         report{report},
         started_future{started.get_future()}
@@ -75,12 +171,30 @@ public:
     {
         mir::set_thread_name("Mir/Comp");
 
+        // A frame then takes as long as its slowest output, rather than all of them
+        std::vector<std::unique_ptr<OutputThread>> output_threads;
+        if (parallel_outputs)
+        {
+            group.for_each_display_buffer([&output_threads](mg::DisplayBuffer&)
+                { output_threads.push_back(std::make_unique<OutputThread>()); });
+
+            if (output_threads.size() < 2)
+                output_threads.clear();
+        }
+
         std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
         group.for_each_display_buffer(
-        [this, &compositors](mg::DisplayBuffer& buffer)
+        [this, &compositors, &output_threads](mg::DisplayBuffer& buffer)
         {
-            compositors.emplace_back(
-                std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer)));
+            std::unique_ptr<mc::DisplayBufferCompositor> compositor;
+            auto const create = [&]{ compositor = compositor_factory->create_compositor_for(buffer); };
+
+            if (output_threads.empty())
+                create();
+            else
+                output_threads[compositors.size()]->run(create);
+
+            compositors.emplace_back(std::make_tuple(&buffer, std::move(compositor)));
 
             auto const& r = buffer.view_area();
             auto const comp_id = std::get<1>(compositors.back()).get();
@@ -89,6 +203,14 @@ public:
                                   CompositorReport::SubCompositorId{comp_id});
         });
 
+        auto compositor_destruction = mir::raii::paired_calls(
+            []{},
+            [&compositors, &output_threads]
+            {
+                for (size_t i = 0; i != output_threads.size(); ++i)
+                    output_threads[i]->run([&]{ std::get<1>(compositors[i]).reset(); });
+            });
+
         //Appease TSan, avoid destructor and this thread accessing the same shared_ptr instance
         auto const disp_listener = display_listener;
         auto display_registration = mir::raii::paired_calls(
@@ -110,6 +232,25 @@ public:
 
         started.set_value();
 
+        // Reused for every frame, so that steady compositing doesn't allocate
+        std::vector<mc::SceneElementSequence> scene_elements(compositors.size());
+        std::vector<std::function<void()>> composite_output;
+        for (size_t i = 0; i != compositors.size(); ++i)
+        {
+            composite_output.push_back(
+                [this, &compositors, &scene_elements, i]
+                {
+                    auto const start = std::chrono::steady_clock::now();
+                    auto const& compositor = std::get<1>(compositors[i]);
+
+                    scene->collect_scene_elements(compositor.get(), scene_elements[i]);
+                    compositor->composite(std::move(scene_elements[i]));
+                    scene_elements[i].clear();
+
+                    report->composited_output(compositor.get(), std::chrono::steady_clock::now() - start);
+                });
+        }
+
         try
         {
             std::unique_lock<std::mutex> lock{run_mutex};
@@ -118,6 +259,13 @@ public:
                 /* Wait until compositing has been scheduled or we are stopped */
                 run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
 
+                /*
+                 * Then until it's time to start: as late as possible for the
+                 * frame to make its vblank, so that it shows the freshest
+                 * scene it can.
+                 */
+                run_cv.wait_until(lock, next_start(), [&]{ return !running; });
+
                 /*
                  * Check if we are running before compositing, since we may have
                  * been stopped while waiting for the run_cv above.
@@ -135,23 +283,49 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
-                    for (auto& tuple : compositors)
+                    if (scheduler.targets_vblank())
                     {
-                        auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        for (auto& tuple : compositors)
+                            report->chose_latency_budget(std::get<1>(tuple).get(), scheduler.latency_budget());
                     }
-                    group.post();
 
-                    /*
-                     * "Predictive bypass" optimization: If the last frame was
-                     * bypassed/overlayed or you simply have a fast GPU, it is
-                     * beneficial to sleep for most of the next frame. This reduces
-                     * the latency between snapshotting the scene and post()
-                     * completing by almost a whole frame.
-                     */
-                    auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
-                                 force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
+                    scheduler.frame_started(std::chrono::steady_clock::now());
+
+                    if (output_threads.empty())
+                    {
+                        for (auto const& composite : composite_output)
+                            composite();
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i != output_threads.size(); ++i)
+                            output_threads[i]->start(composite_output[i]);
+
+                        for (auto const& thread : output_threads)
+                            thread->wait();
+                    }
+
+                    auto missed = scheduler.frame_rendered(std::chrono::steady_clock::now());
+
+                    {
+                        FrameTimeline::Span const span{FrameTimeline::Stage::post, &group};
+                        group.post();
+                    }
+
+                    last_post = std::chrono::steady_clock::now();
+                    auto const frame = group.last_frame();
+                    if (frame.msc > 0)
+                    {
+                        // The display's clock may not be ours, so measure how long ago the frame was on its own
+                        auto const age = mir::time::PosixTimestamp::now(frame.ust.clock_id) - frame.ust;
+                        missed = scheduler.frame_displayed(frame.msc, last_post - age) || missed;
+                    }
+
+                    if (missed)
+                    {
+                        for (auto& tuple : compositors)
+                            report->missed_frame(std::get<1>(tuple).get());
+                    }
 
                     lock.lock();
 
@@ -189,6 +363,25 @@ public:
         auto promise = std::move(started);
     }
 
+    /*
+     * A fixed delay after the last post() wins if there is one. Otherwise the
+     * scheduler picks a time just ahead of the next vblank, and until it knows
+     * the display's timing the group's own recommendation applies.
+     *
+     * The recommendation is the "predictive bypass" optimization: If the last
+     * frame was bypassed/overlayed or you simply have a fast GPU, it is
+     * beneficial to sleep for most of the next frame. This reduces the latency
+     * between snapshotting the scene and post() completing by almost a whole
+     * frame.
+     */
+    std::chrono::steady_clock::time_point next_start()
+    {
+        if (force_sleep >= std::chrono::milliseconds::zero())
+            return last_post + force_sleep;
+
+        return scheduler.next_start(std::chrono::steady_clock::now(), last_post + group.recommended_sleep());
+    }
+
     void schedule_compositing(int num_frames)
     {
         std::lock_guard<std::mutex> lock{run_mutex};
@@ -237,6 +430,7 @@ private:
     bool running;
     int frames_scheduled;
     std::chrono::milliseconds force_sleep{-1};
+    bool const parallel_outputs;
     std::mutex run_mutex;
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
@@ -244,6 +438,8 @@ private:
     std::promise<void> started;
     std::future<void> started_future;
     bool not_posted_yet = true;
+    FrameScheduler scheduler;
+    std::chrono::steady_clock::time_point last_post;
 };
 
 }
@@ -256,7 +452,8 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<DisplayListener> const& display_listener,
     std::shared_ptr<CompositorReport> const& compositor_report,
     std::chrono::milliseconds fixed_composite_delay,
-    bool compose_on_start)
+    bool compose_on_start,
+    bool parallel_outputs)
     : display{display},
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
@@ -265,6 +462,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
       compose_on_start{compose_on_start},
+      parallel_outputs{parallel_outputs},
       thread_pool{1}
 {
     observer = std::make_shared<ms::LegacySceneChangeNotification>(
@@ -368,7 +566,7 @@ void mc::MultiThreadedCompositor::create_compositing_threads()
     {
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
             display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            fixed_composite_delay, parallel_outputs, report);
 
         futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
         thread_functors.push_back(std::move(thread_functor));
@@ -17,11 +17,12 @@
  */
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
-#include <vector>
+#include <algorithm>
 
 using namespace mir::geometry;
 using namespace mir::graphics;
@@ -32,7 +33,7 @@ namespace
 bool renderable_is_occluded(
     Renderable const& renderable, 
     Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+    Rectangles& coverage)
 {
     static glm::mat4 const identity;
     static Rectangle const empty{};
@@ -46,18 +47,12 @@ bool renderable_is_occluded(
     if (clipped_window == empty)
         return true;  // Not in the area; definitely occluded.
 
-    bool occluded = false;
-    for (auto const& r : coverage)
-    {
-        if (r.contains(clipped_window))
-        {
-            occluded = true;
-            break;
-        }
-    }
+    // Covered by the union of everything opaque above, even if no one
+    // window hides it completely
+    bool const occluded = coverage.covers(clipped_window);
 
     if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
+        coverage.add(clipped_window);
 
     return occluded;
 }
@@ -68,7 +63,19 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     Rectangle const& area)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    Rectangles coverage;
+    filter_occlusions_from(elements, area, occluded, coverage);
+    return occluded;
+}
+
+void mir::compositor::filter_occlusions_from(
+    SceneElementSequence& elements,
+    Rectangle const& area,
+    SceneElementSequence& occluded,
+    Rectangles& coverage)
+{
+    occluded.clear();
+    coverage.clear();
 
     auto it = elements.rbegin();
     while (it != elements.rend())
@@ -76,7 +83,7 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
         auto const renderable = (*it)->renderable();
         if (renderable_is_occluded(*renderable, area, coverage))
         {
-            occluded.insert(occluded.begin(), *it);
+            occluded.push_back(*it);
             it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
         }
         else
@@ -85,5 +92,6 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
         }
     }
 
-    return occluded;
+    // Found topmost first; keep them in stacking order like the rest
+    std::reverse(occluded.begin(), occluded.end());
 }
@@ -20,6 +20,7 @@
 #define MIR_COMPOSITOR_OCCLUSION_H_
 
 #include "mir/compositor/scene.h"
+#include "mir/geometry/rectangles.h"
 
 namespace mir
 {
@@ -28,6 +29,13 @@ namespace compositor
 
 SceneElementSequence filter_occlusions_from(SceneElementSequence& list, geometry::Rectangle const& area);
 
+/// As above, but into \a occluded and with \a coverage as scratch space, so both can be reused every frame
+void filter_occlusions_from(
+    SceneElementSequence& list,
+    geometry::Rectangle const& area,
+    SceneElementSequence& occluded,
+    geometry::Rectangles& coverage);
+
 } // namespace compositor
 } // namespace mir
 
@@ -25,13 +25,23 @@
 #include "mir/graphics/buffer.h"
 #include "mir/compositor/frame_dropping_policy_factory.h"
 #include "mir/compositor/frame_dropping_policy.h"
+#include "mir/renderer/gl/partial_texture_source.h"
+#include "mir/frame_timeline.h"
 #include <boost/throw_exception.hpp>
+#include <atomic>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
-namespace geom = mir::geometry;
+namespace mrgl = mir::renderer::gl;
+
+namespace
+{
+// Frame serials are unique across streams so that a texture can't mistake
+// another stream's frame for its own
+std::atomic<uint64_t> next_frame{1};
+}
 
 enum class mc::Stream::ScheduleMode {
     Queueing,
@@ -89,15 +99,36 @@ unsigned int mc::Stream::client_owned_buffer_count(std::lock_guard<decltype(mute
 }
 
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    if (!buffer)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
+
+    submit_buffer(buffer, geom::Rectangles{{{0, 0}, buffer->size()}});
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
 
     {
         std::lock_guard<decltype(mutex)> lk(mutex); 
+        auto const frame = next_frame++;
+        if (auto const source = dynamic_cast<mrgl::PartialTextureSource*>(buffer->native_buffer_base()))
+        {
+            auto const previous = (buffer->size() == last_frame_size) ? last_frame : 0;
+            source->set_damage(frame, previous, damage);
+        }
+        last_frame = frame;
+        last_frame_size = buffer->size();
+
         first_frame_posted = true;
         buffers->receive_buffer(buffer->id());
-        schedule->schedule((*buffers)[buffer->id()]);
+        {
+            FrameTimeline::Span const span{
+                FrameTimeline::Stage::buffer_scheduled, dynamic_cast<void const*>(this), buffer->id().as_value()};
+            schedule->schedule((*buffers)[buffer->id()]);
+        }
         if (!associated_buffers.empty() && (client_owned_buffer_count(lk) == 0))
             drop_policy->swap_now_blocking();
     }
@@ -133,7 +164,10 @@ std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
         std::lock_guard<decltype(mutex)> lk(mutex);
         drop_policy->swap_unblocked();
     }
-    return std::make_shared<mc::TemporaryCompositorBuffer>(arbiter, id);
+    FrameTimeline::Span span{FrameTimeline::Stage::compositor_acquire, dynamic_cast<void const*>(this)};
+    auto const buffer = std::make_shared<mc::TemporaryCompositorBuffer>(arbiter, id);
+    span.set_buffer(buffer->id().as_value());
+    return buffer;
 }
 
 geom::Size mc::Stream::stream_size()
@@ -47,6 +47,9 @@ public:
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void add_observer(std::shared_ptr<scene::SurfaceObserver> const& observer) override;
@@ -88,6 +91,8 @@ private:
     geometry::Size size; 
     MirPixelFormat const pf;
     bool first_frame_posted;
+    uint64_t last_frame{0};
+    geometry::Size last_frame_size;
 
     scene::SurfaceObservers observers;
 
@@ -0,0 +1,310 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mir/frame_timeline.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+std::atomic<bool> mir::FrameTimeline::enabled_{false};
+
+namespace
+{
+using Stage = mir::FrameTimeline::Stage;
+
+char const* const stage_names[] = {
+    "submit_received", "buffer_scheduled", "compositor_acquire", "render", "post", "buffer_returned"};
+char const* const key_names[] = {
+    "stream", "stream", "stream", "output", "sync_group", nullptr};
+
+struct Slot
+{
+    // Nanoseconds on the steady clock
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> duration{0};
+    std::atomic<uint64_t> key{0};
+    std::atomic<uint64_t> stage_and_buffer{0};
+};
+
+struct Span
+{
+    uint64_t start;
+    uint64_t duration;
+    uint64_t key;
+    uint64_t stage_and_buffer;
+};
+
+/*
+ * Written only by the thread that owns it. Span n goes into slot n % size,
+ * and a reader knows a slot it copied may have been overwritten meanwhile
+ * if written has since reached size past it.
+ */
+struct Ring
+{
+    explicit Ring(size_t size) : size{size}, slots{new Slot[size]} {}
+
+    size_t const size;
+    std::unique_ptr<Slot[]> const slots;
+    std::atomic<uint64_t> written{0};
+
+    // Guarded by Registry::mutex
+    pid_t tid{0};
+    std::string thread_name;
+};
+
+// Beyond this many rings, new threads take over those of threads that have exited
+size_t const max_rings{64};
+
+struct Registry
+{
+    std::mutex mutex;
+    size_t spans_per_thread{1};
+    std::vector<std::shared_ptr<Ring>> rings;
+    // Rings of threads that have exited, the longest gone first
+    std::deque<std::shared_ptr<Ring>> spare;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+std::shared_ptr<Ring> claim_ring()
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+
+    std::shared_ptr<Ring> ring;
+    if (reg.rings.size() >= max_rings && !reg.spare.empty())
+    {
+        ring = reg.spare.front();
+        reg.spare.pop_front();
+        ring->written = 0;
+    }
+    else
+    {
+        // With a slot to spare for the span being written while a reader copies the rest
+        ring = std::make_shared<Ring>(reg.spans_per_thread + 1);
+        reg.rings.push_back(ring);
+    }
+
+    char name[16];
+    ring->tid = syscall(SYS_gettid);
+    ring->thread_name = pthread_getname_np(pthread_self(), name, sizeof name) ? "" : name;
+    return ring;
+}
+
+struct ThreadRing
+{
+    ~ThreadRing()
+    {
+        if (ring)
+        {
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock{reg.mutex};
+            reg.spare.push_back(ring);
+        }
+    }
+
+    std::shared_ptr<Ring> ring;
+};
+
+thread_local ThreadRing this_thread;
+
+uint64_t ns(mir::FrameTimeline::TimePoint time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::vector<Span> copy_spans(Ring const& ring)
+{
+    auto const end = ring.written.load(std::memory_order_acquire);
+    auto const begin = end > ring.size ? end - ring.size : 0;
+
+    std::vector<Span> spans;
+    spans.reserve(end - begin);
+    for (auto n = begin; n != end; ++n)
+    {
+        auto const& slot = ring.slots[n % ring.size];
+        spans.push_back({
+            slot.start.load(std::memory_order_relaxed),
+            slot.duration.load(std::memory_order_relaxed),
+            slot.key.load(std::memory_order_relaxed),
+            slot.stage_and_buffer.load(std::memory_order_relaxed)});
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // The span being written now may be going into the slot of the oldest we copied
+    auto const writing = ring.written.load(std::memory_order_relaxed);
+    auto const first_intact = std::max(writing + 1 > ring.size ? writing + 1 - ring.size : 0, begin);
+    spans.erase(spans.begin(), spans.begin() + std::min(first_intact, end) - begin);
+    return spans;
+}
+
+void write_escaped(std::ostream& out, std::string const& text)
+{
+    out << '"';
+    for (auto c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) >= 0x20)
+            out << c;
+    }
+    out << '"';
+}
+
+void write_us(std::ostream& out, uint64_t ns)
+{
+    auto const fraction = std::to_string(1000 + ns % 1000);
+    out << ns / 1000 << '.' << fraction.substr(1);
+}
+}
+
+void mir::FrameTimeline::enable(size_t spans_per_thread)
+{
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        if (reg.rings.empty())
+            reg.spans_per_thread = std::max<size_t>(spans_per_thread, 1);
+    }
+    enabled_ = true;
+}
+
+void mir::FrameTimeline::disable()
+{
+    enabled_ = false;
+}
+
+void mir::FrameTimeline::record(Stage stage, void const* key, uint32_t buffer_id, TimePoint start, TimePoint end)
+{
+    auto& ring = this_thread.ring;
+    if (!ring)
+        ring = claim_ring();
+
+    auto const n = ring->written.load(std::memory_order_relaxed);
+    auto& slot = ring->slots[n % ring->size];
+
+    // Readers that see any of these stores must also see written as it was before them
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.start.store(ns(start), std::memory_order_relaxed);
+    slot.duration.store(ns(end) - ns(start), std::memory_order_relaxed);
+    slot.key.store(reinterpret_cast<uintptr_t>(key), std::memory_order_relaxed);
+    slot.stage_and_buffer.store(
+        uint64_t{static_cast<uint32_t>(stage)} << 32 | buffer_id, std::memory_order_relaxed);
+
+    ring->written.store(n + 1, std::memory_order_release);
+}
+
+void mir::FrameTimeline::dump(std::ostream& out)
+{
+    auto const pid = getpid();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    auto separator = "\n";
+
+    for (auto const& ring : reg.rings)
+    {
+        if (!ring->tid)
+            continue;
+
+        out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+        write_escaped(out, ring->thread_name);
+        out << "}}";
+        separator = ",\n";
+
+        for (auto const& span : copy_spans(*ring))
+        {
+            auto const stage = std::min<size_t>(
+                span.stage_and_buffer >> 32, sizeof stage_names / sizeof stage_names[0] - 1);
+
+            out << ",\n{\"name\":\"" << stage_names[stage] << "\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":";
+            write_us(out, span.start);
+            out << ",\"dur\":";
+            write_us(out, span.duration);
+            out << ",\"pid\":" << pid << ",\"tid\":" << ring->tid << ",\"args\":{";
+            if (key_names[stage])
+                out << '"' << key_names[stage] << "\":\"0x" << std::hex << span.key << std::dec << "\",";
+            out << "\"buffer\":" << (span.stage_and_buffer & 0xffffffff) << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+void mir::FrameTimeline::dump(std::string const& path)
+{
+    std::ostringstream out;
+    dump(out);
+    auto const json = out.str();
+
+    // mkostemp() creates the file exclusively, so nothing planted at the temporary name is followed
+    auto const temp_name = path + ".XXXXXX";
+    std::vector<char> temp_path(temp_name.c_str(), temp_name.c_str() + temp_name.size() + 1);
+
+    auto const fd = mkostemp(temp_path.data(), O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error{errno, std::system_category(), "Failed to create a file next to " + path};
+
+    // Removes the unfinished file and reports the error that stopped it
+    auto const discard = [&](int error, std::string const& what)
+        {
+            unlink(temp_path.data());
+            throw std::system_error{error, std::system_category(), what + path};
+        };
+
+    for (size_t written{0}; written != json.size();)
+    {
+        auto const result = write(fd, json.data() + written, json.size() - written);
+        if (result < 0 && errno != EINTR)
+        {
+            auto const error = errno;
+            close(fd);
+            discard(error, "Failed to write ");
+        }
+        if (result > 0)
+            written += result;
+    }
+
+    if (close(fd) != 0)
+        discard(errno, "Failed to write ");
+
+    if (rename(temp_path.data(), path.c_str()) != 0)
+        discard(errno, "Failed to replace ");
+}
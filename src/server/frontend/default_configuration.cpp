@@ -54,10 +54,13 @@ mir::DefaultServerConfiguration::the_connector()
     return connector(
         [&,this]() -> std::shared_ptr<mf::Connector>
         {
+            auto const threads = the_options()->get<int>(options::frontend_threads_opt);
+
             if (the_options()->is_set(options::no_server_socket_opt))
             {
                 return std::make_shared<mf::BasicConnector>(
                     the_connection_creator(),
+                    threads,
                     the_connector_report());
             }
             else
@@ -65,6 +68,7 @@ mir::DefaultServerConfiguration::the_connector()
                 auto const result = std::make_shared<mf::PublishedSocketConnector>(
                     the_socket_file(),
                     the_connection_creator(),
+                    threads,
                     *the_emergency_cleanup(),
                     the_connector_report());
 
@@ -129,6 +133,7 @@ mir::DefaultServerConfiguration::the_prompt_connector()
                 return std::make_shared<mf::PublishedSocketConnector>(
                     the_socket_file() + "_trusted",
                     the_prompt_connection_creator(),
+                    1,
                     *the_emergency_cleanup(),
                     the_connector_report());
             }
@@ -136,6 +141,7 @@ mir::DefaultServerConfiguration::the_prompt_connector()
             {
                 return std::make_shared<mf::BasicConnector>(
                     the_prompt_connection_creator(),
+                    1,
                     the_connector_report());
             }
         });
@@ -27,6 +27,9 @@
 
 #include "mir_protobuf_wire.pb.h"
 
+#include <array>
+#include <functional>
+
 namespace mfd = mir::frontend::detail;
 
 namespace
@@ -176,7 +179,14 @@ void invoke(
 
 const std::string& mfd::Invocation::method_name() const
 {
-    return invocation.method_name();
+    return protobuf::method_name_of(invocation);
+}
+
+mir::protobuf::MethodId mfd::Invocation::method_id() const
+{
+    return invocation.has_method_id() ?
+        static_cast<protobuf::MethodId>(invocation.method_id()) :
+        protobuf::method_id(invocation.method_name());
 }
 
 const std::string& mfd::Invocation::parameters() const
@@ -198,163 +208,128 @@ bool mfd::ProtobufMessageProcessor::dispatch(
     Invocation const& invocation,
     std::vector<mir::Fd> const& side_channel_fds)
 {
+    using protobuf::MethodId;
+
+    // Returns whether the connection should be kept open
+    using Handler = std::function<bool(
+        ProtobufMessageProcessor& self,
+        Invocation const& invocation,
+        std::vector<mir::Fd> const& side_channel_fds)>;
+
+    // Indexed by MethodId, so finding the handler doesn't compare any strings
+    static auto const handlers = []
+        {
+            auto const call = [](auto function) -> Handler
+                {
+                    return [function](ProtobufMessageProcessor& self, Invocation const& invocation,
+                                      std::vector<mir::Fd> const&)
+                        {
+                            invoke(&self, self.display_server.get(), function, invocation);
+                            return true;
+                        };
+                };
+
+            std::array<Handler, static_cast<size_t>(MethodId::count)> handlers;
+            auto const handle = [&handlers](MethodId id, Handler const& handler)
+                {
+                    handlers[static_cast<size_t>(id)] = handler;
+                };
+
+            handle(MethodId::connect, call(&DisplayServer::connect));
+            handle(MethodId::create_surface, call(&DisplayServer::create_surface));
+            handle(MethodId::submit_buffer,
+                [](ProtobufMessageProcessor& self, Invocation const& invocation,
+                   std::vector<mir::Fd> const& side_channel_fds)
+                {
+                    auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
+                    request.mutable_buffer()->clear_fd();
+                    for (auto& fd : side_channel_fds)
+                        request.mutable_buffer()->add_fd(fd);
+                    invoke(self.shared_from_this(), self.display_server.get(), &DisplayServer::submit_buffer,
+                           invocation.id(), &request);
+                    return true;
+                });
+            handle(MethodId::allocate_buffers, call(&DisplayServer::allocate_buffers));
+            handle(MethodId::release_buffers, call(&DisplayServer::release_buffers));
+            handle(MethodId::release_surface, call(&DisplayServer::release_surface));
+            handle(MethodId::platform_operation,
+                [](ProtobufMessageProcessor& self, Invocation const& invocation,
+                   std::vector<mir::Fd> const& side_channel_fds)
+                {
+                    auto request = parse_parameter<mir::protobuf::PlatformOperationMessage>(invocation);
+
+                    request.clear_fd();
+                    for (auto& fd : side_channel_fds)
+                        request.add_fd(fd);
+
+                    invoke(self.shared_from_this(), self.display_server.get(), &DisplayServer::platform_operation,
+                           invocation.id(), &request);
+                    return true;
+                });
+            handle(MethodId::configure_display, call(&DisplayServer::configure_display));
+            handle(MethodId::remove_session_configuration, call(&DisplayServer::remove_session_configuration));
+            handle(MethodId::set_base_display_configuration, call(&DisplayServer::set_base_display_configuration));
+            handle(MethodId::configure_surface, call(&DisplayServer::configure_surface));
+            handle(MethodId::modify_surface, call(&DisplayServer::modify_surface));
+            handle(MethodId::create_screencast, call(&DisplayServer::create_screencast));
+            handle(MethodId::screencast_buffer, call(&DisplayServer::screencast_buffer));
+            handle(MethodId::screencast_to_buffer, call(&DisplayServer::screencast_to_buffer));
+            handle(MethodId::release_screencast, call(&DisplayServer::release_screencast));
+            handle(MethodId::create_buffer_stream, call(&DisplayServer::create_buffer_stream));
+            handle(MethodId::release_buffer_stream, call(&DisplayServer::release_buffer_stream));
+            handle(MethodId::configure_cursor, call(&protobuf::DisplayServer::configure_cursor));
+            handle(MethodId::new_fds_for_prompt_providers, call(&protobuf::DisplayServer::new_fds_for_prompt_providers));
+            handle(MethodId::start_prompt_session, call(&protobuf::DisplayServer::start_prompt_session));
+            handle(MethodId::stop_prompt_session, call(&protobuf::DisplayServer::stop_prompt_session));
+            handle(MethodId::disconnect,
+                [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+                {
+                    invoke(&self, self.display_server.get(), &DisplayServer::disconnect, invocation);
+                    return false;
+                });
+            handle(MethodId::pong, call(&DisplayServer::pong));
+            handle(MethodId::configure_buffer_stream, call(&DisplayServer::configure_buffer_stream));
+            handle(MethodId::raise_surface, call(&DisplayServer::raise_surface));
+            handle(MethodId::translate_surface_to_screen,
+                [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+                {
+                    try
+                    {
+                        auto debug_interface = dynamic_cast<mir::protobuf::DisplayServerDebug*>(self.display_server.get());
+                        invoke(&self, debug_interface, &mir::protobuf::DisplayServerDebug::translate_surface_to_screen, invocation);
+                    }
+                    catch (std::runtime_error const&)
+                    {
+                        std::string message{"Server does not support the client debugging interface"};
+                        invoke(&self,
+                               &message,
+                               &mir::protobuf::DisplayServerDebug::translate_surface_to_screen,
+                               invocation);
+                        std::runtime_error err{"Client attempted to use unavailable debug interface"};
+                        self.report->exception_handled(self.display_server.get(), invocation.id(), err);
+                    }
+                    return true;
+                });
+            handle(MethodId::request_persistent_surface_id, call(&protobuf::DisplayServer::request_persistent_surface_id));
+            handle(MethodId::preview_base_display_configuration, call(&protobuf::DisplayServer::preview_base_display_configuration));
+            handle(MethodId::confirm_base_display_configuration, call(&protobuf::DisplayServer::confirm_base_display_configuration));
+            handle(MethodId::cancel_base_display_configuration_preview,
+                   call(&protobuf::DisplayServer::cancel_base_display_configuration_preview));
+
+            return handlers;
+        }();
+
     report->received_invocation(display_server.get(), invocation.id(), invocation.method_name());
 
     bool result = true;
 
     try
     {
-        // TODO comparing strings in an if-else chain isn't efficient.
-        // It is probably possible to generate a Trie at compile time.
-        if ("connect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::connect, invocation);
-        }
-        else if ("create_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_surface, invocation);
-        }
-        else if ("submit_buffer" == invocation.method_name())
-        {
-            auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
-            request.mutable_buffer()->clear_fd();
-            for (auto& fd : side_channel_fds)
-                request.mutable_buffer()->add_fd(fd);
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
-        }
-        else if ("allocate_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::allocate_buffers, invocation);
-        }
-        else if ("release_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffers, invocation);
-        }
-        else if ("release_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_surface, invocation);
-        }
-        else if ("platform_operation" == invocation.method_name())
-        {
-            auto request = parse_parameter<mir::protobuf::PlatformOperationMessage>(invocation);
-
-            request.clear_fd();
-            for (auto& fd : side_channel_fds)
-                request.add_fd(fd);
+        auto const id = static_cast<size_t>(invocation.method_id());
 
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::platform_operation,
-                   invocation.id(), &request);
-        }
-        else if ("configure_display" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_display, invocation);
-        }
-        else if ("remove_session_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::remove_session_configuration, invocation);
-        }
-        else if ("set_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::set_base_display_configuration, invocation);
-        }
-        else if ("configure_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_surface, invocation);
-        }
-        else if ("modify_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::modify_surface, invocation);
-        }
-        else if ("create_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_screencast, invocation);
-        }
-        else if ("screencast_buffer" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::screencast_buffer, invocation);
-        }
-        else if ("screencast_to_buffer" == invocation.method_name())
+        if (id < handlers.size() && handlers[id])
         {
-            invoke(this, display_server.get(), &DisplayServer::screencast_to_buffer, invocation);
-        }
-        else if ("release_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_screencast, invocation);
-        }
-        else if ("create_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_buffer_stream, invocation);
-        }
-        else if ("release_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffer_stream, invocation);
-        }
-        else if ("configure_cursor" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::configure_cursor, invocation);
-        }
-        else if ("new_fds_for_prompt_providers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::new_fds_for_prompt_providers, invocation);
-        }
-        else if ("start_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::start_prompt_session, invocation);
-        }
-        else if ("stop_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::stop_prompt_session, invocation);
-        }
-        else if ("disconnect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::disconnect, invocation);
-            result = false;
-        }
-        else if ("pong" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::pong, invocation);
-        }
-        else if ("configure_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_buffer_stream, invocation);
-        }
-        else if ("raise_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::raise_surface, invocation);
-        }
-        else if ("translate_surface_to_screen" == invocation.method_name())
-        {
-            try
-            {
-                auto debug_interface = dynamic_cast<mir::protobuf::DisplayServerDebug*>(display_server.get());
-                invoke(this, debug_interface, &mir::protobuf::DisplayServerDebug::translate_surface_to_screen, invocation);
-            }
-            catch (std::runtime_error const&)
-            {
-                std::string message{"Server does not support the client debugging interface"};
-                invoke(this,
-                       &message,
-                       &mir::protobuf::DisplayServerDebug::translate_surface_to_screen,
-                       invocation);
-                std::runtime_error err{"Client attempted to use unavailable debug interface"};
-                report->exception_handled(display_server.get(), invocation.id(), err);
-            }
-        }
-        else if ("request_persistent_surface_id" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::request_persistent_surface_id, invocation);
-        }
-        else if ("preview_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::preview_base_display_configuration, invocation);
-        }
-        else if ("confirm_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::confirm_base_display_configuration, invocation);
-        }
-        else if ("cancel_base_display_configuration_preview" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::cancel_base_display_configuration_preview, invocation);
+            result = handlers[id](*this, invocation, side_channel_fds);
         }
         else
         {
@@ -390,6 +365,8 @@ void mfd::ProtobufMessageProcessor::send_response(::google::protobuf::uint32 id,
 
 void mfd::ProtobufMessageProcessor::send_response(::google::protobuf::uint32 id, mir::protobuf::Connection* response)
 {
+    response->set_method_ids_accepted(true);
+
     if (response->has_platform())
         sender->send_response(id, response, {extract_fds_from(response->mutable_platform())});
     else
@@ -30,6 +30,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 
@@ -100,9 +101,10 @@ std::string remove_if_stale(std::string const& socket_name)
 mf::PublishedSocketConnector::PublishedSocketConnector(
     const std::string& socket_file,
     std::shared_ptr<ConnectionCreator> const& connection_creator,
+    int threads,
     EmergencyCleanupRegistry& emergency_cleanup_registry,
     std::shared_ptr<ConnectorReport> const& report)
-:   BasicConnector(connection_creator, report),
+:   BasicConnector(connection_creator, threads, report),
     socket_file(remove_if_stale(socket_file)),
     acceptor(io_service, socket_file)
 {
@@ -143,9 +145,11 @@ void mf::PublishedSocketConnector::on_new_connection(
 
 mf::BasicConnector::BasicConnector(
     std::shared_ptr<ConnectionCreator> const& connection_creator,
+    int threads,
     std::shared_ptr<ConnectorReport> const& report)
 :   work(io_service),
     report(report),
+    threads{std::max(threads, 1)},
     connection_creator{connection_creator}
 {
 }
@@ -169,7 +173,8 @@ void mf::BasicConnector::start()
         }
     };
 
-    io_service_thread = std::thread(run_io_service);
+    for (int i = 0; i != threads; ++i)
+        io_service_threads.emplace_back(run_io_service);
 }
 
 void mf::BasicConnector::stop()
@@ -177,9 +182,10 @@ void mf::BasicConnector::stop()
     /* Stop processing new requests */
     io_service.stop();
 
-    /* Wait for io processing thread to finish */
-    if (io_service_thread.joinable())
-        io_service_thread.join();
+    /* Wait for io processing threads to finish */
+    for (auto& thread : io_service_threads)
+        thread.join();
+    io_service_threads.clear();
 
     /* Prepare for a potential restart */
     io_service.reset();
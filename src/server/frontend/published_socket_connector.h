@@ -24,6 +24,7 @@
 #include <boost/asio.hpp>
 
 #include <thread>
+#include <vector>
 #include <string>
 #include <functional>
 
@@ -48,8 +49,13 @@ class ConnectorReport;
 class BasicConnector : public Connector
 {
 public:
+    /**
+     * Requests are handled on \a threads threads, those of any one
+     * connection still being handled in order.
+     */
     explicit BasicConnector(
         std::shared_ptr<ConnectionCreator> const& connection_creator,
+        int threads,
         std::shared_ptr<ConnectorReport> const& report);
     ~BasicConnector() noexcept;
     void start() override;
@@ -67,7 +73,8 @@ protected:
     std::shared_ptr<ConnectorReport> const report;
 
 private:
-    std::thread io_service_thread;
+    int const threads;
+    std::vector<std::thread> io_service_threads;
     std::shared_ptr<ConnectionCreator> const connection_creator;
 };
 
@@ -78,6 +85,7 @@ public:
     explicit PublishedSocketConnector(
         const std::string& socket_file,
         std::shared_ptr<ConnectionCreator> const& connection_creator,
+        int threads,
         EmergencyCleanupRegistry& emergency_cleanup_registry,
         std::shared_ptr<ConnectorReport> const& report);
     ~PublishedSocketConnector() noexcept;
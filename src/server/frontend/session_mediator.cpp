@@ -38,6 +38,7 @@
 #include "mir/geometry/dimensions.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/pixel_format_utils.h"
+#include "mir/frame_timeline.h"
 #include "mir/graphics/platform_ipc_operations.h"
 #include "mir/graphics/platform_ipc_package.h"
 #include "mir/graphics/platform_operation_message.h"
@@ -368,7 +369,11 @@ void mf::SessionMediator::create_surface(
     response->set_buffer_usage(request->buffer_usage());
 
     if (surface->supports_input())
+    {
         response->add_fd(surface->client_input_fd());
+        for (auto fd : surface->client_input_ring_fds())
+            response->add_fd(fd);
+    }
     
     for (unsigned int i = 0; i < mir_window_attribs; i++)
     {
@@ -403,12 +408,24 @@ void mf::SessionMediator::submit_buffer(
     mf::BufferStreamId const stream_id{request->id().value()};
     mg::BufferID const buffer_id{static_cast<uint32_t>(request->buffer().buffer_id())};
     auto stream = session->get_buffer_stream(stream_id);
+    FrameTimeline::Span const span{
+        FrameTimeline::Stage::submit_received, dynamic_cast<void const*>(stream.get()), buffer_id.as_value()};
 
     mfd::ProtobufBufferPacker request_msg{const_cast<mir::protobuf::Buffer*>(&request->buffer())};
     auto b = session->get_buffer(buffer_id);
     ipc_operations->unpack_buffer(request_msg, *b);
 
-    stream->submit_buffer(b);
+    if (request->damage_size() > 0)
+    {
+        geom::Rectangles damage;
+        for (auto const& rect : request->damage())
+            damage.add({{rect.left(), rect.top()}, {rect.width(), rect.height()}});
+        stream->submit_buffer(b, damage);
+    }
+    else
+    {
+        stream->submit_buffer(b);
+    }
 
     done->Run();
 }
@@ -17,15 +17,16 @@
  */
 
 #include "socket_messenger.h"
-#include "mir/frontend/client_constants.h"
 #include "mir/variable_length_array.h"
 #include "mir/fd_socket_transmission.h"
 #include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
+#include <boost/exception/errinfo_errno.hpp>
 
 #include <errno.h>
 #include <string.h>
+#include <sys/socket.h>
 
 #include <stdexcept>
 
@@ -34,15 +35,76 @@ namespace mfd = mf::detail;
 namespace bs = boost::system;
 namespace ba = boost::asio;
 
+namespace
+{
+size_t const header_size{2};
+
+// Beyond this we give up on the client ever reading what we send it
+size_t const max_pending_bytes{4*1024*1024};
+
+// Sends as much of iov as the socket will take right now
+size_t send_some(int socket, iovec* iov, size_t iov_count, msghdr header = msghdr{})
+{
+    header.msg_iov = iov;
+    header.msg_iovlen = iov_count;
+
+    for (;;)
+    {
+        auto const sent = sendmsg(socket, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (sent >= 0)
+            return sent;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        if (!mir::socket_error_is_transient(errno))
+            BOOST_THROW_EXCEPTION(
+                boost::enable_error_info(mir::socket_error("Failed to send message to client"))
+                    << boost::errinfo_errno(errno));
+    }
+}
+
+// Sends fds the way mir::send_fds() does, unless the socket is full
+bool try_send_fds(int socket, std::vector<mir::Fd> const& fds)
+{
+    if (fds.empty())
+        return true;
+
+    char dummy_iov_data = 'M';
+    iovec iov{&dummy_iov_data, 1};
+
+    static auto const builtin_n_fds = 5;
+    static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
+    auto const fds_bytes = fds.size() * sizeof(int);
+    mir::VariableLengthArray<builtin_cmsg_space> control{CMSG_SPACE(fds_bytes)};
+    memset(control.data(), 0, control.size());
+
+    msghdr header{};
+    header.msg_control = control.data();
+    header.msg_controllen = control.size();
+
+    auto const message = CMSG_FIRSTHDR(&header);
+    message->cmsg_len = CMSG_LEN(fds_bytes);
+    message->cmsg_level = SOL_SOCKET;
+    message->cmsg_type = SCM_RIGHTS;
+
+    auto data = reinterpret_cast<int*>(CMSG_DATA(message));
+    for (auto const& fd : fds)
+        *data++ = fd;
+
+    // A single byte is either sent along with the fds, or neither are
+    return send_some(socket, &iov, 1, header) == 1;
+}
+}
+
 mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
     : socket(socket),
-      socket_fd{IntOwnedFd{socket->native_handle()}}
+      socket_fd{IntOwnedFd{socket->native_handle()}},
+      strand{socket->get_io_service()}
 {
     // Make the socket non-blocking to avoid hanging the server when a client
-    // is unresponsive. Also increase the send buffer size to 64KiB to allow
-    // more leeway for transient client freezes.
+    // is unresponsive. Also increase the send buffer size to 64KiB so that
+    // transient client freezes rarely need the pending message queue.
     // See https://bugs.launchpad.net/mir/+bug/1350207
-    // TODO: Rework the messenger to support asynchronous sends
     socket->non_blocking(true);
     boost::asio::socket_base::send_buffer_size option(64*1024);
     socket->set_option(option);
@@ -73,24 +135,123 @@ mf::SessionCredentials mfd::SocketMessenger::client_creds()
 
 void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_set)
 {
-    static size_t const header_size{2};
-    mir::VariableLengthArray<mf::serialization_buffer_size> whole_message{header_size + length};
+    char header[header_size] = {
+        static_cast<char>((length >> 8) & 0xff),
+        static_cast<char>((length >> 0) & 0xff)};
+    size_t const message_size{header_size + length};
+
+    std::lock_guard<std::mutex> lg(message_lock);
+
+    size_t data_sent{0};
+    size_t fd_sets_sent{0};
+
+    // Usually the socket has room, and the message is written with no
+    // copying. Otherwise it has to wait behind those already waiting.
+    if (pending_messages.empty())
+    {
+        iovec iov[] = {{header, header_size}, {const_cast<char*>(data), length}};
+        data_sent = send_some(socket_fd, iov, 2);
+
+        if (data_sent == message_size)
+        {
+            while (fd_sets_sent != fd_set.size() && try_send_fds(socket_fd, fd_set[fd_sets_sent]))
+                ++fd_sets_sent;
+
+            if (fd_sets_sent == fd_set.size())
+                return;
+        }
+    }
+
+    if (pending_bytes + message_size - data_sent > max_pending_bytes)
+    {
+        pending_messages.clear();
+        pending_bytes = 0;
+
+        // Let the connection see the client off in the usual way
+        bs::error_code ignored;
+        socket->shutdown(ba::socket_base::shutdown_both, ignored);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Client is not reading the messages sent to it"));
+    }
+
+    PendingMessage pending{std::vector<char>(header, header + header_size), 0, {}, fd_sets_sent};
+    pending.data.insert(pending.data.end(), data, data + length);
+    pending.data_sent = data_sent;
+    pending.fds = fd_set;
+    pending_bytes += message_size - data_sent;
+    pending_messages.push_back(std::move(pending));
+
+    if (!waiting_until_writable)
+        wait_until_writable();
+}
+
+bool mfd::SocketMessenger::send_pending_messages()
+{
+    while (!pending_messages.empty())
+    {
+        auto& message = pending_messages.front();
+
+        while (message.data_sent != message.data.size())
+        {
+            iovec iov{message.data.data() + message.data_sent, message.data.size() - message.data_sent};
+            auto const sent = send_some(socket_fd, &iov, 1);
+            if (!sent)
+                return false;
 
-    whole_message.data()[0] = static_cast<unsigned char>((length >> 8) & 0xff);
-    whole_message.data()[1] = static_cast<unsigned char>((length >> 0) & 0xff);
-    std::copy(data, data + length, whole_message.data() + header_size);
+            message.data_sent += sent;
+            pending_bytes -= sent;
+        }
 
-    std::unique_lock<std::mutex> lg(message_lock);
+        while (message.fd_sets_sent != message.fds.size())
+        {
+            if (!try_send_fds(socket_fd, message.fds[message.fd_sets_sent]))
+                return false;
+
+            ++message.fd_sets_sent;
+        }
+
+        pending_messages.pop_front();
+    }
 
-    // TODO: This should be asynchronous, but we are not making sure
-    // that a potential call to send_fds is executed _after_ this
-    // function has completed (if it would be executed asynchronously.
-    // NOTE: we rely on this synchronous behavior as per the comment in
-    // mf::SessionMediator::create_surface
-    ba::write(*socket, ba::buffer(whole_message.data(), whole_message.size()));
+    return true;
+}
+
+void mfd::SocketMessenger::wait_until_writable()
+{
+    waiting_until_writable = true;
+
+    std::weak_ptr<SocketMessenger> const weak_self = shared_from_this();
+    socket->async_send(
+        ba::null_buffers(),
+        [weak_self](bs::error_code const& error, size_t)
+        {
+            if (auto const self = weak_self.lock())
+                self->on_writable(error);
+        });
+}
+
+void mfd::SocketMessenger::on_writable(bs::error_code const& error)
+{
+    std::lock_guard<std::mutex> lg(message_lock);
+
+    waiting_until_writable = false;
+
+    try
+    {
+        if (!error && !send_pending_messages())
+        {
+            wait_until_writable();
+            return;
+        }
+    }
+    catch (std::exception const&)
+    {
+        // The client has gone. Reading from the socket will find that out
+        // and close the connection.
+    }
 
-    for (auto const& fds : fd_set)
-        mir::send_fds(socket_fd, fds);
+    // Either everything has been sent or it never will be
+    pending_messages.clear();
+    pending_bytes = 0;
 }
 
 void mfd::SocketMessenger::async_receive_msg(
@@ -101,7 +262,7 @@ void mfd::SocketMessenger::async_receive_msg(
          *socket,
          buffer,
          boost::asio::transfer_exactly(ba::buffer_size(buffer)),
-         handler);
+         strand.wrap(handler));
 }
 
 bs::error_code mfd::SocketMessenger::receive_msg(
@@ -21,7 +21,11 @@
 #include "message_sender.h"
 #include "message_receiver.h"
 #include "mir/frontend/session_credentials.h"
+
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -29,8 +33,17 @@ namespace frontend
 {
 namespace detail
 {
+/**
+ * Sends and receives messages over a client's socket.
+ *
+ * Sending never blocks: whatever the socket can't take straight away is
+ * queued and written when the client catches up. A client that lets its
+ * queue grow past a limit is disconnected, as dropping messages (and the
+ * buffers they may hand back) would leave it in an unknown state.
+ */
 class SocketMessenger : public MessageSender,
-                        public MessageReceiver
+                        public MessageReceiver,
+                        public std::enable_shared_from_this<SocketMessenger>
 {
 public:
     SocketMessenger(std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket);
@@ -48,10 +61,30 @@ private:
     void update_session_creds();
     SessionCredentials creator_creds() const;
 
+    // What's left of a message the socket couldn't take
+    struct PendingMessage
+    {
+        std::vector<char> data;
+        size_t data_sent;
+        FdSets fds;
+        size_t fd_sets_sent;
+    };
+
+    bool send_pending_messages();
+    void wait_until_writable();
+    void on_writable(boost::system::error_code const& error);
+
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
+    // The io_service may be run by several threads, but a connection's
+    // messages must still be handled one at a time and in order
+    boost::asio::io_service::strand strand;
 
     std::mutex message_lock;
+    std::deque<PendingMessage> pending_messages;
+    size_t pending_bytes{0};
+    bool waiting_until_writable{false};
+
     SessionCredentials session_creds{0, 0, 0};
 };
 }
@@ -36,6 +36,7 @@
 
 #include "mir/shared_library.h"
 #include "mir/shared_library_prober.h"
+#include "mir/module_probe_cache.h"
 #include "mir/abnormal_exit.h"
 #include "mir/emergency_cleanup.h"
 #include "mir/log.h"
@@ -98,6 +99,15 @@ std::shared_ptr<mg::Platform> mir::DefaultServerConfiguration::the_graphics_plat
                 {
                     platform_library = std::make_shared<mir::SharedLibrary>(the_options()->get<std::string>(options::platform_graphics_lib));
                 }
+                else if (the_options()->is_set(options::platform_probe_cache))
+                {
+                    mir::ModuleProbeCache cache{the_options()->get<std::string>(options::platform_probe_cache)};
+                    platform_library = mir::graphics::module_for_device(
+                        the_options()->get<std::string>(options::platform_path),
+                        dynamic_cast<mir::options::ProgramOption&>(*the_options()),
+                        *the_shared_library_prober_report(),
+                        cache);
+                }
                 else
                 {
                     auto const& path = the_options()->get<std::string>(options::platform_path);
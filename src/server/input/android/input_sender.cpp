@@ -20,10 +20,12 @@
 
 #include "mir/input/android/event_conversion_helpers.h"
 #include "mir/input/input_channel.h"
+#include "mir/input/input_ring.h"
 #include "mir/input/input_report.h"
 #include "mir/scene/surface.h"
 #include "mir/compositor/scene.h"
 #include "mir/main_loop.h"
+#include "mir/events/event_builders.h"
 
 #include <boost/exception/errinfo_errno.hpp>
 #include <boost/throw_exception.hpp>
@@ -34,6 +36,7 @@
 
 namespace mi = mir::input;
 namespace mia = mi::android;
+namespace mev = mir::events;
 
 namespace droidinput = android;
 
@@ -52,6 +55,103 @@ mir::cookie::Blob convert_cookie_to_blob(std::vector<uint8_t> const& cookie)
 
     return cookie_blob;
 }
+
+std::shared_ptr<mi::InputRing> ring_of(mi::InputChannel const& channel)
+{
+    if (channel.ring_fd() < 0)
+        return nullptr;
+
+    // The channel owns the fds, and outlives the transfer
+    return std::make_shared<mi::InputRing>(
+        mir::Fd{mir::IntOwnedFd{channel.ring_fd()}},
+        mir::Fd{mir::IntOwnedFd{channel.ring_wakeup_fd()}});
+}
+
+// Deep enough to ride out a slow frame; beyond it motion is too stale to be worth sending
+size_t const max_pending_motion{64};
+// A client this far behind is not reading its input at all. Beyond it the oldest events
+// go, whatever they are, so that the server does not hold on to its input without limit
+size_t const max_pending_events{1024};
+
+bool is_motion(MirEvent const& event)
+{
+    if (event.type() != mir_event_type_input)
+        return false;
+
+    auto const input = event.to_input();
+    switch (input->input_type())
+    {
+    case mir_input_event_type_pointer:
+        return input->to_pointer()->action() == mir_pointer_action_motion;
+    case mir_input_event_type_touch:
+    {
+        auto const touch = input->to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            if (touch->action(i) != mir_touch_action_change)
+                return false;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+/*
+ * Folds a motion event into the queued motion event before it, if nothing
+ * but their positions differ. Relative motion accumulates; all else is the
+ * newer event's.
+ */
+bool coalesce(MirEvent& queued, MirEvent const& event)
+{
+    if (!is_motion(queued) || !is_motion(event))
+        return false;
+
+    auto const queued_input = queued.to_input();
+    auto const input = event.to_input();
+
+    if (queued_input->input_type() != input->input_type() ||
+        queued_input->device_id() != input->device_id() ||
+        queued_input->modifiers() != input->modifiers())
+        return false;
+
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const queued_pointer = queued_input->to_pointer();
+        auto const pointer = input->to_pointer();
+
+        if (queued_pointer->buttons() != pointer->buttons())
+            return false;
+
+        auto const dx = queued_pointer->dx() + pointer->dx();
+        auto const dy = queued_pointer->dy() + pointer->dy();
+        auto const vscroll = queued_pointer->vscroll() + pointer->vscroll();
+        auto const hscroll = queued_pointer->hscroll() + pointer->hscroll();
+
+        queued = event;
+        queued_pointer->set_dx(dx);
+        queued_pointer->set_dy(dy);
+        queued_pointer->set_vscroll(vscroll);
+        queued_pointer->set_hscroll(hscroll);
+        return true;
+    }
+
+    auto const queued_touch = queued_input->to_touch();
+    auto const touch = input->to_touch();
+
+    if (queued_touch->pointer_count() != touch->pointer_count())
+        return false;
+
+    for (size_t i = 0; i != touch->pointer_count(); ++i)
+    {
+        if (queued_touch->id(i) != touch->id(i))
+            return false;
+    }
+
+    queued = event;
+    return true;
+}
 }
 
 mia::InputSender::InputSender(std::shared_ptr<mir::compositor::Scene> const& scene,
@@ -171,7 +271,8 @@ uint32_t mia::InputSender::InputSenderState::next_seq()
 mia::InputSender::ActiveTransfer::ActiveTransfer(InputSenderState & state, std::shared_ptr<InputChannel> const& channel, mi::Surface* surface) :
     state(state),
     publisher{droidinput::sp<droidinput::InputChannel>(
-            new droidinput::InputChannel(droidinput::String8(surface->name()), channel->server_fd()))},
+            new droidinput::InputChannel(
+                droidinput::String8(surface->name()), channel->server_fd(), ring_of(*channel)))},
     surface{surface},
     channel{channel}
 {
@@ -184,42 +285,28 @@ void mia::InputSender::ActiveTransfer::send(uint32_t sequence_id, MirEvent const
     if (type != mir_event_type_input_device_state && type != mir_event_type_input)
         return;
 
-    droidinput::status_t error_status;
+    std::lock_guard<std::mutex> lock{publisher_mutex};
 
-    if (type == mir_event_type_input)
-    {
-        auto event_time = mir_input_event_get_event_time(mir_event_get_input_event(&event));
-        auto input_event = mir_event_get_input_event(&event);
-        switch(mir_input_event_get_type(input_event))
-        {
-        case mir_input_event_type_key:
-            error_status = send_key_event(sequence_id, event);
-            state.report->published_key_event(channel->server_fd(), sequence_id, event_time);
-            break;
-        case mir_input_event_type_touch:
-            error_status = send_touch_event(sequence_id, event);
-            state.report->published_motion_event(channel->server_fd(), sequence_id, event_time);
-            break;
-        case mir_input_event_type_pointer:
-            error_status = send_pointer_event(sequence_id, event);
-            state.report->published_motion_event(channel->server_fd(), sequence_id, event_time);
-            break;
-        default:
-            BOOST_THROW_EXCEPTION(std::runtime_error("unknown input event type"));
-        }
-    }
-    else
+    // Whatever is already waiting must reach the client first
+    if (!pending.empty())
     {
-        error_status = publisher.publishEventBuffer(sequence_id, MirEvent::serialize(&event));
+        defer(sequence_id, event, 0);
+        return;
     }
 
+    size_t messages_published{0};
+    auto const error_status = publish(sequence_id, event, messages_published);
+
     switch(error_status)
     {
     case droidinput::OK:
         subscribe();
         break;
     case droidinput::WOULD_BLOCK:
-        // Not an error. Clients are allowed to ignore input.
+        // Not an error. Clients are allowed to ignore input; those that don't
+        // get what didn't fit once they have finished with what did.
+        defer(sequence_id, event, messages_published);
+        subscribe();
         break;
     case droidinput::DEAD_OBJECT:
         // XXX This throw was recently added but is missing tests:
@@ -230,6 +317,84 @@ void mia::InputSender::ActiveTransfer::send(uint32_t sequence_id, MirEvent const
     }
 }
 
+droidinput::status_t mia::InputSender::ActiveTransfer::publish(
+    uint32_t sequence_id, MirEvent const& event, size_t& messages_published)
+{
+    if (mir_event_get_type(&event) != mir_event_type_input)
+        return publisher.publishEventBuffer(sequence_id, MirEvent::serialize(&event));
+
+    droidinput::status_t error_status;
+    auto const input_event = mir_event_get_input_event(&event);
+    auto const event_time = mir_input_event_get_event_time(input_event);
+
+    switch(mir_input_event_get_type(input_event))
+    {
+    case mir_input_event_type_key:
+        error_status = send_key_event(sequence_id, event);
+        if (error_status == droidinput::OK)
+            state.report->published_key_event(channel->server_fd(), sequence_id, event_time);
+        break;
+    case mir_input_event_type_touch:
+        error_status = send_touch_event(sequence_id, event, messages_published);
+        if (error_status == droidinput::OK)
+            state.report->published_motion_event(channel->server_fd(), sequence_id, event_time);
+        break;
+    case mir_input_event_type_pointer:
+        error_status = send_pointer_event(sequence_id, event);
+        if (error_status == droidinput::OK)
+            state.report->published_motion_event(channel->server_fd(), sequence_id, event_time);
+        break;
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error("unknown input event type"));
+    }
+
+    return error_status;
+}
+
+void mia::InputSender::ActiveTransfer::defer(uint32_t sequence_id, MirEvent const& event, size_t messages_published)
+{
+    auto const fd = channel->server_fd();
+
+    if (!pending.empty() &&
+        pending.back().messages_published == 0 &&
+        coalesce(*pending.back().event, event))
+    {
+        pending.back().sequence_id = sequence_id;
+        state.report->coalesced_motion_event(fd, sequence_id);
+        return;
+    }
+
+    // A slow client only loses motion
+    if (pending.size() >= max_pending_motion && is_motion(event))
+    {
+        auto const oldest_motion = std::find_if(pending.begin(), pending.end(),
+            [](PendingEvent const& p) { return p.messages_published == 0 && is_motion(*p.event); });
+
+        if (oldest_motion == pending.end())
+        {
+            state.report->dropped_motion_event(fd, sequence_id);
+            return;
+        }
+
+        state.report->dropped_motion_event(fd, oldest_motion->sequence_id);
+        pending.erase(oldest_motion);
+    }
+
+    // ...but one that has stopped reading loses its oldest input of any kind. An event that
+    // is partly published has to be finished, so it is the one after it that goes.
+    if (pending.size() >= max_pending_events)
+    {
+        auto const oldest = pending.front().messages_published == 0 ?
+            pending.begin() : std::next(pending.begin());
+
+        state.report->dropped_input_event(fd, oldest->sequence_id);
+        pending.erase(oldest);
+    }
+
+    pending.push_back(PendingEvent{sequence_id, mev::clone_event(event), messages_published});
+    state.report->deferred_input_event(fd, sequence_id, pending.size());
+}
+
 mia::InputSender::ActiveTransfer::~ActiveTransfer()
 {
     unsubscribe();
@@ -277,7 +442,8 @@ droidinput::status_t mia::InputSender::ActiveTransfer::send_key_event(uint32_t s
                                      event_time);
 }
 
-droidinput::status_t mia::InputSender::ActiveTransfer::send_touch_event(uint32_t seq, MirEvent const& event)
+droidinput::status_t mia::InputSender::ActiveTransfer::send_touch_event(
+    uint32_t seq, MirEvent const& event, size_t& messages_published)
 {
     droidinput::status_t ret = droidinput::OK;
     droidinput::PointerCoords coords[mir::capnp::TouchScreenEvent::MAX_COUNT];
@@ -312,8 +478,10 @@ droidinput::status_t mia::InputSender::ActiveTransfer::send_touch_event(uint32_t
     if (state_changes.empty())
         state_changes.push_back(StateChange{AMOTION_EVENT_ACTION_MOVE, 0});
 
-    for (auto state_change : state_changes)
+    // Resumes where the last attempt ran out of room in the channel
+    for (auto change = messages_published; change < state_changes.size(); ++change)
     {
+        auto state_change = state_changes[change];
         std::memset(&coords, 0, sizeof(coords));
         std::memset(&properties, 0, sizeof(properties));
 
@@ -352,6 +520,10 @@ droidinput::status_t mia::InputSender::ActiveTransfer::send_touch_event(uint32_t
                                            button_state, x_offset, y_offset, x_precision, y_precision,
                                            convert_cookie_to_blob(event.to_input()->cookie()),
                                            event_time, event_time, contacts_in_event, properties, coords);
+        if (ret != droidinput::OK)
+            break;
+
+        ++messages_published;
     }
 
     return ret;
@@ -397,7 +569,28 @@ void mia::InputSender::ActiveTransfer::on_finish_signal()
     uint32_t sequence;
     bool handled;
 
+    std::lock_guard<std::mutex> lock{publisher_mutex};
+
     while(droidinput::OK == publisher.receiveFinishedSignal(&sequence, &handled));
+
+    // The client has made room; send it what it missed, oldest first
+    while (!pending.empty())
+    {
+        auto& next = pending.front();
+        auto const error_status = publish(next.sequence_id, *next.event, next.messages_published);
+
+        if (error_status == droidinput::WOULD_BLOCK)
+            break;
+
+        if (error_status != droidinput::OK)
+        {
+            // The channel is dead or broken: there is no one left to send to
+            pending.clear();
+            break;
+        }
+
+        pending.pop_front();
+    }
 }
 
 bool mia::InputSender::ActiveTransfer::used_for_surface(input::Surface const* surface) const
@@ -30,6 +30,7 @@
 #include <unordered_map>
 #include <mutex>
 #include <vector>
+#include <deque>
 #include <atomic>
 
 namespace droidinput = android;
@@ -89,9 +90,19 @@ private:
         void unsubscribe();
 
     private:
+        /// An event the client's channel had no room for
+        struct PendingEvent
+        {
+            uint32_t sequence_id;
+            EventUPtr event;
+            size_t messages_published; ///< A touch event can take several messages
+        };
+
         void on_finish_signal();
+        droidinput::status_t publish(uint32_t sequence_id, MirEvent const& event, size_t& messages_published);
+        void defer(uint32_t sequence_id, MirEvent const& event, size_t messages_published);
         droidinput::status_t send_key_event(uint32_t sequence_id, MirEvent const& event);
-        droidinput::status_t send_touch_event(uint32_t sequence_id, MirEvent const& event);
+        droidinput::status_t send_touch_event(uint32_t sequence_id, MirEvent const& event, size_t& messages_published);
         droidinput::status_t send_pointer_event(uint32_t sequence_id, MirEvent const& event);
 
         InputSenderState & state;
@@ -100,6 +111,9 @@ private:
         std::shared_ptr<InputChannel> const channel;
         std::atomic<bool> subscribed{false};
 
+        std::mutex publisher_mutex; // Protects publisher and pending
+        std::deque<PendingEvent> pending;
+
         ActiveTransfer& operator=(ActiveTransfer const&) = delete;
         ActiveTransfer(ActiveTransfer const&) = delete;
     };
@@ -22,6 +22,9 @@
 #include <sys/socket.h>
 
 #include "channel.h"
+#include "mir/input/input_ring.h"
+
+#include <androidfw/InputTransport.h>
 
 #include <boost/throw_exception.hpp>
 
@@ -33,7 +36,8 @@ namespace
 int const buffer_size{32 * 1024};
 }
 
-mi::Channel::Channel()
+mi::Channel::Channel(size_t ring_records) :
+    ring{ring_records ? std::make_unique<InputRing>(ring_records, sizeof(android::InputMessage)) : nullptr}
 {
     int sockets[2];
     if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets)) {
@@ -52,6 +56,8 @@ mi::Channel::Channel()
     setsockopt(client_fd_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
 }
 
+mi::Channel::~Channel() = default;
+
 int mi::Channel::server_fd() const
 {
     return server_fd_;
@@ -61,3 +67,13 @@ int mi::Channel::client_fd() const
 {
     return client_fd_;
 }
+
+int mi::Channel::ring_fd() const
+{
+    return ring ? int{ring->shm_fd()} : -1;
+}
+
+int mi::Channel::ring_wakeup_fd() const
+{
+    return ring ? int{ring->wakeup_fd()} : -1;
+}
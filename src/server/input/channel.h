@@ -23,23 +23,30 @@
 #include "mir/fd.h"
 #include "mir/input/input_channel.h"
 
+#include <memory>
+
 namespace mir
 {
 namespace input
 {
+class InputRing;
 
 class Channel : public InputChannel
 {
 public:
-    Channel();
-    virtual ~Channel() override = default;
+    /// With \a ring_records > 0 the channel also has a ring of that many events
+    explicit Channel(size_t ring_records = 0);
+    virtual ~Channel() override;
 
     int client_fd() const override;
     int server_fd() const override;
+    int ring_fd() const override;
+    int ring_wakeup_fd() const override;
 
 private:
     Fd server_fd_;
     Fd client_fd_;
+    std::unique_ptr<InputRing> const ring;
 };
 
 }
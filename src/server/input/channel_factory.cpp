@@ -21,7 +21,12 @@
 
 namespace mi = mir::input;
 
+mi::ChannelFactory::ChannelFactory(size_t ring_records) :
+    ring_records{ring_records}
+{
+}
+
 std::shared_ptr<mi::InputChannel> mi::ChannelFactory::make_input_channel()
 {
-    return std::make_shared<mi::Channel>();
+    return std::make_shared<mi::Channel>(ring_records);
 }
@@ -31,9 +31,13 @@ class ChannelFactory : public InputChannelFactory
 public:
     virtual std::shared_ptr<InputChannel> make_input_channel() override;
 
-    ChannelFactory() = default;
+    /// With \a ring_records > 0 each channel also carries input through a ring that big
+    explicit ChannelFactory(size_t ring_records = 0);
     ChannelFactory(ChannelFactory const&) = delete;
     ChannelFactory& operator=(ChannelFactory const&) = delete;
+
+private:
+    size_t const ring_records;
 };
 
 }
@@ -41,6 +41,7 @@
 #include "mir/input/input_probe.h"
 #include "mir/input/platform.h"
 #include "mir/input/xkb_mapper.h"
+#include "mir/input/input_ring.h"
 #include "mir/options/configuration.h"
 #include "mir/options/option.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
@@ -55,6 +56,10 @@
 
 #include "mir_toolkit/cursors.h"
 
+#include <boost/throw_exception.hpp>
+
+#include <string>
+
 namespace mi = mir::input;
 namespace mia = mi::android;
 namespace mr = mir::report;
@@ -201,8 +206,15 @@ std::shared_ptr<mi::InputChannelFactory> mir::DefaultServerConfiguration::the_in
     auto const options = the_options();
     if (!options->get<bool>(options::enable_input_opt))
         return std::make_shared<mi::NullInputChannelFactory>();
-    else
-        return std::make_shared<mi::ChannelFactory>();
+
+    // Checked here, once, rather than failing every surface's creation
+    auto const ring_records = options->get<int>(options::input_ring_opt);
+    if (ring_records < 0 || static_cast<size_t>(ring_records) > mi::InputRing::max_capacity)
+        BOOST_THROW_EXCEPTION(mir::AbnormalExit(
+            std::string("Exiting Mir! Reason: --") + options::input_ring_opt +
+            " must be between 0 and " + std::to_string(mi::InputRing::max_capacity)));
+
+    return std::make_shared<mi::ChannelFactory>(ring_records);
 }
 
 std::shared_ptr<mi::CursorListener>
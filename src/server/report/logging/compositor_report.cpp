@@ -103,12 +103,23 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
 
-        char msg[128];
+        long budget_usec =
+            std::chrono::duration_cast<std::chrono::microseconds>(latency_budget).count();
+        auto dc = ncomposited - last_reported_ncomposited;
+        long avg_composite_time_usec = dc ?
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                composite_time_sum - last_reported_composite_time_sum
+            ).count() / dc : 0;
+
+        char msg[256];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed, "
+                 "budget %ld.%03ld ms, "
+                 "%ld missed, "
+                 "composited in %ld.%03ld ms",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,7 +130,12 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 budget_usec / 1000,
+                 budget_usec % 1000,
+                 nmissed - last_reported_missed,
+                 avg_composite_time_usec / 1000,
+                 avg_composite_time_usec % 1000
                  );
 
         logger.log(ml::Severity::informational, msg, component);
@@ -130,6 +146,9 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
     last_reported_latency_sum = latency_sum;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
+    last_reported_missed = nmissed;
+    last_reported_composite_time_sum = composite_time_sum;
+    last_reported_ncomposited = ncomposited;
 }
 
 void mrl::CompositorReport::finished_frame(SubCompositorId id)
@@ -184,3 +203,23 @@ void mrl::CompositorReport::scheduled()
     std::lock_guard<std::mutex> lock(mutex);
     last_scheduled = now();
 }
+
+void mrl::CompositorReport::chose_latency_budget(SubCompositorId id, std::chrono::nanoseconds budget)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    instance[id].latency_budget = budget;
+}
+
+void mrl::CompositorReport::missed_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++instance[id].nmissed;
+}
+
+void mrl::CompositorReport::composited_output(SubCompositorId id, std::chrono::nanoseconds time)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+    inst.composite_time_sum += time;
+    ++inst.ncomposited;
+}
@@ -50,6 +50,9 @@ public:
     void started() override;
     void stopped() override;
     void scheduled() override;
+    void chose_latency_budget(SubCompositorId id, std::chrono::nanoseconds budget) override;
+    void missed_frame(SubCompositorId id) override;
+    void composited_output(SubCompositorId id, std::chrono::nanoseconds time) override;
 
 private:
     std::shared_ptr<mir::logging::Logger> const logger;
@@ -67,6 +70,10 @@ private:
         TimePoint latency_sum;
         long nframes = 0;
         long nbypassed = 0;
+        long nmissed = 0;
+        std::chrono::nanoseconds latency_budget{0};
+        std::chrono::nanoseconds composite_time_sum{0};
+        long ncomposited = 0;
         bool bypassed = true;
         bool prev_bypassed = false;
 
@@ -75,6 +82,9 @@ private:
         TimePoint last_reported_latency_sum;
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
+        long last_reported_missed = 0;
+        std::chrono::nanoseconds last_reported_composite_time_sum{0};
+        long last_reported_ncomposited = 0;
 
         void log(mir::logging::Logger& logger, SubCompositorId id);
     };
@@ -222,6 +222,51 @@ void mrl::InputReport::published_motion_event(int dest_fd, uint32_t seq_id, int6
     logger->log(ml::Severity::informational, ss.str(), component());
 }
 
+void mrl::InputReport::deferred_input_event(int dest_fd, uint32_t seq_id, size_t queue_depth)
+{
+    std::stringstream ss;
+
+    ss << "Deferred input event"
+       << " seq_id=" << seq_id
+       << " queue_depth=" << queue_depth
+       << " dest_fd=" << dest_fd;
+
+    logger->log(ml::Severity::informational, ss.str(), component());
+}
+
+void mrl::InputReport::coalesced_motion_event(int dest_fd, uint32_t seq_id)
+{
+    std::stringstream ss;
+
+    ss << "Coalesced motion event"
+       << " seq_id=" << seq_id
+       << " dest_fd=" << dest_fd;
+
+    logger->log(ml::Severity::informational, ss.str(), component());
+}
+
+void mrl::InputReport::dropped_motion_event(int dest_fd, uint32_t seq_id)
+{
+    std::stringstream ss;
+
+    ss << "Dropped motion event"
+       << " seq_id=" << seq_id
+       << " dest_fd=" << dest_fd;
+
+    logger->log(ml::Severity::informational, ss.str(), component());
+}
+
+void mrl::InputReport::dropped_input_event(int dest_fd, uint32_t seq_id)
+{
+    std::stringstream ss;
+
+    ss << "Dropped input event"
+       << " seq_id=" << seq_id
+       << " dest_fd=" << dest_fd;
+
+    logger->log(ml::Severity::warning, ss.str(), component());
+}
+
 void mrl::InputReport::opened_input_device(char const* device_name, char const* input_platform)
 {
     std::stringstream ss;
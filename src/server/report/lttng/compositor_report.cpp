@@ -62,3 +62,18 @@ void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::chose_latency_budget(SubCompositorId id, std::chrono::nanoseconds budget)
+{
+    mir_tracepoint(mir_server_compositor, chose_latency_budget, id, budget.count());
+}
+
+void mir::report::lttng::CompositorReport::missed_frame(SubCompositorId id)
+{
+    mir_tracepoint(mir_server_compositor, missed_frame, id);
+}
+
+void mir::report::lttng::CompositorReport::composited_output(SubCompositorId id, std::chrono::nanoseconds time)
+{
+    mir_tracepoint(mir_server_compositor, composited_output, id, time.count());
+}
@@ -43,6 +43,9 @@ public:
     void started() override;
     void stopped() override;
     void scheduled() override;
+    void chose_latency_budget(SubCompositorId id, std::chrono::nanoseconds budget) override;
+    void missed_frame(SubCompositorId id) override;
+    void composited_output(SubCompositorId id, std::chrono::nanoseconds time) override;
 private:
     ServerTracepointProvider tp_provider;
 };
@@ -87,6 +87,35 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    chose_latency_budget,
+    TP_ARGS(void const*, id, int64_t, budget_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int64_t, budget_ns, budget_ns)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    missed_frame,
+    TP_ARGS(void const*, id),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    composited_output,
+    TP_ARGS(void const*, id, int64_t, time_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int64_t, time_ns, time_ns)
+    )
+)
+
 #endif /* MIR_LTTNG_COMPOSITOR_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
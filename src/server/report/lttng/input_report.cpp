@@ -39,6 +39,26 @@ void mir::report::lttng::InputReport::published_motion_event(int dest_fd, uint32
     mir_tracepoint(mir_server_input, published_motion_event, dest_fd, seq_id, event_time);
 }
 
+void mir::report::lttng::InputReport::deferred_input_event(int dest_fd, uint32_t seq_id, size_t queue_depth)
+{
+    mir_tracepoint(mir_server_input, deferred_input_event, dest_fd, seq_id, queue_depth);
+}
+
+void mir::report::lttng::InputReport::coalesced_motion_event(int dest_fd, uint32_t seq_id)
+{
+    mir_tracepoint(mir_server_input, coalesced_motion_event, dest_fd, seq_id);
+}
+
+void mir::report::lttng::InputReport::dropped_motion_event(int dest_fd, uint32_t seq_id)
+{
+    mir_tracepoint(mir_server_input, dropped_motion_event, dest_fd, seq_id);
+}
+
+void mir::report::lttng::InputReport::dropped_input_event(int dest_fd, uint32_t seq_id)
+{
+    mir_tracepoint(mir_server_input, dropped_input_event, dest_fd, seq_id);
+}
+
 void mir::report::lttng::InputReport::opened_input_device(char const* name, char const* platform)
 {
     mir_tracepoint(mir_server_input, opened_input_device, name, platform);
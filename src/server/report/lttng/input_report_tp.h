@@ -61,6 +61,47 @@ TRACEPOINT_EVENT(
      )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_input,
+    deferred_input_event,
+    TP_ARGS(int, dest_fd, uint32_t, seq_id, size_t, queue_depth),
+    TP_FIELDS(
+        ctf_integer(int, dest_fd, dest_fd)
+        ctf_integer(uint32_t, seq_id, seq_id)
+        ctf_integer(size_t, queue_depth, queue_depth)
+     )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_input,
+    coalesced_motion_event,
+    TP_ARGS(int, dest_fd, uint32_t, seq_id),
+    TP_FIELDS(
+        ctf_integer(int, dest_fd, dest_fd)
+        ctf_integer(uint32_t, seq_id, seq_id)
+     )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_input,
+    dropped_motion_event,
+    TP_ARGS(int, dest_fd, uint32_t, seq_id),
+    TP_FIELDS(
+        ctf_integer(int, dest_fd, dest_fd)
+        ctf_integer(uint32_t, seq_id, seq_id)
+     )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_input,
+    dropped_input_event,
+    TP_ARGS(int, dest_fd, uint32_t, seq_id),
+    TP_FIELDS(
+        ctf_integer(int, dest_fd, dest_fd)
+        ctf_integer(uint32_t, seq_id, seq_id)
+     )
+)
+
 TRACEPOINT_EVENT(
     mir_server_input,
     opened_input_device,
@@ -32,6 +32,22 @@ void mrn::InputReport::published_motion_event(int /* dest_fd */, uint32_t /* seq
 {
 }
 
+void mrn::InputReport::deferred_input_event(int /* dest_fd */, uint32_t /* seq_id */, size_t /* queue_depth */)
+{
+}
+
+void mrn::InputReport::coalesced_motion_event(int /* dest_fd */, uint32_t /* seq_id */)
+{
+}
+
+void mrn::InputReport::dropped_motion_event(int /* dest_fd */, uint32_t /* seq_id */)
+{
+}
+
+void mrn::InputReport::dropped_input_event(int /* dest_fd */, uint32_t /* seq_id */)
+{
+}
+
 void mrn::InputReport::opened_input_device(char const* /* name */, char const* /* platform */)
 {
 }
@@ -39,6 +39,10 @@ public:
 
     void published_key_event(int dest_fd, uint32_t seq_id, int64_t event_time) override;
     void published_motion_event(int dest_fd, uint32_t seq_id, int64_t event_time) override;
+    void deferred_input_event(int dest_fd, uint32_t seq_id, size_t queue_depth) override;
+    void coalesced_motion_event(int dest_fd, uint32_t seq_id) override;
+    void dropped_motion_event(int dest_fd, uint32_t seq_id) override;
+    void dropped_input_event(int dest_fd, uint32_t seq_id) override;
 
     void opened_input_device(char const* device_name, char const* input_platform) override;
     void failed_to_open_input_device(char const* device_name, char const* input_platform) override;
@@ -19,6 +19,7 @@
  */
 
 #include "basic_surface.h"
+#include "recycling_pool.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/input/input_channel.h"
@@ -248,8 +249,14 @@ ms::BasicSurface::BasicSurface(
     layers(layers),
     confine_pointer_state_(state),
     cursor_stream_adapter{std::make_unique<ms::CursorStreamImageAdapter>(*this)},
+    snapshots{std::make_shared<RecyclingPool>()},
     input_validator([this](MirEvent const& ev) { this->input_sender->send_event(ev, server_input_channel); })
 {
+    {
+        std::unique_lock<std::mutex> lk(guard);
+        published_layers = std::make_shared<std::list<StreamInfo> const>(layers);
+        publish_presentation(lk);
+    }
     report->surface_created(this, surface_name);
 }
 
@@ -282,6 +289,7 @@ void ms::BasicSurface::move_to(geometry::Point const& top_left)
     {
         std::unique_lock<std::mutex> lk(guard);
         surface_rect.top_left = top_left;
+        publish_presentation(lk);
     }
     observers.moved_to(top_left);
 }
@@ -297,6 +305,7 @@ void ms::BasicSurface::set_hidden(bool hide)
     {
         std::unique_lock<std::mutex> lk(guard);
         hidden = hide;
+        publish_presentation(lk);
     }
     observers.hidden_set_to(hide);
 }
@@ -332,6 +341,13 @@ int ms::BasicSurface::client_input_fd() const
     return server_input_channel->client_fd();
 }
 
+std::vector<int> ms::BasicSurface::client_input_ring_fds() const
+{
+    if (!supports_input() || server_input_channel->ring_fd() < 0)
+        return {};
+    return {server_input_channel->ring_fd(), server_input_channel->ring_wakeup_fd()};
+}
+
 std::shared_ptr<mi::InputChannel> ms::BasicSurface::input_channel() const
 {
     return server_input_channel;
@@ -364,6 +380,7 @@ void ms::BasicSurface::resize(geom::Size const& desired_size)
     {
         std::unique_lock<std::mutex> lock(guard);
         surface_rect.size = new_size;
+        publish_presentation(lock);
     }
     observers.resized_to(new_size);
 }
@@ -386,13 +403,13 @@ bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
 {
     std::unique_lock<std::mutex> lock(guard);
 
-    if (!visible(lock))
+    if (!visible(lock) || !surface_rect.contains(point))
         return false;
 
     if (custom_input_rectangles.empty())
     {
         // no custom input, restrict to bounding rectangle
-        return surface_rect.contains(point);
+        return true;
     }
     else
     {
@@ -411,6 +428,7 @@ void ms::BasicSurface::set_alpha(float alpha)
     {
         std::unique_lock<std::mutex> lk(guard);
         surface_alpha = alpha;
+        publish_presentation(lk);
     }
     observers.alpha_set_to(alpha);
 }
@@ -425,14 +443,30 @@ void ms::BasicSurface::set_transformation(glm::mat4 const& t)
     {
         std::unique_lock<std::mutex> lk(guard);
         transformation_matrix = t;
+        publish_presentation(lk);
     }
     observers.transformation_set_to(t);
 }
 
 bool ms::BasicSurface::visible() const
 {
-    std::unique_lock<std::mutex> lk(guard);
-    return visible(lk); 
+    return visible(*std::atomic_load(&presentation));
+}
+
+bool ms::BasicSurface::visible(Presentation const& presentation)
+{
+    bool visible{false};
+    for (auto const& info : *presentation.layers)
+        visible |= info.stream->has_submitted_buffer();
+    return !presentation.hidden && visible;
+}
+
+void ms::BasicSurface::publish_presentation(std::unique_lock<std::mutex>&)
+{
+    std::atomic_store(
+        &presentation,
+        std::shared_ptr<Presentation const>{std::make_shared<Presentation>(
+            Presentation{surface_rect, transformation_matrix, surface_alpha, hidden, published_layers})});
 }
 
 bool ms::BasicSurface::visible(std::unique_lock<std::mutex>&) const
@@ -860,9 +894,9 @@ private:
 
 int ms::BasicSurface::buffers_ready_for_compositor(void const* id) const
 {
-    std::unique_lock<std::mutex> lk(guard);
+    auto const current = std::atomic_load(&presentation);
     auto max_buf = 0;
-    for (auto const& info : layers)
+    for (auto const& info : *current->layers)
         max_buf = std::max(max_buf, info.stream->buffers_ready_for_compositor(id));
     return max_buf;
 }
@@ -904,15 +938,24 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
             {
                 layer.stream->add_observer(observer);
             });
+
+        published_layers = std::make_shared<std::list<StreamInfo> const>(layers);
+        publish_presentation(lk);
     }
     observers.moved_to(surface_rect.top_left);
 }
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
 {
-    std::unique_lock<std::mutex> lk(guard);
     mg::RenderableList list;
-    for (auto const& info : layers)
+    collect_renderables(id, list);
+    return list;
+}
+
+void ms::BasicSurface::collect_renderables(mc::CompositorID id, mg::RenderableList& renderables) const
+{
+    auto const current = std::atomic_load(&presentation);
+    for (auto const& info : *current->layers)
     {
         if (info.stream->has_submitted_buffer())
         {
@@ -922,13 +965,13 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
+            renderables.emplace_back(std::allocate_shared<SurfaceSnapshot>(
+                RecyclingAllocator<SurfaceSnapshot>{snapshots},
                 info.stream, id,
-                geom::Rectangle{surface_rect.top_left + info.displacement, std::move(size)},
-                transformation_matrix, surface_alpha, info.stream.get()));
+                geom::Rectangle{current->rect.top_left + info.displacement, std::move(size)},
+                current->transformation, current->alpha, info.stream.get()));
         }
     }
-    return list;
 }
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
@@ -57,6 +57,7 @@ namespace scene
 {
 class SceneReport;
 class CursorStreamImageAdapter;
+class RecyclingPool;
 
 class BasicSurface : public Surface
 {
@@ -97,6 +98,7 @@ public:
 
     bool supports_input() const override;
     int client_input_fd() const override;
+    std::vector<int> client_input_ring_fds() const override;
     std::shared_ptr<input::InputChannel> input_channel() const override;
     input::InputReceptionMode reception_mode() const override;
     void set_reception_mode(input::InputReceptionMode mode) override;
@@ -115,6 +117,7 @@ public:
     bool visible() const override;
     
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    void collect_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
 
     MirWindowType type() const override;
@@ -151,7 +154,19 @@ public:
     void placed_relative(geometry::Rectangle const& placement) override;
 
 private:
+    /// What compositors read every frame; replaced, never changed, so they can read it without guard
+    struct Presentation
+    {
+        geometry::Rectangle rect;
+        glm::mat4 transformation;
+        float alpha;
+        bool hidden;
+        std::shared_ptr<std::list<StreamInfo> const> layers;
+    };
+
     bool visible(std::unique_lock<std::mutex>&) const;
+    static bool visible(Presentation const& presentation);
+    void publish_presentation(std::unique_lock<std::mutex>&);
     MirWindowType set_type(MirWindowType t);  // Use configure() to make public changes
     MirWindowState set_state(MirWindowState s);
     int set_dpi(int);
@@ -177,6 +192,8 @@ private:
     std::weak_ptr<Surface> const parent_;
 
     std::list<StreamInfo> layers;
+    std::shared_ptr<std::list<StreamInfo> const> published_layers;
+    std::shared_ptr<Presentation const> presentation; // Only by std::atomic_load() and std::atomic_store()
     // Surface attributes:
     MirWindowType type_ = mir_window_type_normal;
     MirWindowState state_ = mir_window_state_restored;
@@ -189,6 +206,9 @@ private:
 
     std::unique_ptr<CursorStreamImageAdapter> const cursor_stream_adapter;
 
+    // Snapshots are made every frame for every compositor
+    std::shared_ptr<RecyclingPool> const snapshots;
+
     input::Validator input_validator;
 };
 
@@ -46,6 +46,9 @@
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/display_changer.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 namespace mi = mir::input;
@@ -186,7 +189,8 @@ mir::DefaultServerConfiguration::the_session_coordinator()
                 the_session_listener(),
                 the_display(),
                 the_application_not_responding_detector(),
-                the_buffer_allocator());
+                the_buffer_allocator(),
+                std::max(the_options()->get<int>(options::shm_cache_opt), 0) * size_t{1024 * 1024});
         });
 }
 
@@ -216,8 +220,11 @@ mir::DefaultServerConfiguration::the_snapshot_strategy()
     return snapshot_strategy(
         [this]()
         {
+            // Enough to snapshot a window switcher's worth of software clients quickly
+            auto const software_workers = std::min(std::max(std::thread::hardware_concurrency(), 1u), 4u);
+
             return std::make_shared<ms::ThreadedSnapshotStrategy>(
-                the_pixel_buffer());
+                the_pixel_buffer(), software_workers);
         });
 }
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pooled_software_allocator.h"
+#include "mir/graphics/shm_pool.h"
+#include "mir/graphics/buffer_properties.h"
+
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+auto ms::PooledSoftwareAllocator::wrap(
+    std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    size_t max_cached_bytes) -> std::shared_ptr<mg::GraphicBufferAllocator>
+{
+    // The platform allocators live in other DSOs, so pooling is discovered rather than part of the ABI
+    auto const pool_allocator = dynamic_cast<mg::ShmPoolAllocator*>(allocator.get());
+
+    if (!pool_allocator || !max_cached_bytes)
+        return allocator;
+
+    return std::make_shared<PooledSoftwareAllocator>(allocator, *pool_allocator, max_cached_bytes);
+}
+
+ms::PooledSoftwareAllocator::PooledSoftwareAllocator(
+    std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    mg::ShmPoolAllocator& pool_allocator,
+    size_t max_cached_bytes) :
+    allocator{allocator},
+    pool_allocator(pool_allocator),
+    shm_pool{pool_allocator.create_shm_pool(max_cached_bytes)}
+{
+}
+
+std::shared_ptr<mg::Buffer> ms::PooledSoftwareAllocator::alloc_buffer(mg::BufferProperties const& buffer_properties)
+{
+    if (buffer_properties.usage == mg::BufferUsage::software)
+        return alloc_software_buffer(buffer_properties.size, buffer_properties.format);
+
+    return allocator->alloc_buffer(buffer_properties);
+}
+
+std::vector<MirPixelFormat> ms::PooledSoftwareAllocator::supported_pixel_formats()
+{
+    return allocator->supported_pixel_formats();
+}
+
+std::shared_ptr<mg::Buffer> ms::PooledSoftwareAllocator::alloc_buffer(
+    geom::Size size, uint32_t native_format, uint32_t native_flags)
+{
+    return allocator->alloc_buffer(size, native_format, native_flags);
+}
+
+std::shared_ptr<mg::Buffer> ms::PooledSoftwareAllocator::alloc_software_buffer(
+    geom::Size size, MirPixelFormat format)
+{
+    return pool_allocator.alloc_software_buffer(size, format, *shm_pool);
+}
+
+mg::ShmPool const& ms::PooledSoftwareAllocator::pool() const
+{
+    return *shm_pool;
+}
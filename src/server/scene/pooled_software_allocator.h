@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_POOLED_SOFTWARE_ALLOCATOR_H_
+#define MIR_SCENE_POOLED_SOFTWARE_ALLOCATOR_H_
+
+#include "mir/graphics/graphic_buffer_allocator.h"
+
+namespace mir
+{
+namespace graphics
+{
+class ShmPool;
+class ShmPoolAllocator;
+}
+
+namespace scene
+{
+/**
+ * Gives one session's software buffers memory from a pool of its own,
+ * so that resizing reuses the memory of the buffers it released.
+ */
+class PooledSoftwareAllocator : public graphics::GraphicBufferAllocator
+{
+public:
+    /**
+     * \a allocator, wrapped for a single session if it supports pooling and
+     * \a max_cached_bytes is not zero; otherwise \a allocator itself.
+     */
+    static auto wrap(
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        size_t max_cached_bytes) -> std::shared_ptr<graphics::GraphicBufferAllocator>;
+
+    PooledSoftwareAllocator(
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        graphics::ShmPoolAllocator& pool_allocator,
+        size_t max_cached_bytes);
+
+    std::shared_ptr<graphics::Buffer> alloc_buffer(graphics::BufferProperties const& buffer_properties) override;
+    std::vector<MirPixelFormat> supported_pixel_formats() override;
+    std::shared_ptr<graphics::Buffer> alloc_buffer(
+        geometry::Size size, uint32_t native_format, uint32_t native_flags) override;
+    std::shared_ptr<graphics::Buffer> alloc_software_buffer(geometry::Size size, MirPixelFormat format) override;
+
+    /// The session's memory accounting
+    graphics::ShmPool const& pool() const;
+
+private:
+    std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
+    graphics::ShmPoolAllocator& pool_allocator;
+    std::shared_ptr<graphics::ShmPool> const shm_pool;
+};
+}
+}
+
+#endif /* MIR_SCENE_POOLED_SOFTWARE_ALLOCATOR_H_ */
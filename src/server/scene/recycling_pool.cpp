@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recycling_pool.h"
+
+#include <new>
+
+namespace ms = mir::scene;
+
+ms::RecyclingPool::~RecyclingPool() noexcept
+{
+    for (auto& size_class : size_classes)
+    {
+        while (auto const block = size_class.free)
+        {
+            size_class.free = block->next;
+            ::operator delete(block);
+        }
+    }
+}
+
+void* ms::RecyclingPool::allocate(size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock{guard};
+
+        if (auto const size_class = size_class_for(size))
+        {
+            if (auto const block = size_class->free)
+            {
+                size_class->free = block->next;
+                --size_class->free_count;
+                return block;
+            }
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ms::RecyclingPool::deallocate(void* block, size_t size) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{guard};
+
+        auto const size_class = size_class_for(size);
+        if (size_class && size_class->free_count < max_free_per_class)
+        {
+            size_class->free = new (block) FreeBlock{size_class->free};
+            ++size_class->free_count;
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+auto ms::RecyclingPool::size_class_for(size_t size) -> SizeClass*
+{
+    if (size < sizeof(FreeBlock))
+        return nullptr;
+
+    for (auto& size_class : size_classes)
+    {
+        if (size_class.size == size)
+            return &size_class;
+
+        if (size_class.size == 0)
+        {
+            size_class.size = size;
+            return &size_class;
+        }
+    }
+
+    return nullptr;
+}
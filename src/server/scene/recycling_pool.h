@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_RECYCLING_POOL_H_
+#define MIR_SCENE_RECYCLING_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * Keeps the memory of released blocks for the next allocation of the same
+ * size, so that objects made afresh every frame stay off the heap once the
+ * scene is steady.
+ *
+ * Only a few distinct block sizes are recycled; others go straight to the
+ * heap.
+ */
+class RecyclingPool
+{
+public:
+    RecyclingPool() = default;
+    ~RecyclingPool() noexcept;
+
+    void* allocate(size_t size);
+    void deallocate(void* block, size_t size) noexcept;
+
+private:
+    RecyclingPool(RecyclingPool const&) = delete;
+    RecyclingPool& operator=(RecyclingPool const&) = delete;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct SizeClass
+    {
+        size_t size;
+        FreeBlock* free;
+        size_t free_count;
+    };
+
+    SizeClass* size_class_for(size_t size);
+
+    static size_t const max_size_classes{4};
+    static size_t const max_free_per_class{1024};
+
+    std::mutex guard;
+    SizeClass size_classes[max_size_classes]{};
+};
+
+/// Allocates from a RecyclingPool, e.g. for std::allocate_shared()
+template<typename T>
+class RecyclingAllocator
+{
+public:
+    using value_type = T;
+
+    explicit RecyclingAllocator(std::shared_ptr<RecyclingPool> const& pool) : pool{pool} {}
+
+    template<typename U>
+    RecyclingAllocator(RecyclingAllocator<U> const& other) : pool{other.pool} {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool->allocate(n * sizeof(T))); }
+    void deallocate(T* block, size_t n) noexcept { pool->deallocate(block, n * sizeof(T)); }
+
+    // Keeps the pool alive for as long as anything allocated from it
+    std::shared_ptr<RecyclingPool> pool;
+};
+
+template<typename T, typename U>
+bool operator==(RecyclingAllocator<T> const& lhs, RecyclingAllocator<U> const& rhs)
+{
+    return lhs.pool == rhs.pool;
+}
+
+template<typename T, typename U>
+bool operator!=(RecyclingAllocator<T> const& lhs, RecyclingAllocator<U> const& rhs)
+{
+    return lhs.pool != rhs.pool;
+}
+}
+}
+
+#endif /* MIR_SCENE_RECYCLING_POOL_H_ */
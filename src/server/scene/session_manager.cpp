@@ -18,6 +18,7 @@
 
 #include "session_manager.h"
 #include "application_session.h"
+#include "pooled_software_allocator.h"
 #include "mir/scene/session_container.h"
 #include "mir/scene/surface.h"
 #include "mir/scene/session.h"
@@ -52,7 +53,8 @@ ms::SessionManager::SessionManager(
     std::shared_ptr<SessionListener> const& session_listener,
     std::shared_ptr<graphics::Display const> const& display,
     std::shared_ptr<ApplicationNotRespondingDetector> const& anr_detector,
-    std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator) : 
+    std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+    size_t shm_cache_bytes) :
     surface_stack(surface_stack),
     surface_factory(surface_factory),
     buffer_stream_factory(buffer_stream_factory),
@@ -62,7 +64,8 @@ ms::SessionManager::SessionManager(
     session_listener(session_listener),
     display{display},
     anr_detector{anr_detector},
-    allocator(allocator)
+    allocator(allocator),
+    shm_cache_bytes{shm_cache_bytes}
 {
 }
 
@@ -101,7 +104,7 @@ std::shared_ptr<ms::Session> ms::SessionManager::open_session(
             session_listener,
             *display->configuration(),
             sender,
-            allocator);
+            PooledSoftwareAllocator::wrap(allocator, shm_cache_bytes));
 
     app_container->insert_session(new_session);
 
@@ -60,7 +60,8 @@ public:
         std::shared_ptr<SessionListener> const& session_listener,
         std::shared_ptr<graphics::Display const> const& display,
         std::shared_ptr<ApplicationNotRespondingDetector> const& anr_detector,
-        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator); 
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        size_t shm_cache_bytes);
 
     virtual ~SessionManager() noexcept;
 
@@ -91,6 +92,7 @@ private:
     std::shared_ptr<graphics::Display const> const display;
     std::shared_ptr<ApplicationNotRespondingDetector> const anr_detector;
     std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
+    size_t const shm_cache_bytes;
 };
 
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_pixel_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/renderer/sw/blit.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mrs = mir::renderer::software;
+namespace blit = mir::renderer::software::blit;
+namespace geom = mir::geometry;
+
+namespace
+{
+mrs::PixelSource* as_pixel_source(mg::Buffer& buffer)
+{
+    return dynamic_cast<mrs::PixelSource*>(buffer.native_buffer_base());
+}
+
+void make_opaque(uint32_t* pixels, size_t n)
+{
+    for (size_t i = 0; i != n; ++i)
+        pixels[i] |= 0xff000000;
+}
+}
+
+bool ms::SoftwarePixelBuffer::can_fill_from(mg::Buffer& buffer)
+{
+    switch (buffer.pixel_format())
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        return as_pixel_source(buffer) != nullptr;
+    default:
+        return false;
+    }
+}
+
+void ms::SoftwarePixelBuffer::fill_from(mg::Buffer& buffer)
+{
+    if (!can_fill_from(buffer))
+        BOOST_THROW_EXCEPTION(std::logic_error("Buffer pixels are not accessible to the CPU"));
+
+    auto const pixel_source = as_pixel_source(buffer);
+    auto const format = buffer.pixel_format();
+    auto const width = buffer.size().width.as_uint32_t();
+    auto const height = buffer.size().height.as_uint32_t();
+    auto const source_stride = pixel_source->stride().as_uint32_t();
+
+    pixels.resize(width * height);
+    size_ = buffer.size();
+
+    pixel_source->read([&](unsigned char const* source)
+    {
+        for (uint32_t y = 0; y != height; ++y)
+        {
+            auto const src = reinterpret_cast<uint32_t const*>(source + y * source_stride);
+            auto const dst = pixels.data() + y * width;
+
+            if (format == mir_pixel_format_argb_8888 || format == mir_pixel_format_xrgb_8888)
+                blit::copy(dst, src, width);
+            else
+                blit::swap_red_blue(dst, src, width);
+
+            if (format == mir_pixel_format_xrgb_8888 || format == mir_pixel_format_xbgr_8888)
+                make_opaque(dst, width);
+        }
+    });
+}
+
+void const* ms::SoftwarePixelBuffer::as_argb_8888()
+{
+    return pixels.data();
+}
+
+geom::Size ms::SoftwarePixelBuffer::size() const
+{
+    return size_;
+}
+
+geom::Stride ms::SoftwarePixelBuffer::stride() const
+{
+    return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)};
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_
+#define MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_
+
+#include "pixel_buffer.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * Extracts the pixels from a graphics::Buffer whose pixels are already in
+ * CPU memory, converting them on the CPU rather than reading them back
+ * through GL. The memory for the pixels is kept from one buffer to the next.
+ */
+class SoftwarePixelBuffer : public PixelBuffer
+{
+public:
+    /// Whether the buffer's pixels are in CPU memory, in a format that can be converted
+    static bool can_fill_from(graphics::Buffer& buffer);
+
+    void fill_from(graphics::Buffer& buffer) override;
+    void const* as_argb_8888() override;
+    geometry::Size size() const override;
+    geometry::Stride stride() const override;
+
+private:
+    std::vector<uint32_t> pixels;
+    geometry::Size size_;
+};
+
+}
+}
+
+#endif /* MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_ */
@@ -0,0 +1,232 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "surface_index.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+int const cell_size{256};
+// Beyond this a surface is cheaper to check on every lookup than to bucket
+int const max_cells_per_surface{64};
+
+int cell_of(int coordinate)
+{
+    return coordinate >= 0 ? coordinate / cell_size : (coordinate - cell_size + 1) / cell_size;
+}
+
+uint64_t key_of(int cell_x, int cell_y)
+{
+    return (uint64_t{static_cast<uint32_t>(cell_x)} << 32) | static_cast<uint32_t>(cell_y);
+}
+
+struct CellRange
+{
+    int left, top, right, bottom; // inclusive
+
+    long long count() const { return (right - left + 1LL) * (bottom - top + 1LL); }
+};
+
+CellRange cells_covering(geom::Rectangle const& bounds)
+{
+    return {cell_of(bounds.left().as_int()), cell_of(bounds.top().as_int()),
+            cell_of(bounds.right().as_int() - 1), cell_of(bounds.bottom().as_int() - 1)};
+}
+
+bool is_empty(geom::Rectangle const& bounds)
+{
+    return bounds.size.width.as_int() <= 0 || bounds.size.height.as_int() <= 0;
+}
+
+template<typename Entries, typename Entry>
+void insert_by_z(Entries& list, Entry const* entry)
+{
+    auto const position = std::upper_bound(list.begin(), list.end(), entry,
+        [](Entry const* lhs, Entry const* rhs) { return lhs->z > rhs->z; });
+    list.insert(position, entry);
+}
+
+template<typename Entries, typename Entry>
+void erase_from(Entries& list, Entry const* entry)
+{
+    list.erase(std::remove(list.begin(), list.end(), entry), list.end());
+}
+}
+
+void ms::SurfaceIndex::add(std::shared_ptr<Surface> const& surface, geom::Rectangle const& bounds)
+{
+    auto& entry = entries[surface.get()];
+    if (entry.surface)
+        erase(entry);
+
+    entry = Entry{surface, bounds, ++next_z, false};
+    insert(entry);
+    ++generation;
+}
+
+void ms::SurfaceIndex::update(Surface* surface, geom::Rectangle const& bounds)
+{
+    auto const entry = entries.find(surface);
+    if (entry == entries.end() || entry->second.bounds == bounds)
+        return;
+
+    erase(entry->second);
+    entry->second.bounds = bounds;
+    insert(entry->second);
+    ++generation;
+}
+
+void ms::SurfaceIndex::remove(Surface* surface)
+{
+    auto const entry = entries.find(surface);
+    if (entry == entries.end())
+        return;
+
+    erase(entry->second);
+    entries.erase(entry);
+    ++generation;
+}
+
+void ms::SurfaceIndex::restack(std::vector<std::shared_ptr<Surface>> const& bottom_to_top)
+{
+    next_z = 0;
+    for (auto const& surface : bottom_to_top)
+    {
+        auto const entry = entries.find(surface.get());
+        if (entry != entries.end())
+            entry->second.z = ++next_z;
+    }
+
+    auto const topmost_first = [](Entry const* lhs, Entry const* rhs) { return lhs->z > rhs->z; };
+    for (auto& cell : cells)
+        std::sort(cell.second.begin(), cell.second.end(), topmost_first);
+    std::sort(oversized.begin(), oversized.end(), topmost_first);
+    ++generation;
+}
+
+auto ms::SurfaceIndex::topmost_at(
+    geom::Point const& point,
+    std::function<bool(Surface&)> const& accept) const -> std::shared_ptr<Surface>
+{
+    LastHit last;
+    {
+        std::lock_guard<std::mutex> lock{last_hit_guard};
+        last = last_hit;
+    }
+
+    // Nothing can be above the last hit in its region, so if it is still
+    // a match it is the answer
+    if (last.generation == generation && last.region.contains(point) && accept(*last.entry->surface))
+        return last.entry->surface;
+
+    Entry const* hit{nullptr};
+    for_each_candidate(point, [&](Entry const& entry)
+        {
+            if (entry.bounds.contains(point) && accept(*entry.surface))
+                hit = &entry;
+            return hit != nullptr;
+        });
+
+    if (!hit)
+        return {};
+
+    geom::Rectangle const cell{
+        {cell_of(point.x.as_int()) * cell_size, cell_of(point.y.as_int()) * cell_size},
+        {cell_size, cell_size}};
+    auto const region = hit->bounds.intersection_with(cell);
+
+    bool covered{false};
+    for_each_candidate(point, [&](Entry const& entry)
+        {
+            covered = &entry != hit && entry.bounds.overlaps(region);
+            return &entry == hit || covered;
+        });
+
+    if (!covered)
+    {
+        std::lock_guard<std::mutex> lock{last_hit_guard};
+        last_hit = LastHit{generation, hit, region};
+    }
+
+    return hit->surface;
+}
+
+void ms::SurfaceIndex::insert(Entry& entry)
+{
+    if (is_empty(entry.bounds))
+        return;
+
+    auto const range = cells_covering(entry.bounds);
+    entry.oversized = range.count() > max_cells_per_surface;
+
+    if (entry.oversized)
+    {
+        insert_by_z(oversized, &entry);
+        return;
+    }
+
+    for (int y = range.top; y <= range.bottom; ++y)
+        for (int x = range.left; x <= range.right; ++x)
+            insert_by_z(cells[key_of(x, y)], &entry);
+}
+
+void ms::SurfaceIndex::erase(Entry const& entry)
+{
+    if (is_empty(entry.bounds))
+        return;
+
+    if (entry.oversized)
+    {
+        erase_from(oversized, &entry);
+        return;
+    }
+
+    auto const range = cells_covering(entry.bounds);
+    for (int y = range.top; y <= range.bottom; ++y)
+    {
+        for (int x = range.left; x <= range.right; ++x)
+        {
+            auto const cell = cells.find(key_of(x, y));
+            erase_from(cell->second, &entry);
+            if (cell->second.empty())
+                cells.erase(cell);
+        }
+    }
+}
+
+void ms::SurfaceIndex::for_each_candidate(
+    geom::Point const& point,
+    std::function<bool(Entry const&)> const& f) const
+{
+    static Entries const none;
+    auto const cell = cells.find(key_of(cell_of(point.x.as_int()), cell_of(point.y.as_int())));
+    auto const& bucketed = cell != cells.end() ? cell->second : none;
+
+    // Merge the bucketed and oversized surfaces, topmost first
+    auto i = bucketed.begin();
+    auto j = oversized.begin();
+    while (i != bucketed.end() || j != oversized.end())
+    {
+        auto& next = (j == oversized.end() || (i != bucketed.end() && (*i)->z > (*j)->z)) ? i : j;
+        if (f(**next++))
+            return;
+    }
+}
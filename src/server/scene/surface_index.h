@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SURFACE_INDEX_H_
+#define MIR_SCENE_SURFACE_INDEX_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+
+/**
+ * Finds the topmost surface at a point without visiting every surface.
+ *
+ * Surfaces are bucketed by their input bounds into a grid of fixed size
+ * cells, each holding its surfaces topmost first. Surfaces too large to
+ * bucket cheaply are kept in a separate list that every lookup checks.
+ *
+ * Changes must be serialized against each other and against lookups by the
+ * owner; lookups may run concurrently.
+ */
+class SurfaceIndex
+{
+public:
+    SurfaceIndex() = default;
+
+    /// Adds \a surface above every other
+    void add(std::shared_ptr<Surface> const& surface, geometry::Rectangle const& bounds);
+    /// Records new input bounds for \a surface, if it has been added
+    void update(Surface* surface, geometry::Rectangle const& bounds);
+    void remove(Surface* surface);
+    /// Restacks the surfaces in the order given, bottom first
+    void restack(std::vector<std::shared_ptr<Surface>> const& bottom_to_top);
+
+    /// The topmost surface with bounds containing \a point that \a accept is true for
+    auto topmost_at(
+        geometry::Point const& point,
+        std::function<bool(Surface&)> const& accept) const -> std::shared_ptr<Surface>;
+
+private:
+    SurfaceIndex(SurfaceIndex const&) = delete;
+    SurfaceIndex& operator=(SurfaceIndex const&) = delete;
+
+    struct Entry
+    {
+        std::shared_ptr<Surface> surface;
+        geometry::Rectangle bounds;
+        uint64_t z;
+        bool oversized;
+    };
+    using Entries = std::vector<Entry const*>;
+
+    void insert(Entry& entry);
+    void erase(Entry const& entry);
+    void for_each_candidate(geometry::Point const& point, std::function<bool(Entry const&)> const& f) const;
+
+    std::unordered_map<Surface*, Entry> entries;
+    std::unordered_map<uint64_t, Entries> cells;
+    Entries oversized;
+    uint64_t next_z{0};
+    uint64_t generation{0};
+
+    // Where the last lookup found a surface that nothing else could be above
+    struct LastHit
+    {
+        uint64_t generation;
+        Entry const* entry;
+        geometry::Rectangle region;
+    };
+    std::mutex mutable last_hit_guard;
+    LastHit mutable last_hit{~uint64_t{0}, nullptr, {}};
+};
+}
+}
+
+#endif /* MIR_SCENE_SURFACE_INDEX_H_ */
@@ -21,6 +21,7 @@
 #include "surface_stack.h"
 #include "rendering_tracker.h"
 #include "mir/scene/surface.h"
+#include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/compositor/decoration.h"
@@ -47,14 +48,14 @@ class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
+        std::shared_ptr<ms::Surface> const& surface,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
           cid{id},
-          surface_name(name)
+          surface{surface}
     {
     }
 
@@ -75,14 +76,15 @@ public:
 
     std::unique_ptr<mc::Decoration> decoration() const override
     {
-        return std::make_unique<mc::Decoration>(mc::Decoration::Type::surface, surface_name);
+        return std::make_unique<mc::Decoration>(mc::Decoration::Type::surface, surface->name());
     }
 
 private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
+    // Only asked for its name when decorating, which few compositors do
+    std::shared_ptr<ms::Surface> const surface;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -117,59 +119,98 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
 };
 
+class InputBoundsObserver : public ms::NullSurfaceObserver
+{
+public:
+    InputBoundsObserver(std::function<void()> const& bounds_changed)
+        : bounds_changed{bounds_changed}
+    {
+    }
+
+    void resized_to(geom::Size const&) override { bounds_changed(); }
+    void moved_to(geom::Point const&) override { bounds_changed(); }
+
+private:
+    std::function<void()> const bounds_changed;
+};
 }
 
 ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
     report{report},
+    version{std::make_shared<Version>()},
     scene_changed{false}
 {
 }
 
+ms::SurfaceStack::~SurfaceStack() noexcept(true)
+{
+    for (auto const& observer : input_bounds_observers)
+        observer.first->remove_observer(observer.second);
+}
+
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
-    RecursiveReadLock lg(guard);
+    mc::SceneElementSequence elements;
+    collect_scene_elements(id, elements);
+    return elements;
+}
+
+void ms::SurfaceStack::collect_scene_elements(mc::CompositorID id, mc::SceneElementSequence& elements)
+{
+    auto const scene = std::atomic_load(&version);
 
     scene_changed = false;
-    mc::SceneElementSequence elements;
-    for (auto const& surface : surfaces)
+    elements.clear();
+
+    // Each compositor reuses its own storage; only it asks for its id
+    auto const arena = scene->frame_arenas.find(id);
+    std::vector<std::shared_ptr<mg::Renderable>> unregistered_renderables;
+    auto& renderables = arena != scene->frame_arenas.end() ? arena->second->renderables : unregistered_renderables;
+    auto const& pool = arena != scene->frame_arenas.end() ? arena->second->elements : unregistered_elements;
+
+    for (auto const& layer : scene->layers)
     {
-        if (surface->visible())
+        if (layer.surface->visible())
         {
-            for (auto& renderable : surface->generate_renderables(id))
+            layer.surface->collect_renderables(id, renderables);
+            for (auto const& renderable : renderables)
             {
                 elements.emplace_back(
-                    std::make_shared<SurfaceSceneElement>(
-                        surface->name(),
+                    std::allocate_shared<SurfaceSceneElement>(
+                        ms::RecyclingAllocator<SurfaceSceneElement>{pool},
+                        layer.surface,
                         renderable,
-                        rendering_trackers[surface.get()],
+                        layer.tracker,
                         id));
             }
+            renderables.clear();
         }
     }
-    for (auto const& renderable : overlays)
+    for (auto const& renderable : scene->overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(
+            std::allocate_shared<OverlaySceneElement>(
+                ms::RecyclingAllocator<OverlaySceneElement>{pool},
+                renderable));
     }
-    return elements;
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 {
-    RecursiveReadLock lg(guard);
+    auto const scene = std::atomic_load(&version);
 
     int result = scene_changed ? 1 : 0;
-    for (auto const& surface : surfaces)
+    for (auto const& layer : scene->layers)
     {
-        if (surface->visible())
+        if (layer.surface->visible())
         {
-            auto const tracker = rendering_trackers.find(surface.get());
-            if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
+            if (layer.tracker->is_exposed_in(id))
             {
                 // Note that we ask the surface and not a Renderable.
                 // This is because we don't want to waste time and resources
                 // on a snapshot till we're sure we need it...
-                int ready = surface->buffers_ready_for_compositor(id);
+                int ready = layer.surface->buffers_ready_for_compositor(id);
                 if (ready > result)
                     result = ready;
             }
@@ -183,8 +224,10 @@ void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
     RecursiveWriteLock lg(guard);
 
     registered_compositors.insert(cid);
+    frame_arenas[cid] = std::make_shared<FrameArena>();
 
     update_rendering_tracker_compositors();
+    publish_version();
 }
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
@@ -192,8 +235,10 @@ void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
     RecursiveWriteLock lg(guard);
 
     registered_compositors.erase(cid);
+    frame_arenas.erase(cid);
 
     update_rendering_tracker_compositors();
+    publish_version();
 }
 
 void ms::SurfaceStack::add_input_visualization(
@@ -202,6 +247,7 @@ void ms::SurfaceStack::add_input_visualization(
     {
         RecursiveWriteLock lg(guard);
         overlays.push_back(overlay);
+        publish_version();
     }
     emit_scene_changed();
 }
@@ -218,6 +264,7 @@ void ms::SurfaceStack::remove_input_visualization(
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
         overlays.erase(p);
+        publish_version();
     }
     
     emit_scene_changed();
@@ -236,10 +283,18 @@ void ms::SurfaceStack::add_surface(
     std::shared_ptr<Surface> const& surface,
     mi::InputReceptionMode input_mode)
 {
+    // Watch first, so no move is missed between reading the bounds and watching
+    auto const observer = std::make_shared<InputBoundsObserver>(
+        [this, raw_surface = surface.get()] { update_input_bounds(raw_surface); });
+    surface->add_observer(observer);
+
     {
         RecursiveWriteLock lg(guard);
         surfaces.push_back(surface);
         create_rendering_tracker_for(surface);
+        input_bounds_observers[surface.get()] = observer;
+        input_index.add(surface, surface->input_bounds());
+        publish_version();
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface.get());
@@ -252,6 +307,7 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     auto const keep_alive = surface.lock();
 
     bool found_surface = false;
+    std::shared_ptr<SurfaceObserver> input_bounds_observer;
     {
         RecursiveWriteLock lg(guard);
 
@@ -261,12 +317,17 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
         {
             surfaces.erase(surface);
             rendering_trackers.erase(keep_alive.get());
+            input_index.remove(keep_alive.get());
+            input_bounds_observer = input_bounds_observers[keep_alive.get()];
+            input_bounds_observers.erase(keep_alive.get());
+            publish_version();
             found_surface = true;
         }
     }
 
     if (found_surface)
     {
+        keep_alive->remove_observer(input_bounds_observer);
         observers.surface_removed(keep_alive.get());
 
         report->surface_removed(keep_alive.get(), keep_alive.get()->name());
@@ -274,45 +335,42 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
+auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
+-> std::shared_ptr<Surface>
 {
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
+    RecursiveReadLock lg(guard);
 
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    return input_index.topmost_at(cursor, [&](Surface& surface)
+        {
+            return surface.input_area_contains(cursor);
+        });
 }
 
-auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
--> std::shared_ptr<Surface>
+auto ms::SurfaceStack::input_surface_at(geometry::Point const& point) -> std::shared_ptr<mi::Surface>
 {
     RecursiveReadLock lg(guard);
-    for (auto const& surface : in_reverse(surfaces))
-    {
-        // TODO There's a lack of clarity about how the input area will
-        // TODO be maintained and whether this test will detect clicks on
-        // TODO decorations (it should) as these may be outside the area
-        // TODO known to the client.  But it works for now.
-        if (surface->input_area_contains(cursor))
-                return surface;
-    }
 
-    return {};
+    // The same surfaces as for_each() offers
+    return input_index.topmost_at(point, [&](Surface& surface)
+        {
+            return surface.query(mir_window_attrib_visibility) == mir_window_visibility_exposed &&
+                surface.input_area_contains(point);
+        });
 }
 
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
 {
-    RecursiveReadLock lg(guard);
-    for (auto &surface : surfaces)
+    auto const scene = std::atomic_load(&version);
+    for (auto const& layer : scene->layers)
     {
-        if (surface->query(mir_window_attrib_visibility) ==
+        if (layer.surface->query(mir_window_attrib_visibility) ==
             MirWindowVisibility::mir_window_visibility_exposed)
         {
-            callback(surface);
+            callback(layer.surface);
         }
     }
 }
@@ -331,6 +389,8 @@ void ms::SurfaceStack::raise(std::weak_ptr<Surface> const& s)
         {
             surfaces.erase(p);
             surfaces.push_back(surface);
+            input_index.restack(surfaces);
+            publish_version();
             surfaces_reordered = true;
         }
     }
@@ -354,7 +414,11 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
             [&](std::weak_ptr<Surface> const& s) { return !ss.count(s); });
 
         if (old_surfaces != surfaces)
+        {
+            input_index.restack(surfaces);
+            publish_version();
             surfaces_reordered = true;
+        }
     }
 
     if (surfaces_reordered)
@@ -378,6 +442,27 @@ void ms::SurfaceStack::update_rendering_tracker_compositors()
         pair.second->active_compositors(registered_compositors);
 }
 
+void ms::SurfaceStack::publish_version()
+{
+    // Called with guard held for writing
+    auto const next = std::make_shared<Version>();
+
+    next->layers.reserve(surfaces.size());
+    for (auto const& surface : surfaces)
+        next->layers.push_back(Version::Layer{surface, rendering_trackers[surface.get()]});
+
+    next->overlays = overlays;
+    next->frame_arenas = frame_arenas;
+
+    std::atomic_store(&version, std::shared_ptr<Version const>{next});
+}
+
+void ms::SurfaceStack::update_input_bounds(Surface* surface)
+{
+    RecursiveWriteLock lg(guard);
+    input_index.update(surface, surface->input_bounds());
+}
+
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
 {
     observers.add(observer);
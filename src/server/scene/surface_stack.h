@@ -21,6 +21,9 @@
 
 #include "mir/shell/surface_stack.h"
 
+#include "surface_index.h"
+#include "recycling_pool.h"
+
 #include "mir/compositor/scene.h"
 #include "mir/scene/observer.h"
 #include "mir/input/scene.h"
@@ -49,6 +52,7 @@ class InputRegistrar;
 class BasicSurface;
 class SceneReport;
 class RenderingTracker;
+class SurfaceObserver;
 
 class Observers : public Observer, BasicObservers<Observer>
 {
@@ -70,16 +74,18 @@ class SurfaceStack : public compositor::Scene, public input::Scene, public shell
 public:
     explicit SurfaceStack(
         std::shared_ptr<SceneReport> const& report);
-    virtual ~SurfaceStack() noexcept(true) {}
+    virtual ~SurfaceStack() noexcept(true);
 
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
+    void collect_scene_elements(compositor::CompositorID id, compositor::SceneElementSequence& elements) override;
     int frames_pending(compositor::CompositorID) const override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
 
     // From Scene
     void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) override;
+    auto input_surface_at(geometry::Point const& point) -> std::shared_ptr<input::Surface> override;
 
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
@@ -107,7 +113,10 @@ private:
     SurfaceStack& operator=(const SurfaceStack&) = delete;
     void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
     void update_rendering_tracker_compositors();
+    void update_input_bounds(Surface* surface);
+    void publish_version();
 
+    // Protects what writers change; compositors and for_each() read published versions instead
     RecursiveReadWriteMutex mutable guard;
 
     std::shared_ptr<InputRegistrar> const input_registrar;
@@ -115,10 +124,42 @@ private:
 
     std::vector<std::shared_ptr<Surface>> surfaces;
     std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
+    std::map<Surface*,std::shared_ptr<SurfaceObserver>> input_bounds_observers;
+    SurfaceIndex input_index;
     std::set<compositor::CompositorID> registered_compositors;
+
+    // What each registered compositor reuses from frame to frame
+    struct FrameArena
+    {
+        std::shared_ptr<RecyclingPool> const elements{std::make_shared<RecyclingPool>()};
+        std::vector<std::shared_ptr<graphics::Renderable>> renderables;
+    };
+    std::map<compositor::CompositorID, std::shared_ptr<FrameArena>> frame_arenas;
+    std::shared_ptr<RecyclingPool> const unregistered_elements{std::make_shared<RecyclingPool>()};
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
+    /*
+     * The scene as readers see it. Each change publishes a new version, so a
+     * reader holding one sees a consistent scene however long it takes.
+     *
+     * Readers never take the guard, so they do not wait for writers, nor
+     * writers for them. They are not lock-free: the shared_ptr atomics are
+     * implemented with a short internal lock in libstdc++.
+     */
+    struct Version
+    {
+        struct Layer
+        {
+            std::shared_ptr<Surface> surface;
+            std::shared_ptr<RenderingTracker> tracker;
+        };
+        std::vector<Layer> layers; // Bottom first
+        std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+        std::map<compositor::CompositorID, std::shared_ptr<FrameArena>> frame_arenas;
+    };
+    std::shared_ptr<Version const> version; // Only by std::atomic_load() and std::atomic_store(), not under guard
+
     Observers observers;
     std::atomic<bool> scene_changed;
 };
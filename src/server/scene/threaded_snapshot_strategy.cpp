@@ -18,6 +18,7 @@
 
 #include "threaded_snapshot_strategy.h"
 #include "pixel_buffer.h"
+#include "software_pixel_buffer.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/thread_name.h"
 
@@ -39,15 +40,16 @@ struct WorkItem
     ms::SnapshotCallback const snapshot_taken;
 };
 
+/// Hands out snapshots to take to however many threads run it
 class SnapshottingFunctor
 {
 public:
-    SnapshottingFunctor(std::shared_ptr<PixelBuffer> const& pixels)
-        : running{true}, pixels{pixels}
+    SnapshottingFunctor()
+        : running{true}
     {
     }
 
-    void operator()()
+    void operator()(std::function<void(WorkItem const&)> const& take_snapshot)
     {
         mir::set_thread_name("Mir/Snapshot");
         std::unique_lock<std::mutex> lock{work_mutex};
@@ -71,18 +73,6 @@ public:
         }
     }
 
-    void take_snapshot(WorkItem const& wi)
-    {
-        wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
-            pixels->fill_from(buffer);
-        });
-
-        wi.snapshot_taken(
-            ms::Snapshot{pixels->size(),
-                     pixels->stride(),
-                     pixels->as_argb_8888()});
-    }
-
     void schedule_snapshot(WorkItem const& wi)
     {
         std::lock_guard<std::mutex> lg{work_mutex};
@@ -94,12 +84,11 @@ public:
     {
         std::lock_guard<std::mutex> lg{work_mutex};
         running = false;
-        work_cv.notify_one();
+        work_cv.notify_all();
     }
 
 private:
     bool running;
-    std::shared_ptr<PixelBuffer> const pixels;
     std::mutex work_mutex;
     std::condition_variable work_cv;
     std::deque<WorkItem> work;
@@ -108,16 +97,67 @@ private:
 }
 }
 
+namespace
+{
+void take_snapshot(ms::PixelBuffer& pixels, ms::WorkItem const& wi)
+{
+    wi.stream->with_most_recent_buffer_do([&pixels](mir::graphics::Buffer& buffer) {
+        pixels.fill_from(buffer);
+    });
+
+    wi.snapshot_taken(
+        ms::Snapshot{pixels.size(),
+                     pixels.stride(),
+                     pixels.as_argb_8888()});
+}
+
+bool take_software_snapshot(ms::SoftwarePixelBuffer& pixels, ms::WorkItem const& wi)
+{
+    bool taken{false};
+    wi.stream->with_most_recent_buffer_do([&pixels, &taken](mir::graphics::Buffer& buffer) {
+        if ((taken = ms::SoftwarePixelBuffer::can_fill_from(buffer)))
+            pixels.fill_from(buffer);
+    });
+
+    if (taken)
+    {
+        wi.snapshot_taken(
+            ms::Snapshot{pixels.size(),
+                         pixels.stride(),
+                         pixels.as_argb_8888()});
+    }
+
+    return taken;
+}
+}
+
 ms::ThreadedSnapshotStrategy::ThreadedSnapshotStrategy(
-    std::shared_ptr<PixelBuffer> const& pixels)
+    std::shared_ptr<PixelBuffer> const& pixels,
+    unsigned int software_workers)
     : pixels{pixels},
-      functor{new SnapshottingFunctor{pixels}},
-      thread{std::ref(*functor)}
+      functor{new SnapshottingFunctor},
+      software_functor{new SnapshottingFunctor},
+      thread{std::ref(*functor), [this](WorkItem const& wi) { take_snapshot(*this->pixels, wi); }}
 {
+    for (auto i = 0u; i != software_workers; ++i)
+    {
+        software_threads.emplace_back(
+            std::ref(*software_functor),
+            [this, software_pixels = std::make_shared<SoftwarePixelBuffer>()](WorkItem const& wi)
+            {
+                if (!take_software_snapshot(*software_pixels, wi))
+                    functor->schedule_snapshot(wi);
+            });
+    }
 }
 
 ms::ThreadedSnapshotStrategy::~ThreadedSnapshotStrategy() noexcept
 {
+    // The software threads hand over to the other, so they stop first
+    software_functor->stop();
+    for (auto& software_thread : software_threads)
+        software_thread.join();
+
     functor->stop();
     thread.join();
 }
@@ -126,5 +166,8 @@ void ms::ThreadedSnapshotStrategy::take_snapshot_of(
     std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
     SnapshotCallback const& snapshot_taken)
 {
-    functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken});
+    if (software_threads.empty())
+        functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken});
+    else
+        software_functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken});
 }
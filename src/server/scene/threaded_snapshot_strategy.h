@@ -24,6 +24,7 @@
 #include <memory>
 #include <thread>
 #include <functional>
+#include <vector>
 
 namespace mir
 {
@@ -32,10 +33,17 @@ namespace scene
 class PixelBuffer;
 class SnapshottingFunctor;
 
+/**
+ * Takes snapshots away from the caller's thread.
+ *
+ * Buffers whose pixels are in CPU memory are snapshotted by up to
+ * \a software_workers threads at once, each converting pixels into memory
+ * of its own. The rest go through \a pixels, on a thread of their own.
+ */
 class ThreadedSnapshotStrategy : public SnapshotStrategy
 {
 public:
-    ThreadedSnapshotStrategy(std::shared_ptr<PixelBuffer> const& pixels);
+    ThreadedSnapshotStrategy(std::shared_ptr<PixelBuffer> const& pixels, unsigned int software_workers = 1);
     ~ThreadedSnapshotStrategy() noexcept;
 
     void take_snapshot_of(
@@ -45,7 +53,9 @@ public:
 private:
     std::shared_ptr<PixelBuffer> const pixels;
     std::unique_ptr<SnapshottingFunctor> functor;
+    std::unique_ptr<SnapshottingFunctor> software_functor;
     std::thread thread;
+    std::vector<std::thread> software_threads;
 };
 
 }
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TEST_ALLOCATION_COUNTER_H_
+#define MIR_TEST_ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+namespace mir
+{
+namespace test
+{
+/**
+ * Counts the allocations its thread makes through operator new while it
+ * exists.
+ *
+ * Counting needs the mir-test-allocation-counter objects, which replace the
+ * global operator new and delete. That affects everything in an executable,
+ * so link them only into executables of their own.
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    /// Allocations made by this thread since the counter was created
+    size_t count() const;
+
+    AllocationCounter(AllocationCounter const&) = delete;
+    AllocationCounter& operator=(AllocationCounter const&) = delete;
+
+private:
+    bool const was_counting;
+    size_t const at_start;
+};
+}
+}
+
+#endif /* MIR_TEST_ALLOCATION_COUNTER_H_ */
@@ -46,6 +46,12 @@ public:
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
+    MOCK_METHOD2(chose_latency_budget,
+                 void(compositor::CompositorReport::SubCompositorId, std::chrono::nanoseconds));
+    MOCK_METHOD1(missed_frame,
+                 void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD2(composited_output,
+                 void(compositor::CompositorReport::SubCompositorId, std::chrono::nanoseconds));
 };
 
 } // namespace doubles
@@ -53,6 +53,7 @@ struct MockMirBufferStream : public MirBufferStream
     MOCK_METHOD1(buffer_available, void(mir::protobuf::Buffer const&));
     MOCK_METHOD0(buffer_unavailable, void());
     MOCK_METHOD1(set_size, void(geometry::Size));
+    MOCK_METHOD1(set_damage, void(geometry::Rectangles const&));
     MOCK_CONST_METHOD0(size, geometry::Size());
     MOCK_METHOD1(set_scale, MirWaitHandle*(float));
     MOCK_CONST_METHOD0(get_error_message, char const*(void));
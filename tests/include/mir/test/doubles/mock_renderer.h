@@ -33,6 +33,7 @@ struct MockRenderer : public renderer::Renderer
 {
     MOCK_METHOD1(set_viewport, void(geometry::Rectangle const&));
     MOCK_METHOD2(set_output_transform, void(MirOrientation, MirMirrorMode));
+    MOCK_METHOD1(set_damage, void(geometry::Rectangles const&));
     MOCK_CONST_METHOD1(render, void(graphics::RenderableList const&));
     MOCK_METHOD0(suspend, void());
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace mt = mir::test;
+
+namespace
+{
+// Only allocations made by a thread while it has a counter count
+thread_local bool counting_allocations{false};
+thread_local size_t allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting_allocations)
+        ++allocations;
+
+    if (auto const block = std::malloc(size ? size : 1))
+        return block;
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    std::free(block);
+}
+
+mt::AllocationCounter::AllocationCounter() :
+    was_counting{counting_allocations},
+    at_start{allocations}
+{
+    counting_allocations = true;
+}
+
+mt::AllocationCounter::~AllocationCounter()
+{
+    counting_allocations = was_counting;
+}
+
+size_t mt::AllocationCounter::count() const
+{
+    return allocations - at_start;
+}
@@ -47,6 +47,7 @@ std::shared_ptr<mf::Connector> make_connector(
             std::make_shared<mtd::StubSessionAuthorizer>(),
             std::make_shared<mtd::NullPlatformIpcOperations>(),
             mr::null_message_processor_report()),
+        1,
         null_emergency_cleanup,
         report);
 }
@@ -23,6 +23,10 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <iostream>
+
+#include <stdlib.h>
+#include <unistd.h>
 
 namespace mtf = mir_test_framework;
 
@@ -113,3 +117,36 @@ TEST_F(ClientStartupPerformance, create_surface_and_swap)
     mir_connection_release(conn);
 }
 
+
+TEST_F(ClientStartupPerformance, connect_with_cached_platform_probe)
+{
+    using namespace std::chrono_literals;
+
+    char cache_dir[] = "/tmp/mir_probe_cache_XXXXXX";
+    ASSERT_THAT(mkdtemp(cache_dir), NotNull());
+    auto const cache_file = std::string{cache_dir} + "/client-platform";
+    add_to_environment("MIR_CLIENT_PLATFORM_PROBE_CACHE", cache_file.c_str());
+
+    auto const time_connection = [this]
+        {
+            auto const start = std::chrono::steady_clock::now();
+            auto const conn = create_connection();
+            auto const end = std::chrono::steady_clock::now();
+            mir_connection_release(conn);
+            return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        };
+
+    // The first connection probes every client module and fills the cache...
+    auto const cold = time_connection();
+    // ...so that the next one need only load the module that won
+    auto const warm = time_connection();
+
+    std::cout << "Connecting with an empty probe cache: " << cold.count() << "us" << std::endl;
+    std::cout << "Connecting with a primed probe cache: " << warm.count() << "us" << std::endl;
+
+    EXPECT_THAT(access(cache_file.c_str(), R_OK), Eq(0));
+    EXPECT_THAT(warm, Lt(80ms));
+
+    unlink(cache_file.c_str());
+    rmdir(cache_dir);
+}
@@ -339,3 +339,64 @@ TEST_F(AndroidInputReceiverSetup, input_comes_in_phase_with_rendering)
         ASSERT_GE(250 * one_millisecond, (t - last_in_phase));
     }
 }
+
+TEST_F(AndroidInputReceiverSetup, batching_receiver_delivers_motion_once_per_frame)
+{
+    using namespace std::literals::chrono_literals;
+
+    int motion_events{0};
+    float last_x{0};
+
+    mircva::InputReceiver receiver{
+        channel.client_fd(),
+        std::make_shared<mircv::XKBMapper>(),
+        [&](MirEvent* ev)
+        {
+            auto const touch = mir_input_event_get_touch_event(mir_event_get_input_event(ev));
+            ++motion_events;
+            last_x = mir_touch_event_axis_value(touch, 0, mir_touch_axis_x);
+        },
+        std::make_shared<mircv::NullInputReceiverReport>(),
+        [] { return mir::time::PosixTimestamp::now(CLOCK_MONOTONIC) + 20ms; }
+    };
+    TestingInputProducer producer(channel.server_fd());
+
+    auto const now = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC).nanoseconds;
+    int const nevents = 5;
+    for (int i = 0; i != nevents; ++i)
+        producer.produce_a_pointer_event(i, 0, now - (nevents - i) * 1ms);
+    flush_channels();
+
+    while (mt::fd_becomes_readable(receiver.watch_fd(), 100ms))
+        receiver.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(motion_events, testing::Eq(1));
+    EXPECT_THAT(last_x, testing::FloatEq(nevents - 1));
+}
+
+TEST_F(AndroidInputReceiverSetup, batching_receiver_without_a_frame_delivers_motion_immediately)
+{
+    using namespace std::literals::chrono_literals;
+
+    int motion_events{0};
+
+    mircva::InputReceiver receiver{
+        channel.client_fd(),
+        std::make_shared<mircv::XKBMapper>(),
+        [&](MirEvent*) { ++motion_events; },
+        std::make_shared<mircv::NullInputReceiverReport>(),
+        [] { return mir::time::PosixTimestamp{}; }
+    };
+    TestingInputProducer producer(channel.server_fd());
+
+    producer.produce_a_pointer_event(0, 0, 0ns);
+    producer.produce_a_pointer_event(1, 0, 1ms);
+    flush_channels();
+
+    EXPECT_TRUE(mt::fd_becomes_readable(receiver.watch_fd(), next_event_timeout));
+    receiver.dispatch(md::FdEvent::readable);
+    EXPECT_TRUE(mt::fd_becomes_readable(receiver.watch_fd(), 10ms));
+    receiver.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(motion_events, testing::Eq(1));
+}
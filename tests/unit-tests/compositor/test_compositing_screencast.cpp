@@ -25,6 +25,7 @@
 #include "mir/geometry/rectangle.h"
 #include "mir/geometry/rectangles.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/scene/observer.h"
 
 #include "mir/test/doubles/null_display.h"
 #include "mir/test/doubles/null_display_buffer_compositor_factory.h"
@@ -44,6 +45,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_set>
 
 namespace mc = mir::compositor;
@@ -189,6 +193,58 @@ struct StubDisplayBufferCompositorFactory : mc::DisplayBufferCompositorFactory
     StubDisplayBufferCompositor stub_db_compositor;
 };
 
+class ThreadRecordingDisplayBufferCompositor : public WrappingDisplayBufferCompositor
+{
+public:
+    ThreadRecordingDisplayBufferCompositor(
+        mc::DisplayBufferCompositor& comp, mg::DisplayBuffer& db, std::function<void()> const& record)
+        : WrappingDisplayBufferCompositor{comp, db},
+          record{record}
+    {
+        record();
+    }
+
+    ~ThreadRecordingDisplayBufferCompositor()
+    {
+        record();
+    }
+
+    void composite(mc::SceneElementSequence&& elements) override
+    {
+        record();
+        WrappingDisplayBufferCompositor::composite(std::move(elements));
+    }
+
+private:
+    std::function<void()> const record;
+};
+
+// Notes each thread its compositors are created, used or destroyed on
+struct ThreadRecordingDisplayBufferCompositorFactory : mc::DisplayBufferCompositorFactory
+{
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer& db) override
+    {
+        return std::make_unique<ThreadRecordingDisplayBufferCompositor>(
+            stub_db_compositor, db, [this] { record(); });
+    }
+
+    void record()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        threads.insert(std::this_thread::get_id());
+    }
+
+    std::set<std::thread::id> threads_used()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return threads;
+    }
+
+    StubDisplayBufferCompositor stub_db_compositor;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+};
+
 MATCHER_P(DisplayBufferCoversArea, output_extents, "")
 {
     return arg.view_area() == output_extents;
@@ -350,6 +406,51 @@ TEST_F(CompositingScreencastTest, captures_to_buffer_by_compositing_with_reserve
     screencast.capture(session_id, mt::fake_shared(stub_buffer));
 }
 
+TEST_F(CompositingScreencastTest, creates_uses_and_destroys_its_compositor_only_on_the_session_thread)
+{
+    ThreadRecordingDisplayBufferCompositorFactory recording_db_compositor_factory;
+    mtd::StubGLBuffer stub_buffer;
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(stub_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(recording_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+    screencast_local.capture(session_id);
+    screencast_local.capture(session_id, mt::fake_shared(stub_buffer));
+    screencast_local.destroy_session(session_id);
+
+    auto const threads = recording_db_compositor_factory.threads_used();
+    EXPECT_THAT(threads.size(), testing::Eq(1u));
+    EXPECT_THAT(threads.count(std::this_thread::get_id()), testing::Eq(0u));
+}
+
+TEST_F(CompositingScreencastTest, throws_on_creation_when_the_compositor_cannot_be_created)
+{
+    using namespace testing;
+
+    NiceMock<mtd::MockScene> mock_scene;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_))
+        .WillOnce(Throw(std::runtime_error{"no compositor"}));
+    EXPECT_CALL(mock_scene, unregister_compositor(_));
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(mock_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    EXPECT_THROW(screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode), std::runtime_error);
+}
+
 TEST_F(CompositingScreencastTest, allocates_and_uses_buffer_with_provided_size)
 {
     using namespace testing;
@@ -487,16 +588,19 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
     MockBufferAllocator mock_buffer_allocator;
     int const expected_num_buffers = 4;
     std::vector<mtd::StubGLBuffer> buffers(expected_num_buffers);
-
+    NiceMock<mtd::MockScene> mock_scene;
 
     EXPECT_CALL(mock_buffer_allocator, alloc_buffer(_))
         .WillOnce(Return(mt::fake_shared(buffers[0])))
         .WillOnce(Return(mt::fake_shared(buffers[1])))
         .WillOnce(Return(mt::fake_shared(buffers[2])))
         .WillOnce(Return(mt::fake_shared(buffers[3])));
+    // A scene that keeps changing, so that there is always a new frame to capture
+    ON_CALL(mock_scene, frames_pending(_))
+        .WillByDefault(Return(1));
 
     mc::CompositingScreencast screencast_local{
-        mt::fake_shared(stub_scene),
+        mt::fake_shared(mock_scene),
         mt::fake_shared(stub_display),
         mt::fake_shared(mock_buffer_allocator),
         mt::fake_shared(stub_db_compositor_factory)};
@@ -505,11 +609,41 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
         default_region, default_size, default_pixel_format,
         expected_num_buffers, default_mirror_mode);
 
-    for (int i = 0; i < expected_num_buffers; i++)
+    for (int i = 0; i < 2 * expected_num_buffers; i++)
     {
         auto buffer = screencast_local.capture(session_id);
-        ASSERT_EQ(&buffers[i], buffer.get());
+        ASSERT_THAT(buffer.get(), AnyOf(&buffers[0], &buffers[1], &buffers[2], &buffers[3]));
     }
 }
 
+TEST_F(CompositingScreencastTest, composites_again_only_once_the_scene_changes)
+{
+    using namespace testing;
+
+    NiceMock<mtd::MockScene> mock_scene;
+    NiceMock<MockDisplayBufferCompositorFactory> mock_db_compositor_factory;
+    std::shared_ptr<mir::scene::Observer> observer;
+
+    EXPECT_CALL(mock_scene, add_observer(_))
+        .WillOnce(SaveArg<0>(&observer));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(2);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(mock_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    auto const first = screencast_local.capture(session_id);
+    EXPECT_THAT(screencast_local.capture(session_id), Eq(first));
 
+    ASSERT_THAT(observer, NotNull());
+    observer->scene_changed();
+
+    EXPECT_THAT(screencast_local.capture(session_id), Ne(first));
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+struct DamageTracker : Test
+{
+    geom::Rectangle const screen{{0, 0}, {1920, 1080}};
+    std::shared_ptr<mtd::FakeRenderable> const background{
+        std::make_shared<mtd::FakeRenderable>(screen)};
+    std::shared_ptr<mtd::FakeRenderable> const clock{
+        std::make_shared<mtd::FakeRenderable>(1800, 10, 20, 20)};
+    mc::DamageTracker tracker;
+};
+}
+
+TEST_F(DamageTracker, first_frame_is_fully_damaged)
+{
+    EXPECT_THAT(tracker.damage_for({background, clock}, screen),
+                Eq(geom::Rectangles{screen}));
+}
+
+TEST_F(DamageTracker, unchanged_frame_has_no_damage)
+{
+    tracker.damage_for({background, clock}, screen);
+
+    EXPECT_THAT(tracker.damage_for({background, clock}, screen),
+                Eq(geom::Rectangles{}));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_only_its_renderable)
+{
+    tracker.damage_for({background, clock}, screen);
+
+    clock->set_buffer(std::make_shared<mtd::StubBuffer>());
+
+    EXPECT_THAT(tracker.damage_for({background, clock}, screen),
+                Eq(geom::Rectangles{clock->screen_position()}));
+}
+
+TEST_F(DamageTracker, added_and_removed_renderables_are_damaged)
+{
+    auto const window = std::make_shared<mtd::FakeRenderable>(100, 100, 50, 50);
+
+    tracker.damage_for({background, clock}, screen);
+    EXPECT_THAT(tracker.damage_for({background, clock, window}, screen),
+                Eq(geom::Rectangles{window->screen_position()}));
+    EXPECT_THAT(tracker.damage_for({background, clock}, screen),
+                Eq(geom::Rectangles{window->screen_position()}));
+}
+
+TEST_F(DamageTracker, damage_is_clipped_to_the_area)
+{
+    auto const window = std::make_shared<mtd::FakeRenderable>(1900, 1000, 50, 100);
+
+    tracker.damage_for({background}, screen);
+
+    EXPECT_THAT(tracker.damage_for({background, window}, screen),
+                Eq(geom::Rectangles{{{1900, 1000}, {20, 80}}}));
+}
+
+TEST_F(DamageTracker, reset_causes_full_damage)
+{
+    tracker.damage_for({background, clock}, screen);
+    tracker.reset();
+
+    EXPECT_THAT(tracker.damage_for({background, clock}, screen),
+                Eq(geom::Rectangles{screen}));
+}
+
+TEST_F(DamageTracker, change_of_area_causes_full_damage)
+{
+    geom::Rectangle const rotated{{0, 0}, {1080, 1920}};
+
+    tracker.damage_for({background, clock}, screen);
+
+    EXPECT_THAT(tracker.damage_for({background, clock}, rotated),
+                Eq(geom::Rectangles{rotated}));
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "src/server/compositor/frame_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::literals::chrono_literals;
+namespace mc = mir::compositor;
+
+namespace
+{
+struct FrameScheduler : Test
+{
+    // A 60Hz display whose last vblank was frame 100
+    void display_vblanks()
+    {
+        for (int64_t msc = 98; msc <= 100; ++msc)
+            scheduler.frame_displayed(msc, vblank_100 + (msc - 100) * period);
+    }
+
+    void render_frames(int count, std::chrono::nanoseconds render_time)
+    {
+        for (int i = 0; i != count; ++i)
+        {
+            scheduler.frame_started(vblank_100 - 10ms);
+            scheduler.frame_rendered(vblank_100 - 10ms + render_time);
+        }
+    }
+
+    std::chrono::nanoseconds const period{16666667};
+    mc::FrameScheduler::TimePoint const vblank_100{1h};
+    mc::FrameScheduler::TimePoint const fallback{vblank_100 + 5ms};
+    mc::FrameScheduler scheduler;
+};
+}
+
+TEST_F(FrameScheduler, falls_back_until_it_knows_the_display_timing)
+{
+    EXPECT_THAT(scheduler.next_start(vblank_100 + 1ms, fallback), Eq(fallback));
+
+    render_frames(10, 4ms);
+    EXPECT_THAT(scheduler.next_start(vblank_100 + 1ms, fallback), Eq(fallback));
+    EXPECT_FALSE(scheduler.targets_vblank());
+}
+
+TEST_F(FrameScheduler, starts_a_latency_budget_ahead_of_the_next_vblank)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+
+    auto const budget = scheduler.latency_budget();
+    EXPECT_THAT(budget, AllOf(Ge(4ms), Lt(8ms)));
+
+    EXPECT_THAT(scheduler.next_start(vblank_100 + 1ms, fallback), Eq(vblank_100 + period - budget));
+    EXPECT_TRUE(scheduler.targets_vblank());
+}
+
+TEST_F(FrameScheduler, skips_to_the_following_vblank_if_there_is_no_time_to_render)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+
+    auto const budget = scheduler.latency_budget();
+    auto const too_late = vblank_100 + period - budget + 1ms;
+
+    EXPECT_THAT(scheduler.next_start(too_late, fallback), Eq(vblank_100 + 2 * period - budget));
+}
+
+TEST_F(FrameScheduler, budget_follows_slow_frames)
+{
+    display_vblanks();
+    render_frames(64, 4ms);
+    auto const fast_budget = scheduler.latency_budget();
+
+    render_frames(16, 9ms);
+
+    EXPECT_THAT(scheduler.latency_budget(), Eq(fast_budget + 5ms));
+}
+
+TEST_F(FrameScheduler, a_missed_vblank_widens_the_margin)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+    auto const budget = scheduler.latency_budget();
+
+    auto const start = scheduler.next_start(vblank_100 + 1ms, fallback);
+    scheduler.frame_started(start);
+    EXPECT_FALSE(scheduler.frame_rendered(start + 4ms));
+    EXPECT_TRUE(scheduler.frame_displayed(102, vblank_100 + 2 * period));
+
+    EXPECT_THAT(scheduler.latency_budget(), Gt(budget));
+}
+
+TEST_F(FrameScheduler, a_frame_rendered_after_its_vblank_is_missed)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+
+    auto const start = scheduler.next_start(vblank_100 + 1ms, fallback);
+    scheduler.frame_started(start);
+
+    EXPECT_TRUE(scheduler.frame_rendered(vblank_100 + period + 1ms));
+}
+
+TEST_F(FrameScheduler, a_frame_shown_on_its_vblank_is_not_missed)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+
+    auto const start = scheduler.next_start(vblank_100 + 1ms, fallback);
+    scheduler.frame_started(start);
+
+    EXPECT_FALSE(scheduler.frame_rendered(start + 4ms));
+    EXPECT_FALSE(scheduler.frame_displayed(101, vblank_100 + period));
+}
+
+TEST_F(FrameScheduler, starts_straight_away_if_rendering_takes_longer_than_a_frame)
+{
+    display_vblanks();
+    render_frames(10, 20ms);
+
+    auto const now = vblank_100 + 1ms;
+    EXPECT_THAT(scheduler.next_start(now, fallback), Eq(now));
+    EXPECT_FALSE(scheduler.targets_vblank());
+}
+
+TEST_F(FrameScheduler, falls_back_once_the_last_vblank_is_stale)
+{
+    display_vblanks();
+    render_frames(10, 4ms);
+
+    EXPECT_THAT(scheduler.next_start(vblank_100 + 2s, fallback), Eq(fallback));
+}
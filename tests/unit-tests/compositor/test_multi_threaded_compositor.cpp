@@ -388,6 +388,39 @@ TEST(MultiThreadedCompositor, compositing_happens_in_different_threads)
     EXPECT_TRUE(db_compositor_factory->buffers_rendered_in_different_threads());
 }
 
+TEST(MultiThreadedCompositor, composites_the_outputs_of_a_group_in_parallel_when_asked_to)
+{
+    using namespace testing;
+
+    struct SingleGroupDisplay : mtd::NullDisplay
+    {
+        void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+        {
+            f(group);
+        }
+
+        mtd::StubDisplaySyncGroup group{{{{0, 0}, {640, 480}}, {{640, 0}, {640, 480}}, {{1280, 0}, {640, 480}}}};
+    };
+
+    unsigned int const nbuffers{3};
+
+    auto display = std::make_shared<SingleGroupDisplay>();
+    auto scene = std::make_shared<StubScene>();
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{
+        display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, true};
+
+    compositor.start();
+
+    while (!db_compositor_factory->enough_records_gathered(nbuffers, 100))
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    EXPECT_TRUE(db_compositor_factory->each_buffer_rendered_in_single_thread());
+    EXPECT_TRUE(db_compositor_factory->buffers_rendered_in_different_threads());
+}
+
 TEST(MultiThreadedCompositor, does_not_deadlock_itself)
 {   // Regression test for LP: #1471909
     auto scene = std::make_shared<StubScene>();
@@ -457,6 +490,8 @@ TEST(MultiThreadedCompositor, reports_in_the_right_places)
         .Times(1);
     EXPECT_CALL(*mock_report, scheduled())
         .Times(2);
+    EXPECT_CALL(*mock_report, composited_output(_,_))
+        .Times(AtLeast(1));
 
     EXPECT_CALL(*mock_report, stopped())
         .Times(AtLeast(1));
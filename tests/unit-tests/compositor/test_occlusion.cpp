@@ -202,3 +202,16 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_windows_together_is_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(50, 50, 200, 100);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 150, 200);
+    auto const right = std::make_shared<mtd::FakeRenderable>(150, 0, 150, 200);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/default_display_buffer_compositor.h"
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/scene/surface_creation_parameters.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/test/doubles/stub_renderer.h"
+#include "mir/test/allocation_counter.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mr = mir::report;
+namespace geom = mir::geometry;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+struct SteadyStateCompositing : testing::Test
+{
+    SteadyStateCompositing()
+    {
+        stack.register_compositor(compositor_id);
+
+        // Overlapping, so that the compositor has occlusions to work out too
+        for (auto const& area : {geom::Rectangle{{0, 0}, {1366, 768}},
+                                 geom::Rectangle{{100, 100}, {640, 480}},
+                                 geom::Rectangle{{200, 150}, {100, 100}},
+                                 geom::Rectangle{{1000, 400}, {200, 300}}})
+        {
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                std::string("a rather long window title, so that copying it would allocate"),
+                area,
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+                std::shared_ptr<mir::input::InputChannel>(),
+                std::shared_ptr<mir::input::InputSender>(),
+                std::shared_ptr<mg::CursorImage>(),
+                report);
+            stack.add_surface(surface, mir::input::InputReceptionMode::normal);
+        }
+    }
+
+    ~SteadyStateCompositing()
+    {
+        stack.unregister_compositor(compositor_id);
+    }
+
+    void composite_frames(int frames)
+    {
+        for (int i = 0; i != frames; ++i)
+        {
+            stack.collect_scene_elements(compositor_id, elements);
+            compositor.composite(std::move(elements));
+            elements.clear();
+        }
+    }
+
+    std::shared_ptr<ms::SceneReport> const report = mr::null_scene_report();
+    ms::SurfaceStack stack{report};
+    mtd::StubDisplayBuffer display_buffer{geom::Rectangle{{0, 0}, {1366, 768}}};
+    mc::DefaultDisplayBufferCompositor compositor{
+        display_buffer,
+        std::make_shared<mtd::StubRenderer>(),
+        mr::null_compositor_report()};
+    mc::CompositorID const compositor_id{&compositor};
+    mc::SceneElementSequence elements;
+};
+}
+
+TEST_F(SteadyStateCompositing, does_not_allocate_once_warmed_up)
+{
+    composite_frames(3);
+
+    mt::AllocationCounter const allocations;
+    composite_frames(100);
+    auto const allocated = allocations.count();
+
+    EXPECT_THAT(allocated, testing::Eq(0u));
+}
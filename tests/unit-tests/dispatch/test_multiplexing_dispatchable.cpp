@@ -490,3 +490,44 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, dispatches_every_ready_dispatchee_in_one_call)
+{
+    int dispatched{0};
+    auto dispatchee_a = std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; });
+    auto dispatchee_b = std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; });
+    auto dispatchee_c = std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; });
+
+    md::MultiplexingDispatchable dispatcher{dispatchee_a, dispatchee_b, dispatchee_c};
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+    dispatchee_c->trigger();
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, testing::Eq(3));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, does_not_dispatch_dispatchee_removed_earlier_in_the_same_call)
+{
+    md::MultiplexingDispatchable dispatcher;
+
+    int dispatched{0};
+    std::shared_ptr<mt::TestDispatchable> first, second;
+    // Whichever is dispatched first removes the other
+    first = std::make_shared<mt::TestDispatchable>([&]() { ++dispatched; dispatcher.remove_watch(second); });
+    second = std::make_shared<mt::TestDispatchable>([&]() { ++dispatched; dispatcher.remove_watch(first); });
+
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(second);
+
+    first->trigger();
+    second->trigger();
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, testing::Eq(1));
+}
@@ -24,6 +24,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <mutex>
+
 namespace mt = mir::test;
 
 namespace
@@ -33,10 +35,14 @@ struct StubConnectorReport : mir::report::null::ConnectorReport
 {
     void thread_start()
     {
+        std::lock_guard<std::mutex> lock{mutex};
         thread_name = mt::current_thread_name();
+        ++threads_started;
     }
 
+    std::mutex mutex;
     std::string thread_name;
+    int threads_started = 0;
 };
 
 }
@@ -47,10 +53,24 @@ TEST(BasicConnector, names_ipc_threads)
 
     StubConnectorReport report;
 
-    mir::frontend::BasicConnector connector{{}, mt::fake_shared(report)};
+    mir::frontend::BasicConnector connector{{}, 1, mt::fake_shared(report)};
 
     connector.start();
     connector.stop();
 
     EXPECT_THAT(report.thread_name, Eq("Mir/IPC"));
 }
+
+TEST(BasicConnector, runs_the_requested_number_of_ipc_threads)
+{
+    using namespace testing;
+
+    StubConnectorReport report;
+
+    mir::frontend::BasicConnector connector{{}, 3, mt::fake_shared(report)};
+
+    connector.start();
+    connector.stop();
+
+    EXPECT_THAT(report.threads_started, Eq(3));
+}
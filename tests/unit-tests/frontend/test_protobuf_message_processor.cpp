@@ -38,21 +38,27 @@ namespace
 {
 struct StubProtobufMessageSender : mfd::ProtobufMessageSender
 {
-    void send_response(gp::uint32, gp::MessageLite*, mf::FdSets const&) override
+    void send_response(gp::uint32, gp::MessageLite* response, mf::FdSets const&) override
     {
+        if (auto connection = dynamic_cast<mp::Connection*>(response))
+            connect_result = *connection;
     }
+
+    mp::Connection connect_result;
 };
 
 struct StubMessageProcessorReport : mf::MessageProcessorReport
 {
-    void received_invocation(void const*, int, std::string const&) override
+    void received_invocation(void const*, int, std::string const& method) override
     {
+        received_method = method;
     }
     void completed_invocation(void const*, int, bool) override
     {
     }
     void unknown_method(void const*, int, std::string const&) override
     {
+        unknown_method_reported = true;
     }
     void exception_handled(void const*, int, std::exception const&) override
     {
@@ -60,10 +66,21 @@ struct StubMessageProcessorReport : mf::MessageProcessorReport
     void exception_handled(void const*, std::exception const&) override
     {
     }
+
+    std::string received_method;
+    bool unknown_method_reported{false};
 };
 
 struct StubDisplayServer : mtd::StubDisplayServer
 {
+    void connect(
+        mp::ConnectParameters const*,
+        mp::Connection*,
+        google::protobuf::Closure* closure) override
+    {
+        closure->Run();
+    }
+
     void create_surface(
         mp::SurfaceParameters const*,
         mp::Surface* response,
@@ -85,10 +102,12 @@ struct StubDisplayServer : mtd::StubDisplayServer
         closure->Run();
         auto after = response->has_buffer();
         changed_during_create_bstream_closure = before != after;
+        ++buffer_streams_created;
     }
 
     bool changed_during_create_surface_closure;
     bool changed_during_create_bstream_closure;
+    int buffer_streams_created{0};
 };
 }
 
@@ -151,3 +170,80 @@ TEST(ProtobufMessageProcessor, doesnt_inject_buffers_when_creating_bstream)
     mp->dispatch(invocation, fds);
     EXPECT_FALSE(stub_display_server.changed_during_create_bstream_closure);
 }
+
+TEST(ProtobufMessageProcessor, dispatches_invocations_sent_by_method_id)
+{
+    using namespace testing;
+    StubProtobufMessageSender stub_msg_sender;
+    StubMessageProcessorReport stub_report;
+    StubDisplayServer stub_display_server;
+    mfd::ProtobufMessageProcessor pb_message_processor(
+        mt::fake_shared(stub_msg_sender),
+        mt::fake_shared(stub_display_server),
+        mt::fake_shared(stub_report));
+    std::shared_ptr<mfd::MessageProcessor> mp = mt::fake_shared(pb_message_processor);
+
+    mpw::Invocation raw_invocation;
+    mp::BufferStreamParameters request;
+    request.set_width(1);
+    request.set_height(1);
+    request.set_pixel_format(1);
+    request.set_buffer_usage(1);
+    std::string str_parameters;
+    request.SerializeToString(&str_parameters);
+    raw_invocation.set_parameters(str_parameters);
+    raw_invocation.set_method_name("");
+    raw_invocation.set_method_id(static_cast<gp::uint32>(mp::MethodId::create_buffer_stream));
+    mfd::Invocation invocation(raw_invocation);
+
+    std::vector<mir::Fd> fds;
+    EXPECT_TRUE(mp->dispatch(invocation, fds));
+    EXPECT_THAT(stub_display_server.buffer_streams_created, Eq(1));
+    EXPECT_THAT(stub_report.received_method, StrEq("create_buffer_stream"));
+}
+
+TEST(ProtobufMessageProcessor, reports_unknown_method_ids)
+{
+    using namespace testing;
+    StubProtobufMessageSender stub_msg_sender;
+    StubMessageProcessorReport stub_report;
+    StubDisplayServer stub_display_server;
+    mfd::ProtobufMessageProcessor pb_message_processor(
+        mt::fake_shared(stub_msg_sender),
+        mt::fake_shared(stub_display_server),
+        mt::fake_shared(stub_report));
+    std::shared_ptr<mfd::MessageProcessor> mp = mt::fake_shared(pb_message_processor);
+
+    mpw::Invocation raw_invocation;
+    raw_invocation.set_method_name("");
+    raw_invocation.set_method_id(static_cast<gp::uint32>(mp::MethodId::count));
+    mfd::Invocation invocation(raw_invocation);
+
+    std::vector<mir::Fd> fds;
+    EXPECT_FALSE(mp->dispatch(invocation, fds));
+    EXPECT_TRUE(stub_report.unknown_method_reported);
+}
+
+TEST(ProtobufMessageProcessor, tells_clients_on_connect_that_method_ids_are_accepted)
+{
+    using namespace testing;
+    StubProtobufMessageSender stub_msg_sender;
+    StubMessageProcessorReport stub_report;
+    StubDisplayServer stub_display_server;
+    mfd::ProtobufMessageProcessor pb_message_processor(
+        mt::fake_shared(stub_msg_sender),
+        mt::fake_shared(stub_display_server),
+        mt::fake_shared(stub_report));
+    std::shared_ptr<mfd::MessageProcessor> mp = mt::fake_shared(pb_message_processor);
+
+    mpw::Invocation raw_invocation;
+    mp::ConnectParameters request;
+    request.set_application_name("client");
+    raw_invocation.set_parameters(request.SerializeAsString());
+    raw_invocation.set_method_name("connect");
+    mfd::Invocation invocation(raw_invocation);
+
+    std::vector<mir::Fd> fds;
+    mp->dispatch(invocation, fds);
+    EXPECT_TRUE(stub_msg_sender.connect_result.method_ids_accepted());
+}
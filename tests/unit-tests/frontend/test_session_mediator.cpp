@@ -822,6 +822,29 @@ TEST_F(SessionMediator, configures_swap_intervals_on_streams)
     mediator.configure_buffer_stream(&request, &response, null_callback.get());
 }
 
+TEST_F(SessionMediator, passes_client_damage_to_stream)
+{
+    mf::BufferStreamId stream_id{42};
+    mp::BufferRequest request;
+    mp::Void response;
+
+    request.mutable_id()->set_value(stream_id.as_value());
+    request.mutable_buffer()->set_buffer_id(7);
+    auto const damage = request.add_damage();
+    damage->set_left(10);
+    damage->set_top(20);
+    damage->set_width(30);
+    damage->set_height(40);
+
+    auto stream = stubbed_session->create_mock_stream(stream_id);
+    EXPECT_CALL(*stream, submit_buffer(_, Eq(geom::Rectangles{{{10, 20}, {30, 40}}})));
+    EXPECT_CALL(*stream, submit_buffer(_))
+        .Times(0);
+
+    mediator.connect(&connect_parameters, &connection, null_callback.get());
+    mediator.submit_buffer(&request, &response, null_callback.get());
+}
+
 namespace
 {
 MATCHER(IsReplyWithEvents, "")
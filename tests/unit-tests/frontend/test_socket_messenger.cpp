@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/socket_messenger.h"
+#include "mir/fd_socket_transmission.h"
+#include "mir/fd.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace ba = boost::asio;
+
+using namespace testing;
+
+namespace
+{
+struct SocketMessenger : Test
+{
+    SocketMessenger()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+            throw std::runtime_error("Failed to create socket pair");
+
+        client_fd = mir::Fd{fds[1]};
+        auto const socket = std::make_shared<ba::local::stream_protocol::socket>(
+            io_service, ba::local::stream_protocol(), fds[0]);
+        messenger = std::make_shared<mfd::SocketMessenger>(socket);
+    }
+
+    std::vector<char> message(size_t size, char content)
+    {
+        std::vector<char> result(size + 2, content);
+        result[0] = static_cast<char>(size >> 8);
+        result[1] = static_cast<char>(size);
+        return result;
+    }
+
+    std::vector<char> receive(size_t size)
+    {
+        std::vector<char> result(size);
+        std::vector<mir::Fd> no_fds;
+        mir::receive_data(client_fd, result.data(), size, no_fds);
+        return result;
+    }
+
+    ba::io_service io_service;
+    mir::Fd client_fd;
+    std::shared_ptr<mfd::SocketMessenger> messenger;
+};
+}
+
+TEST_F(SocketMessenger, sends_header_and_body)
+{
+    std::vector<char> const body(100, 'x');
+
+    messenger->send(body.data(), body.size(), {});
+
+    EXPECT_THAT(receive(102), ContainerEq(message(100, 'x')));
+}
+
+TEST_F(SocketMessenger, sends_fds_after_the_message)
+{
+    std::vector<char> const body(10, 'x');
+    mir::Fd const file{fileno(tmpfile())};
+
+    messenger->send(body.data(), body.size(), {{file}});
+
+    EXPECT_THAT(receive(12), ContainerEq(message(10, 'x')));
+
+    char dummy;
+    std::vector<mir::Fd> fds(1);
+    mir::receive_data(client_fd, &dummy, 1, fds);
+    EXPECT_THAT(fds[0], Ge(0));
+}
+
+TEST_F(SocketMessenger, does_not_block_when_the_client_is_not_reading)
+{
+    // Far more than the socket will buffer
+    int const messages{256};
+    std::vector<char> body(4000);
+
+    for (int i = 0; i != messages; ++i)
+    {
+        std::fill(body.begin(), body.end(), static_cast<char>(i));
+        messenger->send(body.data(), body.size(), {});
+    }
+
+    // The rest are written as the client makes room
+    std::thread writer{[this] { io_service.run(); }};
+
+    for (int i = 0; i != messages; ++i)
+        EXPECT_THAT(receive(4002), ContainerEq(message(4000, static_cast<char>(i))));
+
+    io_service.stop();
+    writer.join();
+}
+
+TEST_F(SocketMessenger, gives_up_on_a_client_that_never_reads)
+{
+    std::vector<char> const body(60000);
+
+    EXPECT_THROW(
+        for (int i = 0; i != 1000; ++i)
+            messenger->send(body.data(), body.size(), {}),
+        std::runtime_error);
+}
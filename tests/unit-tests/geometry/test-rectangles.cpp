@@ -285,3 +285,45 @@ TEST_F(TestRectangles, remove_only_removes_one_instance)
         EXPECT_THAT(rectangles.size(), Eq(i));
     }
 }
+
+TEST_F(TestRectangles, subtract_splits_around_the_hole)
+{
+    rectangles.add({{0, 0}, {300, 300}});
+
+    rectangles.subtract({{100, 100}, {100, 100}});
+
+    EXPECT_THAT(contents_of(rectangles), UnorderedElementsAre(
+        Rectangle{{0, 0}, {300, 100}},
+        Rectangle{{0, 200}, {300, 100}},
+        Rectangle{{0, 100}, {100, 100}},
+        Rectangle{{200, 100}, {100, 100}}));
+}
+
+TEST_F(TestRectangles, subtract_leaves_disjoint_rectangles_alone)
+{
+    Rectangle const rectangle{{0, 0}, {100, 100}};
+    rectangles.add(rectangle);
+
+    rectangles.subtract({{100, 0}, {100, 100}});
+
+    EXPECT_THAT(contents_of(rectangles), ElementsAre(rectangle));
+}
+
+TEST_F(TestRectangles, subtract_of_enclosing_rectangle_removes_everything)
+{
+    rectangles.add({{10, 10}, {100, 100}});
+    rectangles.add({{50, 50}, {10, 10}});
+
+    rectangles.subtract({{0, 0}, {200, 200}});
+
+    EXPECT_THAT(rectangles.size(), Eq(0u));
+}
+
+TEST_F(TestRectangles, covers_rectangle_spanning_several_members)
+{
+    rectangles.add({{0, 0}, {100, 200}});
+    rectangles.add({{100, 0}, {100, 200}});
+
+    EXPECT_TRUE(rectangles.covers({{50, 50}, {100, 100}}));
+    EXPECT_FALSE(rectangles.covers({{150, 50}, {100, 100}}));
+}
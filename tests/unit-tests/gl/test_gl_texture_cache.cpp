@@ -21,6 +21,7 @@
 #include "mir/test/doubles/mock_gl_buffer.h"
 #include "mir/test/doubles/mock_renderable.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/renderer/gl/partial_texture_source.h"
 #include <gtest/gtest.h>
 
 namespace mtd=mir::test::doubles;
@@ -30,6 +31,13 @@ namespace mg=mir::graphics;
 namespace
 {
 
+struct MockPartialGLBuffer : mtd::MockGLBuffer, mir::renderer::gl::PartialTextureSource
+{
+    MOCK_CONST_METHOD0(frame, uint64_t());
+    MOCK_METHOD3(set_damage, void(uint64_t, uint64_t, mir::geometry::Rectangles const&));
+    MOCK_METHOD1(bind_changes_since, bool(uint64_t));
+};
+
 class RecentlyUsedCache : public testing::Test
 {
 public:
@@ -140,3 +148,35 @@ TEST_F(RecentlyUsedCache, invalidated_buffers_are_reloaded)
     cache.invalidate();
     cache.load(*renderable);
 }
+
+TEST_F(RecentlyUsedCache, uploads_only_changes_since_the_frame_in_the_texture)
+{
+    using namespace testing;
+    auto const partial_buffer = std::make_shared<NiceMock<MockPartialGLBuffer>>();
+    ON_CALL(*renderable, buffer())
+        .WillByDefault(Return(partial_buffer));
+
+    EXPECT_CALL(*partial_buffer, bind())
+        .Times(2);
+    EXPECT_CALL(*partial_buffer, bind_changes_since(1))
+        .WillOnce(Return(true));
+
+    mgl::RecentlyUsedCache cache;
+
+    ON_CALL(*partial_buffer, id())
+        .WillByDefault(Return(mg::BufferID(123)));
+    ON_CALL(*partial_buffer, frame())
+        .WillByDefault(Return(1));
+    cache.load(*renderable);
+
+    ON_CALL(*partial_buffer, id())
+        .WillByDefault(Return(mg::BufferID(456)));
+    ON_CALL(*partial_buffer, frame())
+        .WillByDefault(Return(2));
+    cache.load(*renderable);
+
+    cache.invalidate();
+    ON_CALL(*partial_buffer, frame())
+        .WillByDefault(Return(3));
+    cache.load(*renderable);
+}
@@ -199,3 +199,90 @@ TEST_F(ShmBufferTest, uploads_abgr_8888_correctly)
     PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_abgr_8888);
     buf.gl_bind_to_texture();
 }
+
+TEST_F(ShmBufferTest, uploads_only_damage_to_texture_holding_previous_frame)
+{
+    auto const ext = reinterpret_cast<GLubyte const*>("GL_EXT_unpack_subimage");
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(ext));
+
+    auto const stride = 2 * size.width.as_int();
+    auto const damaged_pixels =
+        static_cast<char*>(stub_shm_file->fake_mapping) + 20 * stride + 10 * 2;
+
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, size.width.as_int()));
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 10, 20, 30, 40,
+                                         GL_RGB, GL_UNSIGNED_SHORT_5_6_5,
+                                         damaged_pixels));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0));
+    EXPECT_CALL(mock_gl, glTexImage2D(_,_,_,_,_,_,_,_,_))
+        .Times(0);
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_rgb_565);
+    buf.set_damage(2, 1, geom::Rectangles{{{10, 20}, {30, 40}}});
+    EXPECT_TRUE(buf.bind_changes_since(1));
+}
+
+TEST_F(ShmBufferTest, sets_unpack_row_length_in_pixels_of_the_stride)
+{
+    auto const ext = reinterpret_cast<GLubyte const*>("GL_EXT_unpack_subimage");
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(ext));
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_rgb_888);
+
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, buf.stride().as_int() / 3));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0));
+
+    buf.set_damage(2, 1, geom::Rectangles{{{10, 20}, {30, 40}}});
+    EXPECT_TRUE(buf.bind_changes_since(1));
+}
+
+TEST_F(ShmBufferTest, looks_for_unpack_row_length_support_only_once)
+{
+    auto const ext = reinterpret_cast<GLubyte const*>("GL_EXT_unpack_subimage");
+    EXPECT_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .Times(AtMost(1))
+        .WillRepeatedly(Return(ext));
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_rgb_565);
+    for (uint64_t frame = 2; frame != 5; ++frame)
+    {
+        buf.set_damage(frame, frame - 1, geom::Rectangles{{{10, 20}, {30, 40}}});
+        EXPECT_TRUE(buf.bind_changes_since(frame - 1));
+    }
+}
+
+TEST_F(ShmBufferTest, uploads_damaged_stripes_without_unpack_row_length)
+{
+    auto const stride = 2 * size.width.as_int();
+    auto const damaged_rows =
+        static_cast<char*>(stub_shm_file->fake_mapping) + 20 * stride;
+
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 20, size.width.as_int(), 40,
+                                         GL_RGB, GL_UNSIGNED_SHORT_5_6_5,
+                                         damaged_rows));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, _))
+        .Times(0);
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_rgb_565);
+    buf.set_damage(2, 1, geom::Rectangles{{{10, 20}, {30, 40}}});
+    EXPECT_TRUE(buf.bind_changes_since(1));
+}
+
+TEST_F(ShmBufferTest, refuses_partial_upload_to_texture_holding_another_frame)
+{
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_,_,_,_,_,_,_,_,_))
+        .Times(0);
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_rgb_565);
+    buf.set_damage(5, 3, geom::Rectangles{{{10, 20}, {30, 40}}});
+    EXPECT_FALSE(buf.bind_changes_since(4));
+    EXPECT_FALSE(buf.bind_changes_since(0));
+    EXPECT_THAT(buf.frame(), Eq(5u));
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/shm_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef F_GET_SEALS
+#define F_GET_SEALS (1024 + 10)
+#endif
+
+namespace mgc = mir::graphics::common;
+
+namespace
+{
+size_t const page_size{4096};
+size_t const max_cached{1024 * 1024};
+}
+
+TEST(ShmPool, size_classes_waste_at_most_a_quarter)
+{
+    for (size_t size = 1; size < 64 * 1024 * 1024; size = size * 3 / 2 + 1)
+    {
+        auto const size_class = mgc::ShmPool::size_class_for(size);
+        EXPECT_GE(size_class, size);
+        EXPECT_EQ(0u, size_class % page_size);
+        if (size > 64 * 1024)
+        {
+            EXPECT_LE(size_class, size + size / 4) << "size=" << size;
+        }
+    }
+}
+
+TEST(ShmPool, files_are_at_least_as_large_as_asked_for)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(max_cached);
+    size_t const file_size{100 * 1000};
+
+    auto const file = pool->file_for(file_size);
+
+    struct stat stat;
+    fstat(file->fd(), &stat);
+    EXPECT_GE(stat.st_size, static_cast<off_t>(file_size));
+}
+
+TEST(ShmPool, reuses_memory_of_released_file_of_similar_size)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(max_cached);
+
+    auto file = pool->file_for(100 * 1000);
+    static_cast<char*>(file->base_ptr())[0] = 'x';
+    file.reset();
+
+    file = pool->file_for(100 * 1000 + 8);
+
+    EXPECT_EQ('x', static_cast<char*>(file->base_ptr())[0]);
+}
+
+TEST(ShmPool, does_not_hand_out_memory_in_use)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(max_cached);
+
+    auto const first = pool->file_for(page_size);
+    auto const second = pool->file_for(page_size);
+
+    EXPECT_NE(first->base_ptr(), second->base_ptr());
+    EXPECT_NE(first->fd(), second->fd());
+}
+
+TEST(ShmPool, accounts_for_memory_in_use_and_cached)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(max_cached);
+
+    auto file = pool->file_for(page_size);
+    EXPECT_EQ(page_size, pool->bytes_in_use());
+    EXPECT_EQ(0u, pool->bytes_cached());
+
+    file.reset();
+    EXPECT_EQ(0u, pool->bytes_in_use());
+    EXPECT_EQ(page_size, pool->bytes_cached());
+}
+
+TEST(ShmPool, drops_least_recently_released_memory_over_the_cap)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(2 * page_size);
+
+    auto oldest = pool->file_for(page_size);
+    auto middle = pool->file_for(page_size);
+    auto newest = pool->file_for(page_size);
+    static_cast<char*>(oldest->base_ptr())[0] = 'o';
+    static_cast<char*>(newest->base_ptr())[0] = 'n';
+
+    oldest.reset();
+    middle.reset();
+    newest.reset();
+    EXPECT_EQ(2 * page_size, pool->bytes_cached());
+
+    auto const first = pool->file_for(page_size);
+    auto const second = pool->file_for(page_size);
+    auto const third = pool->file_for(page_size);
+    EXPECT_EQ('n', static_cast<char*>(first->base_ptr())[0]);
+    EXPECT_NE('o', static_cast<char*>(second->base_ptr())[0]);
+    EXPECT_EQ(0, static_cast<char*>(third->base_ptr())[0]);
+}
+
+TEST(ShmPool, caches_nothing_with_a_zero_cap)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(0);
+
+    pool->file_for(page_size);
+
+    EXPECT_EQ(0u, pool->bytes_cached());
+}
+
+TEST(ShmPool, files_outlive_their_pool)
+{
+    auto pool = std::make_shared<mgc::ShmPool>(max_cached);
+    auto const file = pool->file_for(page_size);
+
+    pool.reset();
+
+    static_cast<char*>(file->base_ptr())[page_size - 1] = 'x';
+    EXPECT_GE(file->fd(), 0);
+}
+
+TEST(ShmPool, clients_cannot_shrink_memfds)
+{
+    auto const pool = std::make_shared<mgc::ShmPool>(max_cached);
+    auto const file = pool->file_for(page_size);
+
+    if (fcntl(file->fd(), F_GET_SEALS) == -1)
+        return; // No memfd support: nothing to test
+
+    EXPECT_EQ(-1, ftruncate(file->fd(), 0));
+}
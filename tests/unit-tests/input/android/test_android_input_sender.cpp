@@ -75,6 +75,10 @@ public:
     MOCK_METHOD4(received_event_from_kernel, void(int64_t when, int type, int code, int value));
     MOCK_METHOD3(published_key_event, void(int dest_fd, uint32_t seq_id, int64_t event_time));
     MOCK_METHOD3(published_motion_event, void(int dest_fd, uint32_t seq_id, int64_t event_time));
+    MOCK_METHOD3(deferred_input_event, void(int dest_fd, uint32_t seq_id, size_t queue_depth));
+    MOCK_METHOD2(coalesced_motion_event, void(int dest_fd, uint32_t seq_id));
+    MOCK_METHOD2(dropped_motion_event, void(int dest_fd, uint32_t seq_id));
+    MOCK_METHOD2(dropped_input_event, void(int dest_fd, uint32_t seq_id));
     MOCK_METHOD2(opened_input_device, void(char const* device_name, char const* input_platform));
     MOCK_METHOD2(failed_to_open_input_device, void(char const* device_name, char const* input_platform));
 };
@@ -142,6 +146,32 @@ public:
         fake_scene.observer->surface_removed(&stub_surface);
     }
 
+    // Sends motion until the client's channel is full
+    void fill_channel()
+    {
+        bool deferred = false;
+        ON_CALL(mock_input_report, deferred_input_event(_,_,_)).WillByDefault(Assign(&deferred, true));
+
+        while (!deferred)
+            sender.send_event(*pointer_event, channel);
+    }
+
+    // Consumes all the client is sent, as a client that keeps up would
+    template<typename Handler>
+    void consume_all(Handler const& handler)
+    {
+        for (bool consumed = true; consumed; loop.trigger_pending_fds())
+        {
+            consumed = false;
+            while (consumer.consume(&event_factory, true, std::chrono::nanoseconds(-1), &seq, &event) == droidinput::OK)
+            {
+                handler(event);
+                consumer.sendFinishedSignal(seq, true);
+                consumed = true;
+            }
+        }
+    }
+
     std::shared_ptr<mi::InputChannel> channel = std::make_shared<mi::Channel>();
     mtd::StubSceneSurface stub_surface{channel->server_fd()};
     droidinput::sp<droidinput::InputChannel> client_channel{new droidinput::InputChannel(droidinput::String8("test"), channel->client_fd())};
@@ -537,3 +567,93 @@ TEST_F(AndroidInputSender, encodes_input_device_state_event_as_raw_buffer_event)
     EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_count(input_device_state, 1), Eq(0));
     EXPECT_THAT(mir_input_device_state_event_device_pointer_buttons(input_device_state, 1), mir_pointer_button_primary);
 }
+
+TEST_F(AndroidInputSender, coalesces_motion_while_the_client_is_backed_up)
+{
+    register_surface();
+    fill_channel();
+
+    EXPECT_CALL(mock_input_report, coalesced_motion_event(channel->server_fd(), _)).Times(99);
+    for (int i = 0; i != 99; ++i)
+        sender.send_event(*pointer_event, channel);
+
+    float relative_x{0};
+    consume_all(
+        [&](droidinput::InputEvent*)
+        {
+            relative_x = client_motion_event.getAxisValue(AMOTION_EVENT_AXIS_RX, 0);
+        });
+
+    EXPECT_THAT(relative_x, Eq(100 * movement.dx.as_int()));
+}
+
+TEST_F(AndroidInputSender, delivers_every_key_event_in_order_while_the_client_is_backed_up)
+{
+    register_surface();
+    fill_channel();
+
+    EXPECT_CALL(mock_input_report, coalesced_motion_event(_, _)).Times(0);
+    int const keys = 200;
+    for (int i = 0; i != keys; ++i)
+    {
+        auto const key = builder.key_event(std::chrono::nanoseconds(i), mir_keyboard_action_down, 7, i);
+        sender.send_event(*key, channel);
+        sender.send_event(*pointer_event, channel);
+    }
+
+    std::vector<int> scan_codes;
+    consume_all(
+        [&](droidinput::InputEvent* event)
+        {
+            if (event == &client_key_event)
+                scan_codes.push_back(client_key_event.getScanCode());
+        });
+
+    ASSERT_THAT(scan_codes.size(), Eq(size_t(keys)));
+    for (int i = 0; i != keys; ++i)
+        EXPECT_THAT(scan_codes[i], Eq(i));
+}
+
+TEST_F(AndroidInputSender, drops_the_stalest_motion_when_its_queue_is_full)
+{
+    register_surface();
+    fill_channel();
+
+    EXPECT_CALL(mock_input_report, dropped_motion_event(channel->server_fd(), _)).Times(AtLeast(1));
+    for (int i = 0; i != 200; ++i)
+    {
+        // Alternating devices, so that nothing coalesces
+        auto const motion = builder.pointer_event(std::chrono::nanoseconds(i), mir_pointer_action_motion, 0, 0, 0, 1, 0);
+        motion->to_input()->set_device_id(i % 2);
+        sender.send_event(*motion, channel);
+    }
+}
+
+TEST_F(AndroidInputSender, drops_the_oldest_input_of_a_client_that_stopped_reading)
+{
+    register_surface();
+    fill_channel();
+
+    // However many a client leaves unread, the server keeps no more than a bounded number
+    int const keys = 1100;
+    int const kept = 1024;
+    // ...the first to go being the motion event that filled the channel
+    EXPECT_CALL(mock_input_report, dropped_input_event(channel->server_fd(), _)).Times(keys - kept + 1);
+    for (int i = 0; i != keys; ++i)
+    {
+        auto const key = builder.key_event(std::chrono::nanoseconds(i), mir_keyboard_action_down, 7, i);
+        sender.send_event(*key, channel);
+    }
+
+    std::vector<int> scan_codes;
+    consume_all(
+        [&](droidinput::InputEvent* event)
+        {
+            if (event == &client_key_event)
+                scan_codes.push_back(client_key_event.getScanCode());
+        });
+
+    ASSERT_THAT(scan_codes.size(), Eq(size_t(kept)));
+    EXPECT_THAT(scan_codes.front(), Eq(keys - kept));
+    EXPECT_THAT(scan_codes.back(), Eq(keys - 1));
+}
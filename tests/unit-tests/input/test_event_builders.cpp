@@ -283,3 +283,15 @@ TEST_F(InputEventBuilder, when_deserialized_input_device_state_event_has_supplie
         EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 2, i), Eq(pressed_keys[i]));
     }
 }
+
+TEST_F(InputEventBuilder, reuses_the_storage_of_freed_events)
+{
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers, mir_pointer_action_motion,
+                              0, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    void const* const storage = ev.get();
+    ev.reset();
+
+    auto const next = mev::make_event(device_id, timestamp, cookie, mir_keyboard_action_down, 0, 0, modifiers);
+
+    EXPECT_THAT(next.get(), Eq(storage));
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/input/input_ring.h"
+#include "src/server/input/channel.h"
+
+#include "androidfw/Input.h"
+#include "androidfw/InputTransport.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace testing;
+using namespace std::literals::chrono_literals;
+namespace mi = mir::input;
+
+namespace
+{
+bool readable(int fd)
+{
+    pollfd pfd{fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+struct Record
+{
+    uint32_t value;
+    char padding[28];
+};
+
+struct InputRing : Test
+{
+    bool push(uint32_t value)
+    {
+        Record const record{value, {}};
+        return producer.push(&record, sizeof record);
+    }
+
+    uint32_t pop()
+    {
+        Record record{0, {}};
+        EXPECT_THAT(consumer.pop(&record, sizeof record), Eq(sizeof record));
+        return record.value;
+    }
+
+    bool pop_nothing()
+    {
+        Record record;
+        return consumer.pop(&record, sizeof record) == 0;
+    }
+
+    size_t const capacity{4};
+    mi::InputRing producer{capacity, sizeof(Record)};
+    mi::InputRing consumer{producer.shm_fd(), producer.wakeup_fd()};
+};
+}
+
+TEST_F(InputRing, mapping_through_the_fds_shares_the_ring)
+{
+    EXPECT_THAT(consumer.capacity(), Eq(capacity));
+    EXPECT_THAT(consumer.record_size(), Eq(sizeof(Record)));
+
+    EXPECT_TRUE(consumer.empty());
+    push(7);
+    EXPECT_FALSE(consumer.empty());
+    EXPECT_THAT(pop(), Eq(7u));
+}
+
+TEST_F(InputRing, records_come_out_in_order_across_the_wrap)
+{
+    for (uint32_t i = 0; i != 3 * capacity; ++i)
+    {
+        ASSERT_TRUE(push(i));
+        EXPECT_THAT(pop(), Eq(i));
+    }
+
+    EXPECT_TRUE(pop_nothing());
+}
+
+TEST_F(InputRing, says_when_full_and_asks_for_room)
+{
+    for (uint32_t i = 0; i != capacity; ++i)
+        EXPECT_TRUE(push(i));
+
+    EXPECT_FALSE(consumer.take_room_request());
+    EXPECT_FALSE(push(99));
+
+    EXPECT_THAT(pop(), Eq(0u));
+    EXPECT_TRUE(consumer.take_room_request());
+    EXPECT_FALSE(consumer.take_room_request());
+    EXPECT_TRUE(push(4));
+}
+
+TEST_F(InputRing, wakes_the_consumer_only_until_it_finds_the_ring_empty)
+{
+    EXPECT_FALSE(readable(consumer.wakeup_fd()));
+
+    push(1);
+    push(2);
+    EXPECT_TRUE(readable(consumer.wakeup_fd()));
+
+    pop();
+    pop();
+    EXPECT_TRUE(readable(consumer.wakeup_fd()));
+
+    EXPECT_TRUE(pop_nothing());
+    EXPECT_FALSE(readable(consumer.wakeup_fd()));
+
+    push(3);
+    EXPECT_TRUE(readable(consumer.wakeup_fd()));
+}
+
+TEST_F(InputRing, knows_when_a_consumer_attaches)
+{
+    EXPECT_FALSE(producer.consumer_attached());
+
+    consumer.attach_consumer();
+
+    EXPECT_TRUE(producer.consumer_attached());
+    EXPECT_TRUE(consumer.consuming());
+    EXPECT_FALSE(producer.consuming());
+}
+
+TEST_F(InputRing, refuses_records_larger_than_it_holds)
+{
+    char const oversized[sizeof(Record) + 1]{};
+
+    EXPECT_THROW(producer.push(oversized, sizeof oversized), std::invalid_argument);
+}
+
+TEST_F(InputRing, refuses_to_map_what_is_not_a_ring)
+{
+    char const junk[512]{'j', 'u', 'n', 'k'};
+    FILE* const file = tmpfile();
+    ASSERT_THAT(file, NotNull());
+    ASSERT_THAT(fwrite(junk, sizeof junk, 1, file), Eq(1u));
+    fflush(file);
+
+    mir::Fd const fd{dup(fileno(file))};
+    fclose(file);
+
+    EXPECT_THROW(mi::InputRing(fd, producer.wakeup_fd()), std::runtime_error);
+}
+
+TEST_F(InputRing, survives_the_consumer_trying_to_truncate_it)
+{
+    EXPECT_THAT(ftruncate(consumer.shm_fd(), 0), Eq(-1));
+    EXPECT_THAT(ftruncate(consumer.shm_fd(), 1024 * 1024), Eq(-1));
+
+    EXPECT_TRUE(push(1));
+    EXPECT_THAT(pop(), Eq(1u));
+}
+
+TEST_F(InputRing, refuses_to_map_memory_that_can_be_resized)
+{
+    // A copy of a real ring's memory, in a file that anyone can truncate
+    auto const size = lseek(producer.shm_fd(), 0, SEEK_END);
+    FILE* const file = tmpfile();
+    ASSERT_THAT(file, NotNull());
+    ASSERT_THAT(ftruncate(fileno(file), size), Eq(0));
+    auto const source = mmap(nullptr, size, PROT_READ, MAP_SHARED, producer.shm_fd(), 0);
+    ASSERT_THAT(source, Ne(MAP_FAILED));
+    ASSERT_THAT(pwrite(fileno(file), source, size, 0), Eq(size));
+    munmap(source, size);
+
+    mir::Fd const fd{dup(fileno(file))};
+    fclose(file);
+
+    EXPECT_THROW(mi::InputRing(fd, producer.wakeup_fd()), std::runtime_error);
+}
+
+TEST_F(InputRing, treats_a_read_index_ahead_of_the_writes_as_full)
+{
+    // Where the shared header keeps the read index, on the third cache line
+    size_t const read_index_offset{128};
+
+    push(1);
+    pop();
+
+    auto const mapping = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, producer.shm_fd(), 0);
+    ASSERT_THAT(mapping, Ne(MAP_FAILED));
+    auto const read_index = reinterpret_cast<uint64_t*>(static_cast<char*>(mapping) + read_index_offset);
+    ASSERT_THAT(*read_index, Eq(1u));
+
+    *read_index = 1000;
+    EXPECT_FALSE(push(2));
+
+    *read_index = 1;
+    EXPECT_TRUE(push(2));
+
+    munmap(mapping, 4096);
+}
+
+namespace
+{
+struct EventFactory : android::InputEventFactoryInterface
+{
+    android::KeyEvent key;
+    android::MotionEvent motion;
+    android::RawBufferEvent raw;
+    android::KeyEvent* createKeyEvent() { return &key; }
+    android::MotionEvent* createMotionEvent() { return &motion; }
+    android::RawBufferEvent* createRawBufferEvent() { return &raw; }
+};
+
+struct InputRingTransport : Test
+{
+    static std::shared_ptr<mi::InputRing> ring_of(mi::Channel const& channel)
+    {
+        return std::make_shared<mi::InputRing>(
+            mir::Fd{mir::IntOwnedFd{channel.ring_fd()}},
+            mir::Fd{mir::IntOwnedFd{channel.ring_wakeup_fd()}});
+    }
+
+    std::string receive()
+    {
+        uint32_t seq{0};
+        android::InputEvent* event{nullptr};
+        auto const result = consumer.consume(&events, true, -1ns, &seq, &event);
+        if (result != android::OK)
+            return {};
+
+        consumer.sendFinishedSignal(seq, true);
+        return static_cast<android::RawBufferEvent*>(event)->buffer;
+    }
+
+    size_t finished_signals()
+    {
+        size_t count{0};
+        uint32_t seq;
+        bool handled;
+        while (publisher.receiveFinishedSignal(&seq, &handled) == android::OK)
+            ++count;
+        return count;
+    }
+
+    uint32_t seq{0};
+    EventFactory events;
+    mi::Channel channel{2};
+    std::shared_ptr<mi::InputRing> const server_ring{ring_of(channel)};
+    std::shared_ptr<mi::InputRing> const client_ring{ring_of(channel)};
+    android::sp<android::InputChannel> server_channel =
+        new android::InputChannel("test_server", channel.server_fd(), server_ring);
+    android::sp<android::InputChannel> client_channel =
+        new android::InputChannel("test_client", channel.client_fd(), client_ring);
+
+    android::InputPublisher publisher{server_channel};
+    android::InputConsumer consumer{client_channel};
+};
+}
+
+TEST_F(InputRingTransport, channels_without_a_ring_have_no_ring_fds)
+{
+    mi::Channel plain;
+
+    EXPECT_THAT(plain.ring_fd(), Eq(-1));
+    EXPECT_THAT(plain.ring_wakeup_fd(), Eq(-1));
+    EXPECT_THAT(channel.ring_fd(), Ge(0));
+    EXPECT_THAT(channel.ring_wakeup_fd(), Ge(0));
+}
+
+TEST_F(InputRingTransport, uses_the_socket_until_the_consumer_attaches)
+{
+    EXPECT_THAT(publisher.publishEventBuffer(++seq, "first"), Eq(android::OK));
+
+    EXPECT_TRUE(client_ring->empty());
+    EXPECT_THAT(receive(), Eq("first"));
+    EXPECT_THAT(finished_signals(), Eq(1u));
+}
+
+TEST_F(InputRingTransport, delivers_through_the_ring_after_what_the_socket_holds)
+{
+    publisher.publishEventBuffer(++seq, "socket");
+    client_ring->attach_consumer();
+    publisher.publishEventBuffer(++seq, "ring");
+
+    EXPECT_FALSE(client_ring->empty());
+    EXPECT_THAT(receive(), Eq("socket"));
+    EXPECT_THAT(receive(), Eq("ring"));
+    EXPECT_THAT(receive(), Eq(""));
+
+    // The ring's read index acknowledges what came through it
+    EXPECT_THAT(finished_signals(), Eq(1u));
+    EXPECT_FALSE(readable(client_ring->wakeup_fd()));
+}
+
+TEST_F(InputRingTransport, tells_the_publisher_when_a_full_ring_has_room)
+{
+    client_ring->attach_consumer();
+
+    EXPECT_THAT(publisher.publishEventBuffer(++seq, "one"), Eq(android::OK));
+    EXPECT_THAT(publisher.publishEventBuffer(++seq, "two"), Eq(android::OK));
+    EXPECT_THAT(publisher.publishEventBuffer(++seq, "three"), Eq(android::WOULD_BLOCK));
+    EXPECT_THAT(finished_signals(), Eq(0u));
+
+    EXPECT_THAT(receive(), Eq("one"));
+    EXPECT_THAT(finished_signals(), Eq(1u));
+    EXPECT_THAT(publisher.publishEventBuffer(++seq, "three"), Eq(android::OK));
+}
@@ -213,38 +213,92 @@ TEST_F(GLRenderer, avoids_src_alpha_for_rgbx_blending)  // LP: #1423462
     renderer.render(renderable_list);
 }
 
-TEST_F(GLRenderer, binds_for_every_primitive_when_tessellate_is_overridden)
+namespace
 {
-    //'listening to the tests', it would be a bit easier to use a tessellator mock of some sort
-    struct OverriddenTessellateRenderer : public mrg::Renderer
+struct OverriddenTessellateRenderer : public mrg::Renderer
+{
+    OverriddenTessellateRenderer(
+        mg::DisplayBuffer& display_buffer, unsigned int num_primitives, GLfloat spacing) :
+        Renderer(display_buffer),
+        num_primitives(num_primitives),
+        spacing(spacing)
     {
-        OverriddenTessellateRenderer(
-            mg::DisplayBuffer& display_buffer, unsigned int num_primitives) :
-            Renderer(display_buffer),
-            num_primitives(num_primitives)
-        {
-        }
+    }
 
-        void tessellate(std::vector<mgl::Primitive>& primitives,
-                        mg::Renderable const&) const override
+    // 10x10 quads, each spacing further right than the last and using
+    // alternately the client's and the shell's texture
+    void tessellate(std::vector<mgl::Primitive>& primitives,
+                    mg::Renderable const&) const override
+    {
+        primitives.resize(num_primitives);
+        for(GLuint i=0; i < num_primitives; i++)
         {
-            primitives.resize(num_primitives);
-            for(GLuint i=0; i < num_primitives; i++)
-            {
-                auto& p = primitives[i];
-                p.type = 0;
-                p.tex_id = i % 2;
-                p.nvertices = 0;
-            }
+            auto& p = primitives[i];
+            p.type = GL_TRIANGLE_STRIP;
+            p.tex_id = i % 2;
+            p.nvertices = 4;
+            GLfloat const left = i * spacing;
+            GLfloat const right = left + 10.0f;
+            p.vertices[0] = {{left, 0.0f, 0.0f}, {0.0f, 0.0f}};
+            p.vertices[1] = {{left, 10.0f, 0.0f}, {0.0f, 1.0f}};
+            p.vertices[2] = {{right, 0.0f, 0.0f}, {1.0f, 0.0f}};
+            p.vertices[3] = {{right, 10.0f, 0.0f}, {1.0f, 1.0f}};
         }
-        unsigned int num_primitives; 
-    };
+    }
+    unsigned int num_primitives;
+    GLfloat spacing;
+};
+}
 
+TEST_F(GLRenderer, binds_for_every_primitive_when_tessellate_is_overridden)
+{
+    //'listening to the tests', it would be a bit easier to use a tessellator mock of some sort
     int bind_count = 6;
     EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, _))
         .Times(AtLeast(bind_count));
 
-    OverriddenTessellateRenderer renderer(display_buffer, bind_count);
+    // Overlapping, so they must be drawn in order
+    OverriddenTessellateRenderer renderer(display_buffer, bind_count, 5.0f);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, draws_primitives_in_order_when_they_overlap)
+{
+    OverriddenTessellateRenderer renderer(display_buffer, 4, 5.0f);
+
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, _, 6)).Times(4);
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, batches_primitives_that_do_not_overlap)
+{
+    OverriddenTessellateRenderer renderer(display_buffer, 6, 20.0f);
+
+    // One draw per texture, each of three quads of two triangles
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 18));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 18, 18));
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 36 * sizeof(mgl::Vertex), _, GL_STREAM_DRAW));
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, does_not_repeat_unchanged_state)
+{
+    auto const beside = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*beside, id()).WillByDefault(Return(&beside));
+    ON_CALL(*beside, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*beside, shaped()).WillByDefault(Return(false));
+    ON_CALL(*beside, alpha()).WillByDefault(Return(1.0f));
+    ON_CALL(*beside, screen_position())
+        .WillByDefault(Return(mir::geometry::Rectangle{{10,2},{3,4}}));
+    renderable_list.push_back(beside);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glUseProgram(_)).Times(1);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(1);
+
     renderer.render(renderable_list);
 }
 
@@ -314,3 +368,54 @@ TEST_F(GLRenderer, swaps_buffers_after_rendering)
 
     renderer.render(renderable_list);
 }
+
+TEST_F(GLRenderer, only_redraws_damaged_area_of_aged_buffer)
+{
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(mir::geometry::Rectangle{{0, 0}, {100, 100}}));
+    ON_CALL(mock_display_buffer, buffer_age()).WillByDefault(Return(1));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.render(renderable_list);
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glEnable(GL_SCISSOR_TEST));
+    EXPECT_CALL(mock_gl, glScissor(10, 40, 30, 40));
+    EXPECT_CALL(mock_gl, glClear(_));
+    EXPECT_CALL(mock_gl, glDisable(GL_SCISSOR_TEST));
+
+    renderer.set_damage({{{10, 20}, {30, 40}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, redraws_everything_when_buffer_age_is_unknown)
+{
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(mir::geometry::Rectangle{{0, 0}, {100, 100}}));
+    ON_CALL(mock_display_buffer, buffer_age()).WillByDefault(Return(0));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.render(renderable_list);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+
+    renderer.set_damage({{{10, 20}, {30, 40}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, skips_drawing_what_is_hidden_by_opaque_renderables_above)
+{
+    auto const above = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*above, id()).WillByDefault(Return(&above));
+    ON_CALL(*above, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*above, shaped()).WillByDefault(Return(false));
+    ON_CALL(*above, screen_position())
+        .WillByDefault(Return(mir::geometry::Rectangle{{0,0},{100,100}}));
+    renderable_list.push_back(above);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(1);
+
+    renderer.render(renderable_list);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/blit.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+namespace blit = mir::renderer::software::blit;
+
+namespace
+{
+uint32_t channel(uint32_t p, int c)
+{
+    return (p >> (8 * c)) & 0xff;
+}
+
+uint32_t rounded(double v)
+{
+    return std::min(255u, static_cast<uint32_t>(v + 0.5));
+}
+
+// What GL does with each blend function, in floating point
+uint32_t over(uint32_t dst, uint32_t src, uint32_t alpha)
+{
+    double const a = alpha / 255.0;
+    uint32_t const src_alpha = rounded(channel(src, 3) * a);
+    uint32_t result = 0;
+    for (int c = 0; c != 4; ++c)
+    {
+        double const s = rounded(channel(src, c) * a);
+        double const d = rounded(channel(dst, c) * (255 - src_alpha) / 255.0);
+        result |= rounded(s + d) << (8 * c);
+    }
+    return result;
+}
+
+uint32_t blend(uint32_t dst, uint32_t src, uint32_t alpha)
+{
+    uint32_t result = 0;
+    for (int c = 0; c != 4; ++c)
+    {
+        double const s = rounded(channel(src, c) * alpha / 255.0);
+        double const d = rounded(channel(dst, c) * (255 - alpha) / 255.0);
+        result |= rounded(s + d) << (8 * c);
+    }
+    return result;
+}
+
+struct Blit : Test
+{
+    Blit()
+    {
+        std::mt19937 random{1234};
+        std::uniform_int_distribution<uint32_t> byte{0, 255};
+
+        for (auto i = 0u; i != length; ++i)
+        {
+            // Premultiplied, with runs of opaque and clear pixels mixed in
+            uint32_t const a = (i / 8 % 3 == 0) ? 255 : (i / 8 % 3 == 1) ? byte(random) : 0;
+            uint32_t p = a << 24;
+            for (int c = 0; c != 3; ++c)
+                p |= (a ? byte(random) * a / 255 : 0) << (8 * c);
+            src.push_back(p);
+            dst.push_back(0xff000000 | byte(random) << 16 | byte(random) << 8 | byte(random));
+        }
+    }
+
+    // Odd, so the scalar tail of every implementation gets exercised
+    size_t const length{1021};
+    std::vector<uint32_t> src;
+    std::vector<uint32_t> dst;
+};
+}
+
+TEST_F(Blit, copy_copies)
+{
+    blit::copy(dst.data(), src.data(), length);
+
+    EXPECT_THAT(dst, ContainerEq(src));
+}
+
+TEST_F(Blit, over_composites_premultiplied_pixels)
+{
+    auto expected = dst;
+    for (auto i = 0u; i != length; ++i)
+        expected[i] = over(dst[i], src[i], 255);
+
+    blit::over(dst.data(), src.data(), length);
+
+    EXPECT_THAT(dst, ContainerEq(expected));
+}
+
+TEST_F(Blit, over_with_alpha_fades_the_source_first)
+{
+    for (uint8_t alpha : {0, 1, 77, 128, 254, 255})
+    {
+        auto target = dst;
+        auto expected = dst;
+        for (auto i = 0u; i != length; ++i)
+            expected[i] = over(dst[i], src[i], alpha);
+
+        blit::over(target.data(), src.data(), length, alpha);
+
+        EXPECT_THAT(target, ContainerEq(expected)) << "alpha = " << int(alpha);
+    }
+}
+
+TEST_F(Blit, blend_ignores_source_alpha)
+{
+    for (auto& p : src)
+        p |= 0xff000000;
+
+    for (uint8_t alpha : {0, 1, 77, 128, 254, 255})
+    {
+        auto target = dst;
+        auto expected = dst;
+        for (auto i = 0u; i != length; ++i)
+            expected[i] = blend(dst[i], src[i], alpha);
+
+        blit::blend(target.data(), src.data(), length, alpha);
+
+        EXPECT_THAT(target, ContainerEq(expected)) << "alpha = " << int(alpha);
+    }
+}
+
+TEST_F(Blit, swap_red_blue_swaps_only_them)
+{
+    std::vector<uint32_t> const abgr(length, 0x11223344);
+
+    blit::swap_red_blue(dst.data(), abgr.data(), length);
+
+    EXPECT_THAT(dst, Each(Eq(0x11443322u)));
+}
+
+TEST_F(Blit, names_the_instruction_set_used)
+{
+    EXPECT_THAT(blit::instruction_set(), Not(StrEq("")));
+}
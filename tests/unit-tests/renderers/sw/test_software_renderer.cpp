@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/sw/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace testing;
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+uint32_t const poison = 0xdeadbeef;
+
+class SoftwareDisplayBuffer : public mtd::StubDisplayBuffer, public mrs::RenderTarget
+{
+public:
+    SoftwareDisplayBuffer(geom::Rectangle const& view_area, geom::Size const& size)
+        : StubDisplayBuffer{view_area},
+          size{size},
+          pixels(size.width.as_int() * size.height.as_int(), poison)
+    {
+    }
+
+    mrs::MappedFramebuffer map_framebuffer() override
+    {
+        return {reinterpret_cast<unsigned char*>(pixels.data()),
+                size,
+                geom::Stride{size.width.as_int() * 4},
+                mir_pixel_format_xrgb_8888};
+    }
+
+    void swap_buffers() override { ++swaps; }
+    unsigned int buffer_age() override { return age; }
+
+    uint32_t at(int x, int y) const { return pixels[y * size.width.as_int() + x]; }
+
+    geom::Size const size;
+    std::vector<uint32_t> pixels;
+    unsigned int age = 0;
+    int swaps = 0;
+};
+
+std::shared_ptr<mtd::StubBuffer> buffer_filled_with(
+    uint32_t pixel, geom::Size const& size, MirPixelFormat format = mir_pixel_format_argb_8888)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        nullptr,
+        mg::BufferProperties{size, format, mg::BufferUsage::software},
+        geom::Stride{size.width.as_int() * 4});
+    std::vector<uint32_t> const pixels(size.width.as_int() * size.height.as_int(), pixel);
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * 4);
+    return buffer;
+}
+
+std::shared_ptr<mtd::FakeRenderable> renderable_of(
+    std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangle const& position,
+    float alpha = 1.0f, bool shaped = false)
+{
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha, !shaped);
+    renderable->set_buffer(buffer);
+    return renderable;
+}
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const screen{{0, 0}, {4, 3}};
+    SoftwareDisplayBuffer display_buffer{screen, screen.size};
+};
+}
+
+TEST_F(SoftwareRenderer, draws_renderables_over_a_cleared_background)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    renderer.render({renderable_of(buffer_filled_with(0xff123456, {2, 2}), {{1, 1}, {2, 2}})});
+
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.at(1, 1), Eq(0xff123456));
+    EXPECT_THAT(display_buffer.at(2, 2), Eq(0xff123456));
+    EXPECT_THAT(display_buffer.at(3, 2), Eq(0u));
+    EXPECT_THAT(display_buffer.swaps, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, blends_like_the_gl_renderer)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    auto const background = renderable_of(buffer_filled_with(0xff0000ff, {4, 3}), screen);
+    auto const translucent = renderable_of(buffer_filled_with(0xff00ff00, {1, 1}), {{0, 0}, {1, 1}}, 0.5f);
+    auto const shaped = renderable_of(buffer_filled_with(0x80800000, {1, 1}), {{1, 0}, {1, 1}}, 1.0f, true);
+
+    renderer.render({background, translucent, shaped});
+
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0xff00807f));
+    EXPECT_THAT(display_buffer.at(1, 0), Eq(0xff80007f));
+    EXPECT_THAT(display_buffer.at(2, 0), Eq(0xff0000ff));
+}
+
+TEST_F(SoftwareRenderer, converts_abgr_buffers)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    renderer.render({renderable_of(
+        buffer_filled_with(0xff332211, {4, 3}, mir_pixel_format_abgr_8888), screen)});
+
+    EXPECT_THAT(display_buffer.at(3, 2), Eq(0xff112233));
+}
+
+TEST_F(SoftwareRenderer, stretches_buffers_over_their_screen_position)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    renderer.render({renderable_of(buffer_filled_with(0xff123456, {1, 1}), {{1, 1}, {2, 2}})});
+
+    EXPECT_THAT(display_buffer.at(1, 1), Eq(0xff123456));
+    EXPECT_THAT(display_buffer.at(2, 2), Eq(0xff123456));
+    EXPECT_THAT(display_buffer.at(3, 2), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, redraws_only_what_a_recent_buffer_is_missing)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const background = renderable_of(buffer_filled_with(0xff0000ff, {4, 3}), screen);
+
+    renderer.render({background});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), poison);
+    display_buffer.age = 1;
+    renderer.set_damage({{{2, 1}, {1, 1}}});
+    renderer.render({background});
+
+    EXPECT_THAT(display_buffer.at(2, 1), Eq(0xff0000ff));
+    EXPECT_THAT(display_buffer.at(1, 1), Eq(poison));
+    EXPECT_THAT(display_buffer.at(3, 2), Eq(poison));
+}
+
+TEST_F(SoftwareRenderer, redraws_everything_for_buffers_of_unknown_age)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const background = renderable_of(buffer_filled_with(0xff0000ff, {4, 3}), screen);
+
+    renderer.render({background});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), poison);
+    renderer.set_damage({{{2, 1}, {1, 1}}});
+    renderer.render({background});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xff0000ffu)));
+}
+
+TEST_F(SoftwareRenderer, does_not_read_buffers_that_are_hidden)
+{
+    struct UnreadableBuffer : mtd::StubBuffer
+    {
+        using StubBuffer::StubBuffer;
+        void read(std::function<void(unsigned char const*)> const&) override
+        {
+            FAIL() << "Hidden buffer was read";
+        }
+    };
+
+    mrs::Renderer renderer{display_buffer};
+    auto const hidden = renderable_of(
+        std::make_shared<UnreadableBuffer>(
+            nullptr,
+            mg::BufferProperties{{2, 2}, mir_pixel_format_argb_8888, mg::BufferUsage::software},
+            geom::Stride{8}),
+        {{1, 1}, {2, 2}});
+
+    renderer.render({hidden, renderable_of(buffer_filled_with(0xff0000ff, {4, 3}), screen)});
+}
+
+TEST_F(SoftwareRenderer, rotates_and_mirrors_the_output)
+{
+    SoftwareDisplayBuffer sideways{screen, {3, 4}};
+    mrs::Renderer renderer{sideways};
+
+    auto const pixels = std::make_shared<mtd::StubBuffer>(
+        nullptr,
+        mg::BufferProperties{{4, 3}, mir_pixel_format_argb_8888, mg::BufferUsage::software},
+        geom::Stride{16});
+    std::vector<uint32_t> content(12);
+    for (int i = 0; i != 12; ++i)
+        content[i] = 0xff000000 | i;
+    pixels->write(reinterpret_cast<unsigned char const*>(content.data()), 48);
+
+    renderer.set_output_transform(mir_orientation_left, mir_mirror_mode_none);
+    renderer.render({renderable_of(pixels, screen)});
+
+    // The top right of the screen ends up at the top left
+    EXPECT_THAT(sideways.at(0, 0), Eq(0xff000003));
+    EXPECT_THAT(sideways.at(2, 0), Eq(0xff00000b));
+    EXPECT_THAT(sideways.at(0, 3), Eq(0xff000000));
+
+    renderer.set_output_transform(mir_orientation_left, mir_mirror_mode_horizontal);
+    renderer.render({renderable_of(pixels, screen)});
+
+    EXPECT_THAT(sideways.at(2, 0), Eq(0xff000003));
+    EXPECT_THAT(sideways.at(0, 0), Eq(0xff00000b));
+}
+
+TEST_F(SoftwareRenderer, rejects_display_buffers_it_cannot_draw_on)
+{
+    mtd::StubDisplayBuffer gl_only{screen};
+
+    EXPECT_THROW(mrs::Renderer{gl_only}, std::logic_error);
+}
@@ -125,7 +125,8 @@ struct AbstractShell : Test
         std::make_shared<ms::NullSessionListener>(),
         mt::fake_shared(display),
         std::make_shared<mtd::NullANRDetector>(),
-        std::make_shared<mtd::StubBufferAllocator>()};
+        std::make_shared<mtd::StubBufferAllocator>(),
+        0};
 
     mtd::StubInputTargeter input_targeter;
     std::shared_ptr<NiceMockWindowManager> wm;
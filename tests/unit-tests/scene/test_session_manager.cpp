@@ -107,7 +107,8 @@ struct SessionManagerSetup : public testing::Test
         mt::fake_shared(session_listener),
         mt::fake_shared(display),
         std::make_shared<mtd::NullANRDetector>(),
-        mt::fake_shared(allocator)};
+        mt::fake_shared(allocator),
+        0};
 };
 
 }
@@ -171,7 +172,8 @@ struct SessionManagerSessionListenerSetup : public testing::Test
         mt::fake_shared(session_listener),
         mt::fake_shared(display),
         std::make_shared<mtd::NullANRDetector>(),
-        mt::fake_shared(allocator)};
+        mt::fake_shared(allocator),
+        0};
 };
 }
 
@@ -214,7 +216,8 @@ struct SessionManagerSessionEventsSetup : public testing::Test
         mt::fake_shared(session_listener),
         mt::fake_shared(display),
         std::make_shared<mtd::NullANRDetector>(),
-        mt::fake_shared(allocator)};
+        mt::fake_shared(allocator),
+        0};
 };
 }
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/software_pixel_buffer.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/mock_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct SoftwarePixelBuffer : Test
+{
+    // A 2x2 buffer whose rows are padded to three pixels
+    mtd::StubBuffer& buffer_of(MirPixelFormat format)
+    {
+        buffer = std::make_unique<mtd::StubBuffer>(
+            nullptr, mg::BufferProperties{geom::Size{2, 2}, format, mg::BufferUsage::software}, geom::Stride{12});
+
+        uint32_t const rows[]{0x11223344, 0x55667788, 0xdeadbeef,
+                              0x00aabbcc, 0x80102030, 0xdeadbeef};
+        buffer->written_pixels.resize(sizeof rows);
+        std::memcpy(buffer->written_pixels.data(), rows, sizeof rows);
+        return *buffer;
+    }
+
+    std::vector<uint32_t> argb_pixels()
+    {
+        auto const data = static_cast<uint32_t const*>(pixels.as_argb_8888());
+        return {data, data + 4};
+    }
+
+    std::unique_ptr<mtd::StubBuffer> buffer;
+    ms::SoftwarePixelBuffer pixels;
+};
+}
+
+TEST_F(SoftwarePixelBuffer, copies_argb_pixels_without_row_padding)
+{
+    pixels.fill_from(buffer_of(mir_pixel_format_argb_8888));
+
+    EXPECT_THAT(pixels.size(), Eq(geom::Size{2, 2}));
+    EXPECT_THAT(pixels.stride(), Eq(geom::Stride{8}));
+    EXPECT_THAT(argb_pixels(), ElementsAre(0x11223344, 0x55667788, 0x00aabbcc, 0x80102030));
+}
+
+TEST_F(SoftwarePixelBuffer, converts_abgr_pixels_to_argb)
+{
+    pixels.fill_from(buffer_of(mir_pixel_format_abgr_8888));
+
+    EXPECT_THAT(argb_pixels(), ElementsAre(0x11443322, 0x55887766, 0x00ccbbaa, 0x80302010));
+}
+
+TEST_F(SoftwarePixelBuffer, makes_pixels_without_alpha_opaque)
+{
+    pixels.fill_from(buffer_of(mir_pixel_format_xrgb_8888));
+    EXPECT_THAT(argb_pixels(), ElementsAre(0xff223344, 0xff667788, 0xffaabbcc, 0xff102030));
+
+    pixels.fill_from(buffer_of(mir_pixel_format_xbgr_8888));
+    EXPECT_THAT(argb_pixels(), ElementsAre(0xff443322, 0xff887766, 0xffccbbaa, 0xff302010));
+}
+
+TEST_F(SoftwarePixelBuffer, only_fills_from_buffers_with_pixels_in_cpu_memory)
+{
+    NiceMock<mtd::MockBuffer> gpu_buffer{geom::Size{2, 2}, geom::Stride{8}, mir_pixel_format_argb_8888};
+    ON_CALL(gpu_buffer, native_buffer_base())
+        .WillByDefault(Return(nullptr));
+
+    EXPECT_TRUE(ms::SoftwarePixelBuffer::can_fill_from(buffer_of(mir_pixel_format_argb_8888)));
+    EXPECT_FALSE(ms::SoftwarePixelBuffer::can_fill_from(buffer_of(mir_pixel_format_rgb_565)));
+    EXPECT_FALSE(ms::SoftwarePixelBuffer::can_fill_from(gpu_buffer));
+    EXPECT_THROW(pixels.fill_from(gpu_buffer), std::logic_error);
+}
@@ -1115,6 +1115,60 @@ TEST_F(SurfaceStack, returns_top_visible_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, surface_under_cursor_follows_moves_and_raises)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+    stub_surface2->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+
+    stub_surface2->move_to({0, 0});
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({1050, 1050}).get(), IsNull());
+
+    stack.raise(stub_surface1);
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+
+    stack.remove_surface(stub_surface1);
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+}
+
+TEST_F(SurfaceStack, finds_surfaces_far_from_the_origin_and_larger_than_the_screen)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->move_to({-20000, -20000});
+    stub_surface1->resize({40000, 40000});
+    stub_surface2->move_to({-5000, 7000});
+    stub_surface2->resize({10, 10});
+
+    EXPECT_THAT(stack.surface_at({-5000, 7000}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({-5001, 7000}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({19999, 19999}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({20000, 0}).get(), IsNull());
+}
+
+TEST_F(SurfaceStack, surface_under_cursor_is_not_stale_after_hiding)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({50, 50});
+
+    EXPECT_THAT(stack.surface_at({10, 10}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({20, 20}), Eq(stub_surface2));
+
+    stub_surface2->set_hidden(true);
+    EXPECT_THAT(stack.surface_at({20, 20}), Eq(stub_surface1));
+}
+
 TEST_F(SurfaceStack, raise_surfaces_to_top)
 {
     stack.add_surface(stub_surface1, default_params.input_mode);
@@ -1156,3 +1210,36 @@ TEST_F(SurfaceStack, raise_surfaces_to_top)
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream3)));
 }
+
+TEST_F(SurfaceStack, compositors_see_whole_scenes_while_it_changes)
+{
+    using namespace testing;
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    std::atomic<bool> done{false};
+    std::thread writer{
+        [&]
+        {
+            while (!done)
+            {
+                stack.add_surface(stub_surface3, default_params.input_mode);
+                stack.raise(stub_surface1);
+                stack.remove_surface(stub_surface3);
+                stack.raise(stub_surface2);
+            }
+        }};
+
+    for (int i = 0; i != 1000; ++i)
+    {
+        auto const elements = stack.scene_elements_for(compositor_id);
+
+        EXPECT_THAT(elements.size(), AnyOf(Eq(2u), Eq(3u)));
+        EXPECT_THAT(elements, Contains(SceneElementForStream(stub_buffer_stream1)));
+        EXPECT_THAT(elements, Contains(SceneElementForStream(stub_buffer_stream2)));
+    }
+
+    done = true;
+    writer.join();
+}
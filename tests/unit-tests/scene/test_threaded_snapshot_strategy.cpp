@@ -19,8 +19,10 @@
 #include "src/server/scene/threaded_snapshot_strategy.h"
 #include "src/server/scene/pixel_buffer.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/buffer_properties.h"
 
 #include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/mock_buffer.h"
 #include "mir/test/doubles/null_pixel_buffer.h"
 #include "mir/test/doubles/stub_buffer_stream.h"
 #include "mir/test/fake_shared.h"
@@ -56,7 +58,16 @@ public:
 
 struct ThreadedSnapshotStrategyTest : testing::Test
 {
+    ThreadedSnapshotStrategyTest()
+    {
+        using namespace testing;
+        // Pixels only GL can get at
+        ON_CALL(gpu_buffer, native_buffer_base())
+            .WillByDefault(Return(nullptr));
+    }
+
     mtd::StubBufferStream buffer_access;
+    testing::NiceMock<mtd::MockBuffer> gpu_buffer{geom::Size{10, 11}, geom::Stride{40}, mir_pixel_format_argb_8888};
 };
 
 }
@@ -71,7 +82,8 @@ TEST_F(ThreadedSnapshotStrategyTest, takes_snapshot)
 
     MockPixelBuffer pixel_buffer;
 
-    EXPECT_CALL(pixel_buffer, fill_from(Ref(*buffer_access.stub_compositor_buffer)));
+    buffer_access.stub_compositor_buffer = mt::fake_shared(gpu_buffer);
+    EXPECT_CALL(pixel_buffer, fill_from(Ref(gpu_buffer)));
     EXPECT_CALL(pixel_buffer, as_argb_8888())
         .WillOnce(Return(pixels));
     EXPECT_CALL(pixel_buffer, size())
@@ -121,3 +133,58 @@ TEST_F(ThreadedSnapshotStrategyTest, names_snapshot_thread)
 
     EXPECT_THAT(buffer_access.thread_name, Eq("Mir/Snapshot"));
 }
+
+TEST_F(ThreadedSnapshotStrategyTest, snapshots_software_buffers_without_the_pixel_buffer)
+{
+    using namespace testing;
+
+    geom::Size const size{2, 1};
+    buffer_access.stub_compositor_buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+
+    MockPixelBuffer pixel_buffer;
+    EXPECT_CALL(pixel_buffer, fill_from(_))
+        .Times(0);
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer), 2};
+
+    mt::Signal snapshot_taken;
+    ms::Snapshot snapshot;
+
+    strategy.take_snapshot_of(
+        mt::fake_shared(buffer_access),
+        [&](ms::Snapshot const& s)
+        {
+            snapshot = s;
+            snapshot_taken.raise();
+        });
+
+    ASSERT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+
+    EXPECT_EQ(size, snapshot.size);
+    EXPECT_EQ(geom::Stride{8}, snapshot.stride);
+    EXPECT_THAT(snapshot.pixels, NotNull());
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, hands_other_buffers_to_the_pixel_buffer)
+{
+    using namespace testing;
+
+    buffer_access.stub_compositor_buffer = mt::fake_shared(gpu_buffer);
+
+    NiceMock<MockPixelBuffer> pixel_buffer;
+    EXPECT_CALL(pixel_buffer, fill_from(Ref(gpu_buffer)));
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer), 2};
+
+    mt::Signal snapshot_taken;
+
+    strategy.take_snapshot_of(
+        mt::fake_shared(buffer_access),
+        [&](ms::Snapshot const&)
+        {
+            snapshot_taken.raise();
+        });
+
+    EXPECT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+}
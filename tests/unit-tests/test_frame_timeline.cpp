@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mir/frame_timeline.h"
+#include "mir/thread_name.h"
+
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using Stage = mir::FrameTimeline::Stage;
+
+namespace
+{
+// The timeline is process wide, so each test keys its spans with a key of its own
+uintptr_t last_key{0};
+
+struct FrameTimeline : Test
+{
+    FrameTimeline()
+    {
+        mir::FrameTimeline::enable(spans_per_thread);
+    }
+
+    ~FrameTimeline()
+    {
+        mir::FrameTimeline::disable();
+    }
+
+    void record(Stage stage, uint32_t buffer_id)
+    {
+        auto const now = std::chrono::steady_clock::now();
+        mir::FrameTimeline::record(stage, key, buffer_id, now, now + std::chrono::microseconds{5});
+    }
+
+    std::string dump()
+    {
+        std::ostringstream out;
+        mir::FrameTimeline::dump(out);
+        return out.str();
+    }
+
+    // How the stream, output or sync group of a span shows in the dump
+    std::string key_text() const
+    {
+        std::ostringstream out;
+        out << "\"0x" << std::hex << reinterpret_cast<uintptr_t>(key) << '"';
+        return out.str();
+    }
+
+    size_t spans_with_key(std::string const& json)
+    {
+        auto const text = key_text();
+        size_t count{0};
+        for (auto pos = json.find(text); pos != std::string::npos; pos = json.find(text, pos + 1))
+            ++count;
+        return count;
+    }
+
+    static size_t const spans_per_thread{16};
+    void const* const key{reinterpret_cast<void const*>(++last_key)};
+};
+
+struct FrameTimelineFile : FrameTimeline
+{
+    FrameTimelineFile()
+    {
+        char name[] = "/tmp/mir_frame_timeline_XXXXXX";
+        if (!mkdtemp(name))
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+
+        directory = name;
+        file = directory + "/timeline.json";
+        target = directory + "/target";
+    }
+
+    ~FrameTimelineFile()
+    {
+        unlink(file.c_str());
+        unlink(target.c_str());
+        rmdir(directory.c_str());
+    }
+
+    static std::string contents_of(std::string const& path)
+    {
+        std::ifstream in{path};
+        return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    }
+
+    std::string directory;
+    std::string file;
+    std::string target;
+};
+}
+
+TEST_F(FrameTimeline, dumps_spans_as_chrome_trace_events)
+{
+    {
+        mir::FrameTimeline::Span span{Stage::compositor_acquire, key};
+        span.set_buffer(7);
+    }
+
+    auto const json = dump();
+
+    EXPECT_THAT(json, StartsWith("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_THAT(json, EndsWith("]}\n"));
+    EXPECT_THAT(json, HasSubstr(
+        "{\"name\":\"compositor_acquire\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":"));
+    EXPECT_THAT(json, HasSubstr("\"args\":{\"stream\":" + key_text() + ",\"buffer\":7}}"));
+}
+
+TEST_F(FrameTimeline, records_nothing_while_disabled)
+{
+    mir::FrameTimeline::disable();
+    {
+        mir::FrameTimeline::Span span{Stage::render, key, 3};
+    }
+
+    EXPECT_THAT(spans_with_key(dump()), Eq(0u));
+}
+
+TEST_F(FrameTimeline, keeps_the_latest_spans_of_each_thread)
+{
+    for (uint32_t buffer = 0; buffer != 40; ++buffer)
+        record(Stage::buffer_scheduled, buffer);
+
+    auto const json = dump();
+
+    EXPECT_THAT(spans_with_key(json), Eq(spans_per_thread));
+    EXPECT_THAT(json, HasSubstr(key_text() + ",\"buffer\":39}"));
+    EXPECT_THAT(json, HasSubstr(key_text() + ",\"buffer\":24}"));
+    EXPECT_THAT(json, Not(HasSubstr(key_text() + ",\"buffer\":23}")));
+}
+
+TEST_F(FrameTimeline, records_each_thread_on_its_own_track)
+{
+    int const threads{4};
+    int const spans_each{10};
+
+    std::vector<std::thread> recorders;
+    for (int i = 0; i != threads; ++i)
+    {
+        recorders.emplace_back(
+            [this, spans_each]
+            {
+                mir::set_thread_name("Mir/Recorder");
+                for (int n = 0; n != spans_each; ++n)
+                    record(Stage::submit_received, n);
+            });
+    }
+    for (auto& thread : recorders)
+        thread.join();
+
+    auto const json = dump();
+
+    EXPECT_THAT(spans_with_key(json), Eq(size_t{threads * spans_each}));
+    EXPECT_THAT(json, HasSubstr("\"args\":{\"name\":\"Mir/Recorder\"}"));
+}
+
+TEST_F(FrameTimeline, can_be_dumped_while_threads_record)
+{
+    std::atomic<bool> recording{true};
+    std::thread recorder{
+        [this, &recording]
+        {
+            for (uint32_t n = 0; recording; ++n)
+                record(Stage::post, n);
+        }};
+
+    for (int i = 0; i != 100; ++i)
+        EXPECT_THAT(spans_with_key(dump()), Le(spans_per_thread));
+
+    recording = false;
+    recorder.join();
+}
+
+TEST_F(FrameTimelineFile, dumps_to_a_file_only_its_owner_can_read)
+{
+    record(Stage::render, 5);
+
+    mir::FrameTimeline::dump(file);
+
+    struct stat info;
+    ASSERT_THAT(lstat(file.c_str(), &info), Eq(0));
+    EXPECT_TRUE(S_ISREG(info.st_mode));
+    EXPECT_THAT(info.st_mode & 0777, Eq(0600u));
+    EXPECT_THAT(contents_of(file), HasSubstr(key_text() + ",\"buffer\":5}"));
+}
+
+TEST_F(FrameTimelineFile, replaces_a_symlink_rather_than_writing_through_it)
+{
+    std::ofstream{target} << "untouched";
+    ASSERT_THAT(symlink(target.c_str(), file.c_str()), Eq(0));
+
+    mir::FrameTimeline::dump(file);
+
+    struct stat info;
+    ASSERT_THAT(lstat(file.c_str(), &info), Eq(0));
+    EXPECT_TRUE(S_ISREG(info.st_mode));
+    EXPECT_THAT(contents_of(target), Eq("untouched"));
+}
+
+TEST_F(FrameTimelineFile, throws_if_the_file_cannot_be_written)
+{
+    EXPECT_THROW(mir::FrameTimeline::dump(directory + "/missing/timeline.json"), std::system_error);
+}
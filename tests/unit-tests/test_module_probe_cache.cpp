@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/module_probe_cache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace
+{
+struct ModuleProbeCache : Test
+{
+    ModuleProbeCache()
+    {
+        char name[] = "/tmp/mir_module_probe_cache_XXXXXX";
+        if (!mkdtemp(name))
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+
+        directory = name;
+        module_path = directory + "/modules";
+        cache_file = directory + "/cache";
+        mkdir_or_throw(module_path);
+
+        mesa.module = add_module("graphics-mesa-kms.so.11");
+        add_module("graphics-android.so.11");
+    }
+
+    ~ModuleProbeCache()
+    {
+        for (auto const& module : modules)
+            unlink(module.c_str());
+        unlink(cache_file.c_str());
+        rmdir(module_path.c_str());
+        rmdir(directory.c_str());
+    }
+
+    void mkdir_or_throw(std::string const& path)
+    {
+        if (mkdir(path.c_str(), 0700) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create directory"};
+    }
+
+    std::string add_module(std::string const& name, char const* contents = "module")
+    {
+        auto const module = module_path + "/" + name;
+        std::ofstream{module} << contents;
+        modules.push_back(module);
+        return module;
+    }
+
+    std::string directory;
+    std::string module_path;
+    std::string cache_file;
+    std::vector<std::string> modules;
+
+    mir::ModuleProbeCache::Choice mesa{"", 256};
+};
+}
+
+TEST_F(ModuleProbeCache, remembers_the_choice_made_for_a_path)
+{
+    mir::ModuleProbeCache{cache_file}.store(module_path, "--vt 1", mesa);
+
+    mir::ModuleProbeCache::Choice choice;
+    ASSERT_TRUE(mir::ModuleProbeCache{cache_file}.lookup(module_path, "--vt 1", choice));
+    EXPECT_THAT(choice.module, Eq(mesa.module));
+    EXPECT_THAT(choice.priority, Eq(mesa.priority));
+}
+
+TEST_F(ModuleProbeCache, knows_nothing_before_a_choice_is_made)
+{
+    mir::ModuleProbeCache::Choice choice;
+    EXPECT_FALSE(mir::ModuleProbeCache{cache_file}.lookup(module_path, "", choice));
+}
+
+TEST_F(ModuleProbeCache, keeps_choices_for_different_contexts_apart)
+{
+    mir::ModuleProbeCache cache{cache_file};
+    cache.store(module_path, "mir:mesa", mesa);
+    cache.store(module_path, "mir:android", {module_path + "/graphics-android.so.11", 1});
+
+    mir::ModuleProbeCache::Choice choice;
+    ASSERT_TRUE(cache.lookup(module_path, "mir:mesa", choice));
+    EXPECT_THAT(choice.module, Eq(mesa.module));
+    ASSERT_TRUE(cache.lookup(module_path, "mir:android", choice));
+    EXPECT_THAT(choice.module, Eq(module_path + "/graphics-android.so.11"));
+    EXPECT_FALSE(cache.lookup(module_path, "mir:eglstream", choice));
+}
+
+TEST_F(ModuleProbeCache, forgets_the_choice_once_a_module_is_added)
+{
+    mir::ModuleProbeCache cache{cache_file};
+    cache.store(module_path, "", mesa);
+
+    add_module("graphics-eglstream-kms.so.11");
+
+    mir::ModuleProbeCache::Choice choice;
+    EXPECT_FALSE(cache.lookup(module_path, "", choice));
+}
+
+TEST_F(ModuleProbeCache, forgets_the_choice_once_a_module_is_replaced)
+{
+    mir::ModuleProbeCache cache{cache_file};
+    cache.store(module_path, "", mesa);
+
+    // As a package upgrade would: a new file in the old one's place
+    auto const replacement = module_path + "/replacement";
+    std::ofstream{replacement} << "upgraded module";
+    ASSERT_THAT(rename(replacement.c_str(), mesa.module.c_str()), Eq(0));
+
+    mir::ModuleProbeCache::Choice choice;
+    EXPECT_FALSE(cache.lookup(module_path, "", choice));
+}
+
+TEST_F(ModuleProbeCache, ignores_a_corrupt_cache)
+{
+    std::ofstream{cache_file} << "garbage\tin\n\n\tthe\tcache\n";
+
+    mir::ModuleProbeCache cache{cache_file};
+    mir::ModuleProbeCache::Choice choice;
+    EXPECT_FALSE(cache.lookup(module_path, "", choice));
+
+    cache.store(module_path, "", mesa);
+    EXPECT_TRUE(cache.lookup(module_path, "", choice));
+}